@@ -0,0 +1,231 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_ADAPTIVE_STACK_ALLOCATOR_H
+#define BOOST_COROUTINES_ADAPTIVE_STACK_ALLOCATOR_H
+
+#include <cstddef>
+#include <map>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/stack_painting.hpp>
+#include <boost/coroutine/pooled_protected_stack_allocator.hpp>
+#include <boost/coroutine/stack_context.hpp>
+#include <boost/coroutine/stack_traits.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// learns the peak stack usage per kind of coroutine and right-sizes the
+// stacks of later coroutines of that kind
+// the kind is `attributes::kind` or, if zero, derived from the
+// coroutine-function (address of a function, type of a function-object)
+// the first `learning_samples` stacks of a kind are painted and measured at
+// deallocation, afterwards every `sample_period`-th stack; learned stacks
+// get the peak plus 50% plus `margin` bytes, never more than
+// `attributes::size`
+// a coroutine exceeding its learned stack hits the guard page
+// stacks are drawn from a pooled_protected_stack_allocator; the bookkeeping
+// is shared by all copies of the allocator and is not synchronized, e.g. all
+// copies must be used by one thread at a time
+template< typename traitsT >
+class basic_adaptive_stack_allocator
+{
+public:
+    typedef traitsT                                                 traits_type;
+    typedef basic_pooled_protected_stack_allocator< traitsT >       allocator_type;
+
+    // coroutines pass the attributes (and kind) to allocate()
+    typedef void uses_attributes;
+
+private:
+    // stored at the top of the stack
+    struct header
+    {
+        std::size_t     kind;
+        bool            painted;
+    };
+
+    enum { header_size = ( ( sizeof( header) + 63) / 64) * 64 };
+
+    struct record
+    {
+        std::size_t     peak;
+        std::size_t     samples;
+        std::size_t     allocations;
+
+        record() BOOST_NOEXCEPT :
+            peak( 0), samples( 0), allocations( 0)
+        {}
+    };
+
+    typedef std::map< std::size_t, record >     records_type;
+
+    struct storage
+    {
+        std::size_t         use_count;
+        std::size_t         learning_samples;
+        std::size_t         sample_period;
+        std::size_t         margin;
+        records_type        records;
+
+        storage( std::size_t learning_samples_, std::size_t sample_period_,
+                 std::size_t margin_) :
+            use_count( 1),
+            learning_samples( learning_samples_),
+            sample_period( sample_period_),
+            margin( margin_),
+            records()
+        {}
+    };
+
+    storage         *   storage_;
+    allocator_type      alloc_;
+
+    // size passed to the pool for a learned kind: peak usage, safety
+    // margin, header and guard page
+    std::size_t size_of_( record const& r, std::size_t size) const BOOST_NOEXCEPT
+    {
+        std::size_t size_ = r.peak + r.peak / 2 + storage_->margin
+            + header_size + traits_type::page_size();
+        if ( size_ < traits_type::minimum_size() ) size_ = traits_type::minimum_size();
+        return size_ < size ? size_ : size;
+    }
+
+public:
+    explicit basic_adaptive_stack_allocator(
+            std::size_t learning_samples = 16,
+            std::size_t sample_period = 64,
+            std::size_t margin = 2 * traits_type::page_size(),
+            allocator_type const& alloc = allocator_type() ) :
+        storage_( new storage( learning_samples, sample_period, margin) ),
+        alloc_( alloc)
+    { BOOST_ASSERT( 0 < sample_period); }
+
+    basic_adaptive_stack_allocator( basic_adaptive_stack_allocator const& other) BOOST_NOEXCEPT :
+        storage_( other.storage_),
+        alloc_( other.alloc_)
+    { ++storage_->use_count; }
+
+    basic_adaptive_stack_allocator &
+    operator=( basic_adaptive_stack_allocator const& other) BOOST_NOEXCEPT
+    {
+        if ( storage_ == other.storage_) return * this;
+
+        ++other.storage_->use_count;
+        this->~basic_adaptive_stack_allocator();
+        storage_ = other.storage_;
+        alloc_ = other.alloc_;
+        return * this;
+    }
+
+    ~basic_adaptive_stack_allocator()
+    {
+        if ( 0 == --storage_->use_count)
+            delete storage_;
+    }
+
+    void allocate( stack_context & ctx, attributes const& attrs)
+    {
+        BOOST_ASSERT( traits_type::minimum_size() <= attrs.size);
+        BOOST_ASSERT( traits_type::is_unbounded() || ( traits_type::maximum_size() >= attrs.size) );
+
+        std::size_t size = attrs.size;
+        bool paint = false;
+        if ( 0 != attrs.kind)
+        {
+            record & r = storage_->records[attrs.kind];
+            if ( r.samples < storage_->learning_samples)
+                paint = true;
+            else
+            {
+                size = size_of_( r, attrs.size);
+                paint = 0 == ++r.allocations % storage_->sample_period;
+            }
+        }
+
+        alloc_.allocate( ctx, size);
+        header * h = reinterpret_cast< header * >(
+            static_cast< char * >( ctx.sp) - header_size);
+        h->kind = attrs.kind;
+        h->painted = paint;
+        ctx.sp = h;
+        ctx.size -= header_size;
+        if ( paint) detail::paint_stack( ctx);
+    }
+
+    // stacks allocated by size are not measured
+    void allocate( stack_context & ctx, std::size_t size = traits_type::minimum_size() )
+    { allocate( ctx, attributes( size) ); }
+
+    void deallocate( stack_context & ctx)
+    {
+        BOOST_ASSERT( ctx.sp);
+
+        header * h = static_cast< header * >( ctx.sp);
+        if ( h->painted)
+        {
+            record & r = storage_->records[h->kind];
+            const std::size_t used = detail::painted_stack_usage( ctx);
+            if ( r.peak < used) r.peak = used;
+            ++r.samples;
+            detail::unpaint_stack( ctx);
+        }
+        ctx.sp = static_cast< char * >( ctx.sp) + header_size;
+        ctx.size += header_size;
+        alloc_.deallocate( ctx);
+    }
+
+    // largest stack usage measured for `kind`
+    std::size_t peak( std::size_t kind) const
+    {
+        typename records_type::const_iterator i = storage_->records.find( kind);
+        return storage_->records.end() != i ? i->second.peak : 0;
+    }
+
+    // number of stacks of `kind` measured
+    std::size_t samples( std::size_t kind) const
+    {
+        typename records_type::const_iterator i = storage_->records.find( kind);
+        return storage_->records.end() != i ? i->second.samples : 0;
+    }
+
+    // stack size requested from the pool for the next coroutine of `kind`
+    // with `size` as stack size in its attributes
+    std::size_t stack_size( std::size_t kind, std::size_t size = traits_type::default_size() ) const
+    {
+        typename records_type::const_iterator i = storage_->records.find( kind);
+        if ( storage_->records.end() == i ||
+             i->second.samples < storage_->learning_samples)
+            return size;
+        return size_of_( i->second, size);
+    }
+
+    // forgets all learned stack sizes
+    void reset() BOOST_NOEXCEPT
+    { storage_->records.clear(); }
+
+    allocator_type & allocator() BOOST_NOEXCEPT
+    { return alloc_; }
+};
+
+typedef basic_adaptive_stack_allocator< stack_traits > adaptive_stack_allocator;
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_ADAPTIVE_STACK_ALLOCATOR_H
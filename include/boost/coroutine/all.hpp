@@ -7,14 +7,29 @@
 #ifndef BOOST_COROUTINES_ALL_H
 #define BOOST_COROUTINES_ALL_H
 
+#include <boost/config.hpp>
+
+#include <boost/coroutine/adaptive_stack_allocator.hpp>
 #include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/coloured_stack_allocator.hpp>
 #include <boost/coroutine/coroutine.hpp>
 #include <boost/coroutine/exceptions.hpp>
+#include <boost/coroutine/fixed_stack.hpp>
 #include <boost/coroutine/flags.hpp>
+#if ! defined(BOOST_NO_CXX11_HDR_ATOMIC) && ! defined(BOOST_NO_CXX11_THREAD_LOCAL)
+# include <boost/coroutine/magazine_stack_allocator.hpp>
+#endif
+#include <boost/coroutine/numa_stack_allocator.hpp>
+#include <boost/coroutine/painted_stack_allocator.hpp>
+#include <boost/coroutine/pooled_protected_stack_allocator.hpp>
 #include <boost/coroutine/protected_stack_allocator.hpp>
+#include <boost/coroutine/reserved_stack_allocator.hpp>
 #include <boost/coroutine/segmented_stack_allocator.hpp>
+#include <boost/coroutine/shared_stack_allocator.hpp>
+#include <boost/coroutine/slab_stack_allocator.hpp>
 #include <boost/coroutine/stack_allocator.hpp>
 #include <boost/coroutine/stack_context.hpp>
+#include <boost/coroutine/stack_resource.hpp>
 #include <boost/coroutine/stack_traits.hpp>
 #include <boost/coroutine/standard_stack_allocator.hpp>
 
@@ -19,11 +19,15 @@
 
 #include <boost/coroutine/attributes.hpp>
 #include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/allocate_stack.hpp>
+#include <boost/coroutine/detail/control_block.hpp>
 #include <boost/coroutine/detail/coroutine_context.hpp>
 #include <boost/coroutine/detail/parameters.hpp>
+#include <boost/coroutine/detail/stack_painting.hpp>
 #include <boost/coroutine/exceptions.hpp>
 #include <boost/coroutine/stack_allocator.hpp>
 #include <boost/coroutine/detail/pull_coroutine_impl.hpp>
+#include <boost/coroutine/detail/pull_coroutine_deferred.hpp>
 #include <boost/coroutine/detail/pull_coroutine_object.hpp>
 #include <boost/coroutine/detail/pull_coroutine_synthesized.hpp>
 #include <boost/coroutine/detail/push_coroutine_impl.hpp>
@@ -129,9 +133,56 @@ public:
 
     BOOST_EXPLICIT_OPERATOR_BOOL();
 
+    // bytes used by the coroutine so far, 0 unless the stack was painted
+    std::size_t stack_high_water_mark() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return detail::painted_stack_usage( impl_->stack_ctx() );
+    }
+
+    bool hibernate()
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->hibernate();
+    }
+
+    bool is_hibernated() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->is_hibernated();
+    }
+
     bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete(); }
 
+    // replaces the coroutine-function by `fn`, the coroutine starts from the
+    // beginning; the stack is reused if it was allocated by a `StackAllocator`
+    // and is not smaller than `attrs.size`
+    template< typename Fn >
+    void reset( Fn fn, attributes const& attrs = attributes() )
+    { reset< Fn, stack_allocator >( boost::move( fn), attrs, stack_allocator() ); }
+
+    template< typename Fn, typename StackAllocator >
+    void reset( Fn fn, attributes const& attrs, StackAllocator stack_alloc)
+    {
+        BOOST_ASSERT( 0 == impl_ || ! impl_->is_running() );
+
+        typedef detail::push_coroutine_object<
+            pull_coroutine< Arg >, Arg, Fn, StackAllocator
+        >                                                            object_t;
+        stack_context stack_ctx;
+        impl_type * impl = impl_;
+        impl_ = 0;
+        // unwinds and destroys the previous coroutine
+        detail::recycle_stack( impl, stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
+        impl_ = new ( sp) object_t(
+                boost::move( fn), attrs, detail::preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+    }
+
     void swap( push_coroutine & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
@@ -143,6 +194,31 @@ public:
         return * this;
     }
 
+    // pushes the values of [first, last), the values following the first
+    // one are pulled without a context switch; the range has to be kept
+    // alive until the next value is pushed, take() moves values out of it
+    push_coroutine & yield_batch( Arg * first, Arg * last)
+    {
+        BOOST_ASSERT( * this);
+
+        impl_->push_batch( first, last);
+        return * this;
+    }
+
+#if ! defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && ! defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    // pushes a value constructed from `args` on the stack of the caller,
+    // the pull-coroutine can move it out with take()
+    template< typename ... A >
+    push_coroutine & emplace( A && ... args)
+    {
+        BOOST_ASSERT( * this);
+
+        Arg arg( boost::forward< A >( args) ...);
+        impl_->push( arg);
+        return * this;
+    }
+#endif
+
     class iterator
     {
     private:
@@ -166,7 +242,7 @@ public:
         iterator & operator=( Arg a)
         {
             BOOST_ASSERT( c_);
-            if ( ! ( * c_)( a) ) c_ = 0;
+            if ( ! ( * c_)( boost::move( a) ) ) c_ = 0;
             return * this;
         }
 
@@ -274,9 +350,56 @@ public:
 
     BOOST_EXPLICIT_OPERATOR_BOOL();
 
+    // bytes used by the coroutine so far, 0 unless the stack was painted
+    std::size_t stack_high_water_mark() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return detail::painted_stack_usage( impl_->stack_ctx() );
+    }
+
+    bool hibernate()
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->hibernate();
+    }
+
+    bool is_hibernated() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->is_hibernated();
+    }
+
     bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete(); }
 
+    // replaces the coroutine-function by `fn`, the coroutine starts from the
+    // beginning; the stack is reused if it was allocated by a `StackAllocator`
+    // and is not smaller than `attrs.size`
+    template< typename Fn >
+    void reset( Fn fn, attributes const& attrs = attributes() )
+    { reset< Fn, stack_allocator >( boost::move( fn), attrs, stack_allocator() ); }
+
+    template< typename Fn, typename StackAllocator >
+    void reset( Fn fn, attributes const& attrs, StackAllocator stack_alloc)
+    {
+        BOOST_ASSERT( 0 == impl_ || ! impl_->is_running() );
+
+        typedef detail::push_coroutine_object<
+            pull_coroutine< Arg & >, Arg &, Fn, StackAllocator
+        >                                                            object_t;
+        stack_context stack_ctx;
+        impl_type * impl = impl_;
+        impl_ = 0;
+        // unwinds and destroys the previous coroutine
+        detail::recycle_stack( impl, stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
+        impl_ = new ( sp) object_t(
+                boost::move( fn), attrs, detail::preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+    }
+
     void swap( push_coroutine & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
@@ -419,9 +542,56 @@ public:
 
     BOOST_EXPLICIT_OPERATOR_BOOL();
 
+    // bytes used by the coroutine so far, 0 unless the stack was painted
+    inline std::size_t stack_high_water_mark() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return detail::painted_stack_usage( impl_->stack_ctx() );
+    }
+
+    inline bool hibernate()
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->hibernate();
+    }
+
+    inline bool is_hibernated() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->is_hibernated();
+    }
+
     inline bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete(); }
 
+    // replaces the coroutine-function by `fn`, the coroutine starts from the
+    // beginning; the stack is reused if it was allocated by a `StackAllocator`
+    // and is not smaller than `attrs.size`
+    template< typename Fn >
+    inline void reset( Fn fn, attributes const& attrs = attributes() )
+    { reset< Fn, stack_allocator >( boost::move( fn), attrs, stack_allocator() ); }
+
+    template< typename Fn, typename StackAllocator >
+    inline void reset( Fn fn, attributes const& attrs, StackAllocator stack_alloc)
+    {
+        BOOST_ASSERT( 0 == impl_ || ! impl_->is_running() );
+
+        typedef detail::push_coroutine_object<
+            pull_coroutine< void >, void, Fn, StackAllocator
+        >                                                            object_t;
+        stack_context stack_ctx;
+        impl_type * impl = impl_;
+        impl_ = 0;
+        // unwinds and destroys the previous coroutine
+        detail::recycle_stack( impl, stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
+        impl_ = new ( sp) object_t(
+                boost::move( fn), attrs, detail::preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+    }
+
     inline void swap( push_coroutine & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
@@ -452,10 +622,22 @@ private:
 
     struct dummy {};
 
-    impl_type       *   impl_;
+    mutable impl_type   *   impl_;
 
     BOOST_MOVABLE_BUT_NOT_COPYABLE( pull_coroutine)
 
+    // a coroutine created with start_lazy allocates its stack and runs to
+    // the first value on first use; returns true if started by this call
+    bool start_() const
+    {
+        if ( ! impl_->is_deferred() ) return false;
+        impl_type * deferred = impl_;
+        impl_ = deferred->start();
+        deferred->destroy();
+        impl_->pull();
+        return true;
+    }
+
     explicit pull_coroutine( detail::synthesized_t::flag_t, impl_type & impl) :
         impl_( & impl)
     { BOOST_ASSERT( impl_); }
@@ -473,20 +655,28 @@ public:
                              attributes const& attrs = attributes() ) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R >, R, coroutine_fn, stack_allocator
+            >( boost::forward< coroutine_fn >( fn), attrs, stack_allocator() );
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         stack_allocator stack_alloc;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R >, R, coroutine_fn, stack_allocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -501,19 +691,27 @@ public:
                              StackAllocator stack_alloc) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R >, R, coroutine_fn, StackAllocator
+            >( boost::forward< coroutine_fn >( fn), attrs, stack_alloc);
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R >, R, coroutine_fn, StackAllocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -527,20 +725,28 @@ public:
                              attributes const& attrs = attributes() ) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R >, R, Fn, stack_allocator
+            >( boost::forward< Fn >( fn), attrs, stack_allocator() );
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         stack_allocator stack_alloc;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R >, R, Fn, stack_allocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -555,19 +761,27 @@ public:
                              StackAllocator stack_alloc) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R >, R, Fn, StackAllocator
+            >( boost::forward< Fn >( fn), attrs, stack_alloc);
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R >, R, Fn, StackAllocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -581,20 +795,28 @@ public:
                              attributes const& attrs = attributes() ) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R >, R, Fn, stack_allocator
+            >( fn, attrs, stack_allocator() );
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         stack_allocator stack_alloc;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R >, R, Fn, stack_allocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -609,19 +831,27 @@ public:
                              StackAllocator stack_alloc) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R >, R, Fn, StackAllocator
+            >( fn, attrs, stack_alloc);
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R >, R, Fn, StackAllocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -635,20 +865,28 @@ public:
                              attributes const& attrs = attributes() ) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R >, R, Fn, stack_allocator
+            >( fn, attrs, stack_allocator() );
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         stack_allocator stack_alloc;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R >, R, Fn, stack_allocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -663,19 +901,27 @@ public:
                              StackAllocator stack_alloc) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R >, R, Fn, StackAllocator
+            >( fn, attrs, stack_alloc);
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R >, R, Fn, StackAllocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -707,9 +953,72 @@ public:
 
     BOOST_EXPLICIT_OPERATOR_BOOL();
 
+    // bytes used by the coroutine so far, 0 unless the stack was painted
+    std::size_t stack_high_water_mark() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        if ( impl_->is_deferred() ) return 0;
+        return detail::painted_stack_usage( impl_->stack_ctx() );
+    }
+
+    bool hibernate()
+    {
+        BOOST_ASSERT( 0 != impl_);
+        if ( impl_->is_deferred() ) return false;
+        return impl_->hibernate();
+    }
+
+    bool is_hibernated() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        if ( impl_->is_deferred() ) return false;
+        return impl_->is_hibernated();
+    }
+
+    // a coroutine created with start_lazy is not complete before its first
+    // use, it is not started
     bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete(); }
 
+    // replaces the coroutine-function by `fn`, the coroutine starts from the
+    // beginning; the stack is reused if it was allocated by a `StackAllocator`
+    // and is not smaller than `attrs.size`, with start_lazy the stack is
+    // released and allocated again on first use
+    template< typename Fn >
+    void reset( Fn fn, attributes const& attrs = attributes() )
+    { reset< Fn, stack_allocator >( boost::move( fn), attrs, stack_allocator() ); }
+
+    template< typename Fn, typename StackAllocator >
+    void reset( Fn fn, attributes const& attrs, StackAllocator stack_alloc)
+    {
+        BOOST_ASSERT( 0 == impl_ || ! impl_->is_running() );
+
+        typedef detail::pull_coroutine_object<
+            push_coroutine< R >, R, Fn, StackAllocator
+        >                                                            object_t;
+        stack_context stack_ctx;
+        impl_type * impl = impl_;
+        impl_ = 0;
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            if ( 0 != impl) impl->destroy();
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R >, R, Fn, StackAllocator
+            >( boost::move( fn), attrs, stack_alloc);
+            return;
+        }
+        // unwinds and destroys the previous coroutine
+        detail::recycle_stack( impl, stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
+        impl_ = new ( sp) object_t(
+                boost::move( fn), attrs, detail::preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+        impl_->pull();
+    }
+
     void swap( pull_coroutine & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
@@ -717,7 +1026,9 @@ public:
     {
         BOOST_ASSERT( * this);
 
-        impl_->pull();
+        // a coroutine created with start_lazy is only started, e.g. runs to
+        // its first value
+        if ( ! start_() ) impl_->pull();
         return * this;
     }
 
@@ -725,9 +1036,38 @@ public:
     {
         BOOST_ASSERT( 0 != impl_);
 
+        start_();
         return impl_->get();
     }
 
+    // moves the value out of the coroutine instead of copying it, at most
+    // once before the next value is pulled
+    R take()
+    {
+        BOOST_ASSERT( 0 != impl_);
+
+        start_();
+        return impl_->take();
+    }
+
+    // copies the current value and the values pulled after it to `out`,
+    // at most `n` values; returns the number of values copied
+    template< typename OutputIterator >
+    std::size_t pull_n( OutputIterator out, std::size_t n)
+    {
+        BOOST_ASSERT( 0 != impl_);
+
+        start_();
+        std::size_t i = 0;
+        for ( ; i < n && impl_->has_result(); ++i)
+        {
+            * out = * impl_->get_pointer();
+            ++out;
+            impl_->pull();
+        }
+        return i;
+    }
+
     class iterator
     {
     private:
@@ -772,7 +1112,10 @@ public:
 
         explicit iterator( pull_coroutine< R > * c) :
             c_( c), val_( 0)
-        { fetch_(); }
+        {
+            c_->start_();
+            fetch_();
+        }
 
         iterator( iterator const& other) :
             c_( other.c_), val_( other.val_)
@@ -862,7 +1205,10 @@ public:
         explicit const_iterator( pull_coroutine< R > const* c) :
             c_( const_cast< pull_coroutine< R > * >( c) ),
             val_( 0)
-        { fetch_(); }
+        {
+            c_->start_();
+            fetch_();
+        }
 
         const_iterator( const_iterator const& other) :
             c_( other.c_), val_( other.val_)
@@ -924,10 +1270,22 @@ private:
 
     struct dummy {};
 
-    impl_type       *   impl_;
+    mutable impl_type   *   impl_;
 
     BOOST_MOVABLE_BUT_NOT_COPYABLE( pull_coroutine)
 
+    // a coroutine created with start_lazy allocates its stack and runs to
+    // the first value on first use; returns true if started by this call
+    bool start_() const
+    {
+        if ( ! impl_->is_deferred() ) return false;
+        impl_type * deferred = impl_;
+        impl_ = deferred->start();
+        deferred->destroy();
+        impl_->pull();
+        return true;
+    }
+
     explicit pull_coroutine( detail::synthesized_t::flag_t, impl_type & impl) :
         impl_( & impl)
     { BOOST_ASSERT( impl_); }
@@ -945,20 +1303,28 @@ public:
                              attributes const& attrs = attributes() ) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R & >, R &, coroutine_fn, stack_allocator
+            >( boost::forward< coroutine_fn >( fn), attrs, stack_allocator() );
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         stack_allocator stack_alloc;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R & >, R &, coroutine_fn, stack_allocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -973,19 +1339,27 @@ public:
                              StackAllocator stack_alloc) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R & >, R &, coroutine_fn, StackAllocator
+            >( boost::forward< coroutine_fn >( fn), attrs, stack_alloc);
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R & >, R &, coroutine_fn, StackAllocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -999,20 +1373,28 @@ public:
                              attributes const& attrs = attributes() ) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R & >, R &, Fn, stack_allocator
+            >( boost::forward< Fn >( fn), attrs, stack_allocator() );
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         stack_allocator stack_alloc;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R & >, R &, Fn, stack_allocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -1027,19 +1409,27 @@ public:
                              StackAllocator stack_alloc) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R & >, R &, Fn, StackAllocator
+            >( boost::forward< Fn >( fn), attrs, stack_alloc);
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R & >, R &, Fn, StackAllocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -1053,20 +1443,28 @@ public:
                              attributes const& attrs = attributes() ) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R & >, R &, Fn, stack_allocator
+            >( fn, attrs, stack_allocator() );
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         stack_allocator stack_alloc;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R & >, R &, Fn, stack_allocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -1081,19 +1479,27 @@ public:
                              StackAllocator stack_alloc) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R & >, R &, Fn, StackAllocator
+            >( fn, attrs, stack_alloc);
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R & >, R &, Fn, StackAllocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -1107,20 +1513,28 @@ public:
                              attributes const& attrs = attributes() ) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R & >, R &, Fn, stack_allocator
+            >( fn, attrs, stack_allocator() );
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         stack_allocator stack_alloc;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R & >, R &, Fn, stack_allocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -1135,19 +1549,27 @@ public:
                              StackAllocator stack_alloc) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R & >, R &, Fn, StackAllocator
+            >( fn, attrs, stack_alloc);
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< R & >, R &, Fn, StackAllocator
         >                                                        object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -1179,9 +1601,72 @@ public:
 
     BOOST_EXPLICIT_OPERATOR_BOOL();
 
+    // bytes used by the coroutine so far, 0 unless the stack was painted
+    std::size_t stack_high_water_mark() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        if ( impl_->is_deferred() ) return 0;
+        return detail::painted_stack_usage( impl_->stack_ctx() );
+    }
+
+    bool hibernate()
+    {
+        BOOST_ASSERT( 0 != impl_);
+        if ( impl_->is_deferred() ) return false;
+        return impl_->hibernate();
+    }
+
+    bool is_hibernated() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        if ( impl_->is_deferred() ) return false;
+        return impl_->is_hibernated();
+    }
+
+    // a coroutine created with start_lazy is not complete before its first
+    // use, it is not started
     bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete(); }
 
+    // replaces the coroutine-function by `fn`, the coroutine starts from the
+    // beginning; the stack is reused if it was allocated by a `StackAllocator`
+    // and is not smaller than `attrs.size`, with start_lazy the stack is
+    // released and allocated again on first use
+    template< typename Fn >
+    void reset( Fn fn, attributes const& attrs = attributes() )
+    { reset< Fn, stack_allocator >( boost::move( fn), attrs, stack_allocator() ); }
+
+    template< typename Fn, typename StackAllocator >
+    void reset( Fn fn, attributes const& attrs, StackAllocator stack_alloc)
+    {
+        BOOST_ASSERT( 0 == impl_ || ! impl_->is_running() );
+
+        typedef detail::pull_coroutine_object<
+            push_coroutine< R & >, R &, Fn, StackAllocator
+        >                                                            object_t;
+        stack_context stack_ctx;
+        impl_type * impl = impl_;
+        impl_ = 0;
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            if ( 0 != impl) impl->destroy();
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< R & >, R &, Fn, StackAllocator
+            >( boost::move( fn), attrs, stack_alloc);
+            return;
+        }
+        // unwinds and destroys the previous coroutine
+        detail::recycle_stack( impl, stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
+        impl_ = new ( sp) object_t(
+                boost::move( fn), attrs, detail::preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+        impl_->pull();
+    }
+
     void swap( pull_coroutine & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
@@ -1189,12 +1674,17 @@ public:
     {
         BOOST_ASSERT( * this);
 
-        impl_->pull();
+        // a coroutine created with start_lazy is only started, e.g. runs to
+        // its first value
+        if ( ! start_() ) impl_->pull();
         return * this;
     }
 
     R & get() const
-    { return impl_->get(); }
+    {
+        start_();
+        return impl_->get();
+    }
 
     class iterator
     {
@@ -1240,7 +1730,10 @@ public:
 
         explicit iterator( pull_coroutine< R & > * c) :
             c_( c), val_( 0)
-        { fetch_(); }
+        {
+            c_->start_();
+            fetch_();
+        }
 
         iterator( iterator const& other) :
             c_( other.c_), val_( other.val_)
@@ -1330,7 +1823,10 @@ public:
         explicit const_iterator( pull_coroutine< R & > const* c) :
             c_( const_cast< pull_coroutine< R & > * >( c) ),
             val_( 0)
-        { fetch_(); }
+        {
+            c_->start_();
+            fetch_();
+        }
 
         const_iterator( const_iterator const& other) :
             c_( other.c_), val_( other.val_)
@@ -1392,10 +1888,22 @@ private:
 
     struct dummy {};
 
-    impl_type       *   impl_;
+    mutable impl_type   *   impl_;
 
     BOOST_MOVABLE_BUT_NOT_COPYABLE( pull_coroutine)
 
+    // a coroutine created with start_lazy allocates its stack and runs to
+    // the first value on first use; returns true if started by this call
+    inline bool start_() const
+    {
+        if ( ! impl_->is_deferred() ) return false;
+        impl_type * deferred = impl_;
+        impl_ = deferred->start();
+        deferred->destroy();
+        impl_->pull();
+        return true;
+    }
+
     explicit pull_coroutine( detail::synthesized_t::flag_t, impl_type & impl) :
         impl_( & impl)
     { BOOST_ASSERT( impl_); }
@@ -1413,20 +1921,28 @@ public:
                              attributes const& attrs = attributes() ) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< void >, void, coroutine_fn, stack_allocator
+            >( boost::forward< coroutine_fn >( fn), attrs, stack_allocator() );
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         stack_allocator stack_alloc;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< void >, void, coroutine_fn, stack_allocator
         >                                       object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -1441,19 +1957,27 @@ public:
                              StackAllocator stack_alloc) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< void >, void, coroutine_fn, StackAllocator
+            >( boost::forward< coroutine_fn >( fn), attrs, stack_alloc);
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< void >, void, coroutine_fn, StackAllocator
         >                                                                   object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -1467,20 +1991,28 @@ public:
                              attributes const& attrs = attributes() ) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< void >, void, Fn, stack_allocator
+            >( boost::forward< Fn >( fn), attrs, stack_allocator() );
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         stack_allocator stack_alloc;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< void >, void, Fn, stack_allocator
         >                                                       object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -1495,19 +2027,27 @@ public:
                              StackAllocator stack_alloc) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< void >, void, Fn, StackAllocator
+            >( boost::forward< Fn >( fn), attrs, stack_alloc);
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< void >, void, Fn, StackAllocator
         >                                                       object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -1521,20 +2061,28 @@ public:
                              attributes const& attrs = attributes() ) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< void >, void, Fn, stack_allocator
+            >( fn, attrs, stack_allocator() );
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         stack_allocator stack_alloc;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< void >, void, Fn, stack_allocator
         >                                                       object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -1549,19 +2097,27 @@ public:
                              StackAllocator stack_alloc) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< void >, void, Fn, StackAllocator
+            >( fn, attrs, stack_alloc);
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< void >, void, Fn, StackAllocator
         >                                                       object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -1575,20 +2131,28 @@ public:
                              attributes const& attrs = attributes() ) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< void >, void, Fn, stack_allocator
+            >( fn, attrs, stack_allocator() );
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         stack_allocator stack_alloc;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< void >, void, Fn, stack_allocator
         >                                           object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -1603,19 +2167,27 @@ public:
                              StackAllocator stack_alloc) :
         impl_( 0)
     {
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< void >, void, Fn, StackAllocator
+            >( fn, attrs, stack_alloc);
+            return;
+        }
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef detail::pull_coroutine_object<
             push_coroutine< void >, void, Fn, StackAllocator
         >                                           object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -1647,9 +2219,72 @@ public:
 
     BOOST_EXPLICIT_OPERATOR_BOOL();
 
+    // bytes used by the coroutine so far, 0 unless the stack was painted
+    inline std::size_t stack_high_water_mark() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        if ( impl_->is_deferred() ) return 0;
+        return detail::painted_stack_usage( impl_->stack_ctx() );
+    }
+
+    inline bool hibernate()
+    {
+        BOOST_ASSERT( 0 != impl_);
+        if ( impl_->is_deferred() ) return false;
+        return impl_->hibernate();
+    }
+
+    inline bool is_hibernated() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        if ( impl_->is_deferred() ) return false;
+        return impl_->is_hibernated();
+    }
+
+    // a coroutine created with start_lazy is not complete before its first
+    // use, it is not started
     inline bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete(); }
 
+    // replaces the coroutine-function by `fn`, the coroutine starts from the
+    // beginning; the stack is reused if it was allocated by a `StackAllocator`
+    // and is not smaller than `attrs.size`, with start_lazy the stack is
+    // released and allocated again on first use
+    template< typename Fn >
+    inline void reset( Fn fn, attributes const& attrs = attributes() )
+    { reset< Fn, stack_allocator >( boost::move( fn), attrs, stack_allocator() ); }
+
+    template< typename Fn, typename StackAllocator >
+    inline void reset( Fn fn, attributes const& attrs, StackAllocator stack_alloc)
+    {
+        BOOST_ASSERT( 0 == impl_ || ! impl_->is_running() );
+
+        typedef detail::pull_coroutine_object<
+            push_coroutine< void >, void, Fn, StackAllocator
+        >                                                            object_t;
+        stack_context stack_ctx;
+        impl_type * impl = impl_;
+        impl_ = 0;
+        if ( start_lazy == attrs.start)
+        {
+            // the stack is allocated on first use
+            if ( 0 != impl) impl->destroy();
+            impl_ = new detail::pull_coroutine_deferred<
+                push_coroutine< void >, void, Fn, StackAllocator
+            >( boost::move( fn), attrs, stack_alloc);
+            return;
+        }
+        // unwinds and destroys the previous coroutine
+        detail::recycle_stack( impl, stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
+        void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
+        impl_ = new ( sp) object_t(
+                boost::move( fn), attrs, detail::preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+        impl_->pull();
+    }
+
     inline void swap( pull_coroutine & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
@@ -1657,7 +2292,9 @@ public:
     {
         BOOST_ASSERT( * this);
 
-        impl_->pull();
+        // a coroutine created with start_lazy is only started, e.g. runs to
+        // its first value
+        if ( ! start_() ) impl_->pull();
         return * this;
     }
 
@@ -1676,16 +2313,16 @@ push_coroutine< Arg >::push_coroutine( coroutine_fn fn,
     stack_context stack_ctx;
     stack_allocator stack_alloc;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg >, Arg, coroutine_fn, stack_allocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -1703,16 +2340,16 @@ push_coroutine< Arg >::push_coroutine( coroutine_fn fn,
     // create a stack-context
     stack_context stack_ctx;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg >, Arg, coroutine_fn, StackAllocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -1729,16 +2366,16 @@ push_coroutine< Arg & >::push_coroutine( coroutine_fn fn,
     stack_context stack_ctx;
     stack_allocator stack_alloc;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg & >, Arg &, coroutine_fn, stack_allocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -1756,16 +2393,16 @@ push_coroutine< Arg & >::push_coroutine( coroutine_fn fn,
     // create a stack-context
     stack_context stack_ctx;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg & >, Arg &, coroutine_fn, StackAllocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -1781,16 +2418,16 @@ inline push_coroutine< void >::push_coroutine( coroutine_fn fn,
     stack_context stack_ctx;
     stack_allocator stack_alloc;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< void >, void, coroutine_fn, stack_allocator
     >                                                               object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -1807,16 +2444,16 @@ push_coroutine< void >::push_coroutine( coroutine_fn fn,
     // create a stack-context
     stack_context stack_ctx;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< void >, void, coroutine_fn, StackAllocator
     >                                                               object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -1834,16 +2471,16 @@ push_coroutine< Arg >::push_coroutine( BOOST_RV_REF( Fn) fn,
     stack_context stack_ctx;
     stack_allocator stack_alloc;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg >, Arg, Fn, stack_allocator
     >                                                    object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -1861,16 +2498,16 @@ push_coroutine< Arg >::push_coroutine( BOOST_RV_REF( Fn) fn,
     // create a stack-context
     stack_context stack_ctx;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg >, Arg, Fn, StackAllocator
     >                                                    object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -1888,16 +2525,16 @@ push_coroutine< Arg & >::push_coroutine( BOOST_RV_REF( Fn) fn,
     stack_context stack_ctx;
     stack_allocator stack_alloc;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg & >, Arg &, Fn, stack_allocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -1915,16 +2552,16 @@ push_coroutine< Arg & >::push_coroutine( BOOST_RV_REF( Fn) fn,
     // create a stack-context
     stack_context stack_ctx;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg & >, Arg &, Fn, StackAllocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -1941,16 +2578,16 @@ push_coroutine< void >::push_coroutine( BOOST_RV_REF( Fn) fn,
     stack_context stack_ctx;
     stack_allocator stack_alloc;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< void >, void, Fn, stack_allocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -1967,16 +2604,16 @@ push_coroutine< void >::push_coroutine( BOOST_RV_REF( Fn) fn,
     // create a stack-context
     stack_context stack_ctx;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< void >, void, Fn, StackAllocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -1994,16 +2631,16 @@ push_coroutine< Arg >::push_coroutine( Fn fn,
     stack_context stack_ctx;
     stack_allocator stack_alloc;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg >, Arg, Fn, stack_allocator
     >                                                    object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -2021,16 +2658,16 @@ push_coroutine< Arg >::push_coroutine( Fn fn,
     // create a stack-context
     stack_context stack_ctx;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg >, Arg, Fn, StackAllocator
     >                                                    object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -2048,16 +2685,16 @@ push_coroutine< Arg & >::push_coroutine( Fn fn,
     stack_context stack_ctx;
     stack_allocator stack_alloc;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg & >, Arg &, Fn, stack_allocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -2075,16 +2712,16 @@ push_coroutine< Arg & >::push_coroutine( Fn fn,
     // create a stack-context
     stack_context stack_ctx;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg & >, Arg &, Fn, StackAllocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -2101,16 +2738,16 @@ push_coroutine< void >::push_coroutine( Fn fn,
     stack_context stack_ctx;
     stack_allocator stack_alloc;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< void >, void, Fn, stack_allocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -2127,16 +2764,16 @@ push_coroutine< void >::push_coroutine( Fn fn,
     // create a stack-context
     stack_context stack_ctx;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< void >, void, Fn, StackAllocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -2154,16 +2791,16 @@ push_coroutine< Arg >::push_coroutine( BOOST_RV_REF( Fn) fn,
     stack_context stack_ctx;
     stack_allocator stack_alloc;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg >, Arg, Fn, stack_allocator
     >                                                    object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -2181,16 +2818,16 @@ push_coroutine< Arg >::push_coroutine( BOOST_RV_REF( Fn) fn,
     // create a stack-context
     stack_context stack_ctx;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg >, Arg, Fn, StackAllocator
     >                                                    object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -2208,16 +2845,16 @@ push_coroutine< Arg & >::push_coroutine( BOOST_RV_REF( Fn) fn,
     stack_context stack_ctx;
     stack_allocator stack_alloc;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg & >, Arg &, Fn, stack_allocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -2235,16 +2872,16 @@ push_coroutine< Arg & >::push_coroutine( BOOST_RV_REF( Fn) fn,
     // create a stack-context
     stack_context stack_ctx;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< Arg & >, Arg &, Fn, StackAllocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -2261,16 +2898,16 @@ push_coroutine< void >::push_coroutine( BOOST_RV_REF( Fn) fn,
     stack_context stack_ctx;
     stack_allocator stack_alloc;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< void >, void, Fn, stack_allocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -2287,16 +2924,16 @@ push_coroutine< void >::push_coroutine( BOOST_RV_REF( Fn) fn,
     // create a stack-context
     stack_context stack_ctx;
     // allocate the coroutine-stack
-    stack_alloc.allocate( stack_ctx, attrs.size);
+    detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
     BOOST_ASSERT( 0 != stack_ctx.sp);
     // typedef of internal coroutine-type
     typedef detail::push_coroutine_object<
         pull_coroutine< void >, void, Fn, StackAllocator
     >                                                            object_t;
     // reserve space on top of coroutine-stack for internal coroutine-type
-    std::size_t size = stack_ctx.size - sizeof( object_t);
+    std::size_t size = stack_ctx.size - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != size);
-    void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+    void * sp = static_cast< char * >( stack_ctx.sp) - detail::control_block_size< object_t >( stack_ctx);
     BOOST_ASSERT( 0 != sp);
     // placement new for internal coroutine
     impl_ = new ( sp) object_t(
@@ -25,27 +25,64 @@ struct attributes
 {
     std::size_t     size;
     flag_unwind_t   do_unwind;
+    // identifies coroutines of the same kind for stack allocators
+    // using attributes (0: derived from the coroutine-function)
+    std::size_t     kind;
+    // bytes at the top of the stack faulted in when the stack is allocated
+    // (0: none), removes the page faults of the first resume
+    std::size_t     prefault;
+    // NUMA node of the stack for stack allocators using attributes
+    // (-1: chosen by the stack allocator)
+    int             node;
+    // pull-coroutines only: start_lazy defers allocating the stack and
+    // running to the first value from the constructor (or reset()) to the
+    // first use
+    flag_start_t    start;
+    // fpu_not_preserved: context switches of the coroutine neither save nor
+    // restore the floating-point environment (x86_64 and AArch64 Linux,
+    // ignored on other platforms and for coroutines on a shared stack)
+    flag_fpu_t      preserve_fpu;
 
     attributes() BOOST_NOEXCEPT :
         size( stack_allocator::traits_type::default_size() ),
-        do_unwind( stack_unwind)
+        do_unwind( stack_unwind),
+        kind( 0),
+        prefault( 0),
+        node( -1),
+        start( start_eager),
+        preserve_fpu( fpu_preserved)
     {}
 
     explicit attributes( std::size_t size_) BOOST_NOEXCEPT :
         size( size_),
-        do_unwind( stack_unwind)
+        do_unwind( stack_unwind),
+        kind( 0),
+        prefault( 0),
+        node( -1),
+        start( start_eager),
+        preserve_fpu( fpu_preserved)
     {}
 
     explicit attributes( flag_unwind_t do_unwind_) BOOST_NOEXCEPT :
         size( stack_allocator::traits_type::default_size() ),
-        do_unwind( do_unwind_)
+        do_unwind( do_unwind_),
+        kind( 0),
+        prefault( 0),
+        node( -1),
+        start( start_eager),
+        preserve_fpu( fpu_preserved)
     {}
 
     explicit attributes(
             std::size_t size_,
             flag_unwind_t do_unwind_) BOOST_NOEXCEPT :
         size( size_),
-        do_unwind( do_unwind_)
+        do_unwind( do_unwind_),
+        kind( 0),
+        prefault( 0),
+        node( -1),
+        start( start_eager),
+        preserve_fpu( fpu_preserved)
     {}
 };
 
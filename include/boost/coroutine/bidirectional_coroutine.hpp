@@ -0,0 +1,35 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_BIDIRECTIONAL_COROUTINE_H
+#define BOOST_COROUTINES_BIDIRECTIONAL_COROUTINE_H
+
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/bidirectional_coroutine_call.hpp>
+#include <boost/coroutine/detail/bidirectional_coroutine_yield.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+template< typename Req, typename Resp >
+struct bidirectional_coroutine
+{
+    typedef detail::bidirectional_coroutine_call< Req, Resp >   call_type;
+    typedef detail::bidirectional_coroutine_yield< Req, Resp >  yield_type;
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_BIDIRECTIONAL_COROUTINE_H
@@ -0,0 +1,129 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_COLOURED_STACK_ALLOCATOR_H
+#define BOOST_COROUTINES_COLOURED_STACK_ALLOCATOR_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#if ! defined(BOOST_NO_CXX11_HDR_ATOMIC)
+# include <atomic>
+#endif
+
+#include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/detail/allocate_stack.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/stack_allocator.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// colour counter shared by all instantiations of coloured_stack_allocator
+inline std::size_t next_colour() BOOST_NOEXCEPT
+{
+#if ! defined(BOOST_NO_CXX11_HDR_ATOMIC)
+    static std::atomic< std::size_t > counter( 0);
+#else
+    static std::size_t counter = 0;
+#endif
+    return counter++;
+}
+
+}
+
+// adaptor lowering the top of the stacks of `StackAllocator` by a rotating
+// offset ((colour + 1) * `stride` bytes, colour in [0, `colours`)), the
+// control block and the first frames of consecutive coroutines map to
+// different cache sets instead of the same page offset
+// the original top of the stack is stored in the gap
+// the colour is taken from a counter shared by all adaptors (whatever
+// `StackAllocator`), which is atomic if C++11 atomics are available
+// colouring can as well slow down the switches (larger populations miss the
+// caches anyway), there are no default colours, `colours` and `stride` are
+// to be chosen per workload (see performance_ring)
+template< typename StackAllocator = stack_allocator >
+class coloured_stack_allocator
+{
+public:
+    // coroutines pass the attributes to allocate()
+    typedef void uses_attributes;
+
+private:
+    StackAllocator      alloc_;
+    std::size_t         colours_;
+    std::size_t         stride_;
+
+    void colour_( stack_context & ctx)
+    {
+        const std::size_t offset = ( detail::next_colour() % colours_ + 1) * stride_;
+        BOOST_ASSERT( offset < ctx.size);
+        void * top = ctx.sp;
+        ctx.sp = static_cast< char * >( ctx.sp) - offset;
+        ctx.size -= offset;
+        * static_cast< void ** >( ctx.sp) = top;
+    }
+
+public:
+    coloured_stack_allocator(
+            std::size_t colours,
+            std::size_t stride,
+            StackAllocator const& alloc = StackAllocator() ) :
+        alloc_( alloc),
+        colours_( colours),
+        stride_( stride)
+    {
+        BOOST_ASSERT( 0 < colours_);
+        // keeps the stack pointer aligned
+        BOOST_ASSERT( 0 == stride_ % 16 && sizeof( void *) <= stride_);
+    }
+
+    void allocate( stack_context & ctx, attributes const& attrs)
+    {
+        detail::forward_allocate( alloc_, ctx, attrs);
+        colour_( ctx);
+    }
+
+    void allocate( stack_context & ctx, std::size_t size)
+    {
+        alloc_.allocate( ctx, size);
+        colour_( ctx);
+    }
+
+    void deallocate( stack_context & ctx)
+    {
+        BOOST_ASSERT( ctx.sp);
+        void * top = * static_cast< void ** >( ctx.sp);
+        ctx.size += static_cast< char * >( top) - static_cast< char * >( ctx.sp);
+        ctx.sp = top;
+        alloc_.deallocate( ctx);
+    }
+
+    std::size_t colours() const BOOST_NOEXCEPT
+    { return colours_; }
+
+    std::size_t stride() const BOOST_NOEXCEPT
+    { return stride_; }
+
+    StackAllocator & allocator() BOOST_NOEXCEPT
+    { return alloc_; }
+};
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_COLOURED_STACK_ALLOCATOR_H
@@ -8,6 +8,7 @@
 #define BOOST_COROUTINES_COROUTINE_H
 
 #include <boost/coroutine/asymmetric_coroutine.hpp>
+#include <boost/coroutine/bidirectional_coroutine.hpp>
 #include <boost/coroutine/symmetric_coroutine.hpp>
 
 #endif // BOOST_COROUTINES_COROUTINE_H
@@ -0,0 +1,122 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_ALLOCATE_STACK_H
+#define BOOST_COROUTINES_DETAIL_ALLOCATE_STACK_H
+
+#include <cstddef>
+
+#include <boost/config.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/mpl/has_xxx.hpp>
+#include <boost/type_traits/decay.hpp>
+
+#include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/preallocated.hpp>
+#include <boost/coroutine/detail/prefault_stack.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// stack allocators declaring `typedef void uses_attributes;` are called
+// with `allocate( stack_context &, attributes const&)`
+BOOST_MPL_HAS_XXX_TRAIT_NAMED_DEF( has_uses_attributes, uses_attributes, false)
+
+template< typename Fn >
+struct kind_tag
+{ static const char id; };
+
+template< typename Fn >
+const char kind_tag< Fn >::id = 0;
+
+// kind of a coroutine-function: the address of the function or a unique
+// address per function-object type
+template< typename Fn >
+std::size_t kind_of( Fn const&) BOOST_NOEXCEPT
+{ return reinterpret_cast< std::size_t >( & kind_tag< typename decay< Fn >::type >::id); }
+
+template< typename R, typename A >
+std::size_t kind_of( R( * fn)( A) ) BOOST_NOEXCEPT
+{ return reinterpret_cast< std::size_t >( fn); }
+
+// unique id per stack allocator type
+template< typename StackAllocator >
+std::size_t allocator_id() BOOST_NOEXCEPT
+{ return reinterpret_cast< std::size_t >( & kind_tag< StackAllocator >::id); }
+
+template< typename StackAllocator >
+void allocate_stack_( StackAllocator & stack_alloc, stack_context & stack_ctx,
+                      attributes const& attrs, std::size_t, mpl::false_)
+{ stack_alloc.allocate( stack_ctx, attrs.size); }
+
+template< typename StackAllocator >
+void allocate_stack_( StackAllocator & stack_alloc, stack_context & stack_ctx,
+                      attributes const& attrs, std::size_t kind, mpl::true_)
+{
+    attributes attrs_( attrs);
+    if ( 0 == attrs_.kind) attrs_.kind = kind;
+    stack_alloc.allocate( stack_ctx, attrs_);
+}
+
+// used by adaptors to forward the attributes to the adapted allocator
+template< typename StackAllocator >
+void forward_allocate( StackAllocator & stack_alloc, stack_context & stack_ctx,
+                       attributes const& attrs)
+{
+    allocate_stack_( stack_alloc, stack_ctx, attrs, attrs.kind,
+                     mpl::bool_< has_uses_attributes< StackAllocator >::value >() );
+}
+
+template< typename StackAllocator >
+void allocate_stack( StackAllocator & stack_alloc, stack_context & stack_ctx,
+                     attributes const& attrs, std::size_t kind)
+{
+    allocate_stack_( stack_alloc, stack_ctx, attrs, kind,
+                     mpl::bool_< has_uses_attributes< StackAllocator >::value >() );
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+    // a coroutine of a shared stack owns only its control block
+    if ( 0 != attrs.prefault && ! shared_stack_of< StackAllocator >::value)
+        prefault_stack( stack_ctx, attrs.prefault);
+#endif
+}
+
+// destroys the coroutine `impl` (if any) and keeps its stack (and
+// allocator) if it was allocated by a `StackAllocator` and provides at least
+// `attrs.size` bytes, otherwise a new stack is allocated
+template< typename Impl, typename StackAllocator >
+void recycle_stack( Impl * impl, StackAllocator & stack_alloc, stack_context & stack_ctx,
+                    attributes const& attrs, std::size_t kind)
+{
+    if ( 0 != impl)
+    {
+        if ( impl->recycle( stack_ctx, & stack_alloc, allocator_id< StackAllocator >() ) )
+        {
+            if ( stack_ctx.size >= attrs.size)
+                return;
+            // too small for the new coroutine-function
+            stack_alloc.deallocate( stack_ctx);
+            stack_ctx = stack_context();
+        }
+        else
+            impl->destroy();
+    }
+    allocate_stack( stack_alloc, stack_ctx, attrs, kind);
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_ALLOCATE_STACK_H
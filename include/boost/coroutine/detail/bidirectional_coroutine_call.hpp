@@ -0,0 +1,353 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_BIDIRECTIONAL_COROUTINE_CALL_H
+#define BOOST_COROUTINES_DETAIL_BIDIRECTIONAL_COROUTINE_CALL_H
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/move/move.hpp>
+#include <boost/utility/explicit_operator_bool.hpp>
+
+#include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/detail/allocate_stack.hpp>
+#include <boost/coroutine/detail/bidirectional_coroutine_impl.hpp>
+#include <boost/coroutine/detail/bidirectional_coroutine_object.hpp>
+#include <boost/coroutine/detail/bidirectional_coroutine_yield.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/control_block.hpp>
+#include <boost/coroutine/detail/preallocated.hpp>
+#include <boost/coroutine/detail/stack_painting.hpp>
+#include <boost/coroutine/stack_allocator.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+template< typename Req, typename Resp >
+class bidirectional_coroutine_call
+{
+private:
+    typedef bidirectional_coroutine_impl< Req, Resp >   impl_type;
+
+    BOOST_MOVABLE_BUT_NOT_COPYABLE( bidirectional_coroutine_call)
+
+    impl_type       *   impl_;
+
+public:
+    typedef Req                                             request_type;
+    typedef Resp                                            response_type;
+    typedef bidirectional_coroutine_yield< Req, Resp >      yield_type;
+
+    bidirectional_coroutine_call() BOOST_NOEXCEPT :
+        impl_( 0)
+    {}
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+# ifdef BOOST_MSVC
+    typedef void ( * coroutine_fn)( yield_type &);
+
+    explicit bidirectional_coroutine_call( coroutine_fn fn,
+                                           attributes const& attrs = attributes(),
+                                           stack_allocator stack_alloc = stack_allocator() ) :
+        impl_( 0)
+    {
+        // create a stack-context
+        stack_context stack_ctx;
+        // allocate the coroutine-stack
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        // typedef of internal coroutine-type
+        typedef bidirectional_coroutine_object< Req, Resp, coroutine_fn, stack_allocator > object_t;
+        // reserve space on top of coroutine-stack for internal coroutine-type
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != size);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != sp);
+        // placement new for internal coroutine
+        impl_ = new ( sp) object_t(
+                    boost::forward< coroutine_fn >( fn), attrs, preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+    }
+
+    template< typename StackAllocator >
+    explicit bidirectional_coroutine_call( coroutine_fn fn,
+                                           attributes const& attrs,
+                                           StackAllocator stack_alloc) :
+        impl_( 0)
+    {
+        // create a stack-context
+        stack_context stack_ctx;
+        // allocate the coroutine-stack
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        // typedef of internal coroutine-type
+        typedef bidirectional_coroutine_object< Req, Resp, coroutine_fn, StackAllocator > object_t;
+        // reserve space on top of coroutine-stack for internal coroutine-type
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != size);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != sp);
+        // placement new for internal coroutine
+        impl_ = new ( sp) object_t(
+                    boost::forward< coroutine_fn >( fn), attrs, preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+    }
+# endif
+    template< typename Fn >
+    explicit bidirectional_coroutine_call( BOOST_RV_REF( Fn) fn,
+                                           attributes const& attrs = attributes(),
+                                           stack_allocator stack_alloc = stack_allocator() ) :
+        impl_( 0)
+    {
+        // create a stack-context
+        stack_context stack_ctx;
+        // allocate the coroutine-stack
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        // typedef of internal coroutine-type
+        typedef bidirectional_coroutine_object< Req, Resp, Fn, stack_allocator > object_t;
+        // reserve space on top of coroutine-stack for internal coroutine-type
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != size);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != sp);
+        // placement new for internal coroutine
+        impl_ = new ( sp) object_t(
+                    boost::forward< Fn >( fn), attrs, preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+    }
+
+    template< typename Fn, typename StackAllocator >
+    explicit bidirectional_coroutine_call( BOOST_RV_REF( Fn) fn,
+                                           attributes const& attrs,
+                                           StackAllocator stack_alloc) :
+        impl_( 0)
+    {
+        // create a stack-context
+        stack_context stack_ctx;
+        // allocate the coroutine-stack
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        // typedef of internal coroutine-type
+        typedef bidirectional_coroutine_object< Req, Resp, Fn, StackAllocator > object_t;
+        // reserve space on top of coroutine-stack for internal coroutine-type
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != size);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != sp);
+        // placement new for internal coroutine
+        impl_ = new ( sp) object_t(
+                    boost::forward< Fn >( fn), attrs, preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+    }
+#else
+    template< typename Fn >
+    explicit bidirectional_coroutine_call( Fn fn,
+                                           attributes const& attrs = attributes(),
+                                           stack_allocator stack_alloc = stack_allocator() ) :
+        impl_( 0)
+    {
+        // create a stack-context
+        stack_context stack_ctx;
+        // allocate the coroutine-stack
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        // typedef of internal coroutine-type
+        typedef bidirectional_coroutine_object< Req, Resp, Fn, stack_allocator > object_t;
+        // reserve space on top of coroutine-stack for internal coroutine-type
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != size);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != sp);
+        // placement new for internal coroutine
+        impl_ = new ( sp) object_t(
+                    fn, attrs, preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+    }
+
+    template< typename Fn, typename StackAllocator >
+    explicit bidirectional_coroutine_call( Fn fn,
+                                           attributes const& attrs,
+                                           StackAllocator stack_alloc) :
+        impl_( 0)
+    {
+        // create a stack-context
+        stack_context stack_ctx;
+        // allocate the coroutine-stack
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        // typedef of internal coroutine-type
+        typedef bidirectional_coroutine_object< Req, Resp, Fn, StackAllocator > object_t;
+        // reserve space on top of coroutine-stack for internal coroutine-type
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != size);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != sp);
+        // placement new for internal coroutine
+        impl_ = new ( sp) object_t(
+                    fn, attrs, preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+    }
+
+    template< typename Fn >
+    explicit bidirectional_coroutine_call( BOOST_RV_REF( Fn) fn,
+                                           attributes const& attrs = attributes(),
+                                           stack_allocator stack_alloc = stack_allocator() ) :
+        impl_( 0)
+    {
+        // create a stack-context
+        stack_context stack_ctx;
+        // allocate the coroutine-stack
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        // typedef of internal coroutine-type
+        typedef bidirectional_coroutine_object< Req, Resp, Fn, stack_allocator > object_t;
+        // reserve space on top of coroutine-stack for internal coroutine-type
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != size);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != sp);
+        // placement new for internal coroutine
+        impl_ = new ( sp) object_t(
+                    fn, attrs, preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+    }
+
+    template< typename Fn, typename StackAllocator >
+    explicit bidirectional_coroutine_call( BOOST_RV_REF( Fn) fn,
+                                           attributes const& attrs,
+                                           StackAllocator stack_alloc) :
+        impl_( 0)
+    {
+        // create a stack-context
+        stack_context stack_ctx;
+        // allocate the coroutine-stack
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        // typedef of internal coroutine-type
+        typedef bidirectional_coroutine_object< Req, Resp, Fn, StackAllocator > object_t;
+        // reserve space on top of coroutine-stack for internal coroutine-type
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != size);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != sp);
+        // placement new for internal coroutine
+        impl_ = new ( sp) object_t(
+                    fn, attrs, preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+    }
+#endif
+
+    ~bidirectional_coroutine_call()
+    {
+        if ( 0 != impl_)
+        {
+            impl_->destroy();
+            impl_ = 0;
+        }
+    }
+
+    bidirectional_coroutine_call( BOOST_RV_REF( bidirectional_coroutine_call) other) BOOST_NOEXCEPT :
+        impl_( 0)
+    { swap( other); }
+
+    bidirectional_coroutine_call & operator=( BOOST_RV_REF( bidirectional_coroutine_call) other) BOOST_NOEXCEPT
+    {
+        bidirectional_coroutine_call tmp( boost::move( other) );
+        swap( tmp);
+        return * this;
+    }
+
+    BOOST_EXPLICIT_OPERATOR_BOOL();
+
+    // bytes used by the coroutine so far, 0 unless the stack was painted
+    std::size_t stack_high_water_mark() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return detail::painted_stack_usage( impl_->stack_ctx() );
+    }
+
+    bool hibernate()
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->hibernate();
+    }
+
+    bool is_hibernated() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->is_hibernated();
+    }
+
+    bool operator!() const BOOST_NOEXCEPT
+    { return 0 == impl_ || impl_->is_complete() || impl_->is_running(); }
+
+    void swap( bidirectional_coroutine_call & other) BOOST_NOEXCEPT
+    { std::swap( impl_, other.impl_); }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    // passes a copy of `req`
+    bidirectional_coroutine_call & operator()( Req const& req)
+    {
+        Req tmp( req);
+        return ( * this)( boost::move( tmp) );
+    }
+
+    // passes `req` without a copy, the coroutine may move it out; returns
+    // with the response of the coroutine (or after it has completed)
+    bidirectional_coroutine_call & operator()( Req && req)
+    {
+        BOOST_ASSERT( * this);
+
+        impl_->resume( req);
+        return * this;
+    }
+#else
+    bidirectional_coroutine_call & operator()( Req req)
+    {
+        BOOST_ASSERT( * this);
+
+        impl_->resume( req);
+        return * this;
+    }
+#endif
+
+    bool has_result() const
+    { return 0 != impl_ && impl_->has_result(); }
+
+    Resp get() const
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->get();
+    }
+
+    // the response is owned by the coroutine until it is resumed again,
+    // it is moved out instead of copied
+    Resp take()
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->take();
+    }
+};
+
+template< typename Req, typename Resp >
+void swap( bidirectional_coroutine_call< Req, Resp > & l,
+           bidirectional_coroutine_call< Req, Resp > & r)
+{ l.swap( r); }
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_BIDIRECTIONAL_COROUTINE_CALL_H
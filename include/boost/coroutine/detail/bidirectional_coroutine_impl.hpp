@@ -0,0 +1,196 @@
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_BIDIRECTIONAL_COROUTINE_IMPL_H
+#define BOOST_COROUTINES_DETAIL_BIDIRECTIONAL_COROUTINE_IMPL_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/move/move.hpp>
+#include <boost/throw_exception.hpp>
+#include <boost/utility.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/control_block.hpp>
+#include <boost/coroutine/detail/coroutine_context.hpp>
+#include <boost/coroutine/detail/flags.hpp>
+#include <boost/coroutine/detail/parameters.hpp>
+#include <boost/coroutine/detail/preallocated.hpp>
+#include <boost/coroutine/detail/stored_exception.hpp>
+#include <boost/coroutine/detail/trampoline.hpp>
+#include <boost/coroutine/exceptions.hpp>
+#include <boost/coroutine/flags.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// the request is passed by the context switch resuming the coroutine, the
+// response by the context switch suspending it: one round trip per exchange
+template< typename Req, typename Resp >
+class bidirectional_coroutine_impl : private noncopyable
+{
+protected:
+    // read only after the coroutine has completed
+    exception_ptr           *   except_;
+    // accessed by each context switch (see control_block.hpp)
+    int                         flags_;
+    Resp                    *   result_;
+    coroutine_context           caller_;
+    coroutine_stack_context     callee_;
+
+public:
+    // offset of the members accessed by each context switch
+    static const std::size_t hot_offset = 2 * sizeof( void *);
+
+    typedef parameters< Req >                   param_type;
+    typedef parameters< Resp >                  result_param_type;
+
+    bidirectional_coroutine_impl( preallocated const& palloc,
+                                  bool unwind,
+                                  flag_fpu_t preserve_fpu) BOOST_NOEXCEPT :
+        except_( 0),
+        flags_( 0),
+        result_( 0),
+        caller_(),
+        callee_( trampoline< bidirectional_coroutine_impl< Req, Resp > >, palloc, preserve_fpu)
+    {
+        if ( unwind) flags_ |= flag_force_unwind;
+        BOOST_ASSERT( 0 != palloc.shared ||
+            one_cache_line( & flags_, static_cast< coroutine_context * >( & callee_) + 1) );
+    }
+
+    virtual ~bidirectional_coroutine_impl()
+    { release_exception( except_); }
+
+    bool force_unwind() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_force_unwind); }
+
+    bool unwind_requested() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_unwind_stack); }
+
+    bool is_started() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_started); }
+
+    bool is_running() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_running); }
+
+    bool is_complete() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_complete); }
+
+    stack_context & stack_ctx() BOOST_NOEXCEPT
+    { return callee_.stack_ctx(); }
+
+    bool hibernate()
+    {
+        BOOST_ASSERT( ! is_running() );
+        // the response lives on the stack of the coroutine
+        return ! is_complete() && callee_.hibernate( result_, sizeof( Resp) );
+    }
+
+    bool is_hibernated() const BOOST_NOEXCEPT
+    { return callee_.is_hibernated(); }
+
+    void unwind_stack() BOOST_NOEXCEPT
+    {
+        if ( is_started() && ! is_complete() && force_unwind() )
+        {
+            flags_ |= flag_unwind_stack;
+            flags_ |= flag_running;
+            param_type to( unwind_t::force_unwind);
+            caller_.jump(
+                callee_,
+                & to);
+            flags_ &= ~flag_running;
+            flags_ &= ~flag_unwind_stack;
+
+            BOOST_ASSERT( is_complete() );
+        }
+    }
+
+    // `req` is owned by the caller until the coroutine suspends, the
+    // coroutine may move it out; the response is owned by the coroutine
+    // until it is resumed again
+    void resume( Req & req)
+    {
+        BOOST_ASSERT( ! is_running() );
+        BOOST_ASSERT( ! is_complete() );
+
+        flags_ |= flag_running;
+        param_type to( & req, this);
+        result_param_type * from = 0;
+        try
+        {
+            from = static_cast< result_param_type * >(
+                caller_.jump(
+                    callee_,
+                    & to) );
+        }
+        catch (...)
+        {
+            // the coroutine has not been resumed (see
+            // coroutine_context::jump_record_())
+            flags_ &= ~flag_running;
+            throw;
+        }
+        flags_ &= ~flag_running;
+        result_ = from->data;
+        if ( is_complete() && except_) rethrow_exception( * except_);
+    }
+
+    // passes `resp` to the caller, returns the next request
+    Req * yield( Resp & resp)
+    {
+        BOOST_ASSERT( is_running() );
+        BOOST_ASSERT( ! is_complete() );
+
+        flags_ &= ~flag_running;
+        result_param_type to( & resp, this);
+        param_type * from(
+            static_cast< param_type * >(
+                callee_.jump(
+                    caller_,
+                    & to) ) );
+        flags_ |= flag_running;
+        if ( from->do_unwind) throw forced_unwind();
+        BOOST_ASSERT( from->data);
+        return callee_.passed( from->data);
+    }
+
+    bool has_result() const BOOST_NOEXCEPT
+    { return 0 != result_; }
+
+    Resp & get() const
+    {
+        if ( ! has_result() )
+            boost::throw_exception(
+                invalid_result() );
+        // the stack of the coroutine might be saved by a shared stack
+        return * callee_.saved( result_);
+    }
+
+    Resp take()
+    { return boost::move( get() ); }
+
+    virtual void run( Req *) = 0;
+
+    virtual void destroy() = 0;
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_BIDIRECTIONAL_COROUTINE_IMPL_H
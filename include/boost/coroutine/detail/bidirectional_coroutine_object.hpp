@@ -0,0 +1,132 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_BIDIRECTIONAL_COROUTINE_OBJECT_H
+#define BOOST_COROUTINES_DETAIL_BIDIRECTIONAL_COROUTINE_OBJECT_H
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/context/detail/config.hpp>
+#include <boost/move/move.hpp>
+#include <boost/static_assert.hpp>
+
+#include <boost/coroutine/detail/allocate_stack.hpp>
+#include <boost/coroutine/detail/bidirectional_coroutine_impl.hpp>
+#include <boost/coroutine/detail/bidirectional_coroutine_yield.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/flags.hpp>
+#include <boost/coroutine/detail/preallocated.hpp>
+#include <boost/coroutine/detail/stack_capacity.hpp>
+#include <boost/coroutine/detail/stored_exception.hpp>
+#include <boost/coroutine/exceptions.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+struct stack_context;
+
+namespace detail {
+
+template< typename Req, typename Resp, typename Fn, typename StackAllocator >
+class bidirectional_coroutine_object : public bidirectional_coroutine_impl< Req, Resp >
+{
+private:
+    typedef bidirectional_coroutine_impl< Req, Resp >                           impl_t;
+    typedef bidirectional_coroutine_object< Req, Resp, Fn, StackAllocator >     obj_t;
+
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+    // the members accessed by a context switch fit into one cache line
+    BOOST_STATIC_ASSERT( sizeof( impl_t) - impl_t::hot_offset
+                         - sizeof( coroutine_stack_context) + sizeof( coroutine_context)
+                         <= BOOST_COROUTINES_CACHELINE_SIZE);
+#endif
+
+    Fn                  fn_;
+    StackAllocator      stack_alloc_;
+
+    static void deallocate_( obj_t * obj)
+    {
+        check_stack_capacity< obj_t, StackAllocator >();
+        stack_context stack_ctx( obj->callee_.stack_ctx() );
+        StackAllocator stack_alloc( obj->stack_alloc_);
+        obj->unwind_stack();
+        obj->~obj_t();
+        stack_alloc.deallocate( stack_ctx);
+    }
+
+public:
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+    bidirectional_coroutine_object( Fn fn, attributes const& attrs,
+                                    preallocated const& palloc,
+                                    StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
+        impl_t( with_shared_stack< StackAllocator >( palloc),
+                stack_unwind == attrs.do_unwind,
+                attrs.preserve_fpu),
+        fn_( fn),
+        stack_alloc_( stack_alloc)
+    {}
+#endif
+
+    bidirectional_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
+                                    preallocated const& palloc,
+                                    StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
+        impl_t( with_shared_stack< StackAllocator >( palloc),
+                stack_unwind == attrs.do_unwind,
+                attrs.preserve_fpu),
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+        fn_( fn),
+#else
+        fn_( boost::forward< Fn >( fn) ),
+#endif
+        stack_alloc_( stack_alloc)
+    {}
+
+    void run( Req * req)
+    {
+        BOOST_ASSERT( ! impl_t::unwind_requested() );
+
+        impl_t::flags_ |= flag_started;
+        impl_t::flags_ |= flag_running;
+        try
+        {
+            bidirectional_coroutine_yield< Req, Resp > yc( this, impl_t::callee_.passed( req) );
+            fn_( yc);
+        }
+        catch ( forced_unwind const&)
+        {}
+#if defined( BOOST_CONTEXT_HAS_CXXABI_H )
+        catch ( abi::__forced_unwind const&)
+        { throw; }
+#endif
+        catch (...)
+        { impl_t::except_ = store_current_exception(); }
+
+        impl_t::flags_ |= flag_complete;
+        impl_t::flags_ &= ~flag_running;
+        // no response, the caller is resumed for the last time
+        typename impl_t::result_param_type to;
+        impl_t::callee_.jump(
+            impl_t::caller_,
+            & to);
+        BOOST_ASSERT_MSG( false, "coroutine is complete");
+    }
+
+    void destroy()
+    { deallocate_( this); }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_BIDIRECTIONAL_COROUTINE_OBJECT_H
@@ -0,0 +1,136 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_BIDIRECTIONAL_COROUTINE_YIELD_H
+#define BOOST_COROUTINES_DETAIL_BIDIRECTIONAL_COROUTINE_YIELD_H
+
+#include <algorithm>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/move/move.hpp>
+#include <boost/throw_exception.hpp>
+#include <boost/utility/explicit_operator_bool.hpp>
+
+#include <boost/coroutine/detail/bidirectional_coroutine_impl.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+template< typename Req, typename Resp >
+class bidirectional_coroutine_yield
+{
+private:
+    template< typename W, typename X, typename Y, typename Z >
+    friend class bidirectional_coroutine_object;
+
+    typedef bidirectional_coroutine_impl< Req, Resp >   impl_type;
+
+    BOOST_MOVABLE_BUT_NOT_COPYABLE( bidirectional_coroutine_yield)
+
+    impl_type   *   impl_;
+    Req         *   request_;
+
+    bidirectional_coroutine_yield( impl_type * impl, Req * request) BOOST_NOEXCEPT :
+        impl_( impl),
+        request_( request)
+    {
+        BOOST_ASSERT( 0 != impl_);
+        BOOST_ASSERT( 0 != request_);
+    }
+
+public:
+    bidirectional_coroutine_yield() BOOST_NOEXCEPT :
+        impl_( 0),
+        request_( 0)
+    {}
+
+    bidirectional_coroutine_yield( BOOST_RV_REF( bidirectional_coroutine_yield) other) BOOST_NOEXCEPT :
+        impl_( 0),
+        request_( 0)
+    { swap( other); }
+
+    bidirectional_coroutine_yield & operator=( BOOST_RV_REF( bidirectional_coroutine_yield) other) BOOST_NOEXCEPT
+    {
+        bidirectional_coroutine_yield tmp( boost::move( other) );
+        swap( tmp);
+        return * this;
+    }
+
+    BOOST_EXPLICIT_OPERATOR_BOOL();
+
+    bool operator!() const BOOST_NOEXCEPT
+    { return 0 == impl_; }
+
+    void swap( bidirectional_coroutine_yield & other) BOOST_NOEXCEPT
+    {
+        std::swap( impl_, other.impl_);
+        std::swap( request_, other.request_);
+    }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    // passes a copy of `resp`
+    bidirectional_coroutine_yield & operator()( Resp const& resp)
+    {
+        Resp tmp( resp);
+        return ( * this)( boost::move( tmp) );
+    }
+
+    // passes `resp` without a copy, the caller may move it out;
+    // returns with the next request
+    bidirectional_coroutine_yield & operator()( Resp && resp)
+    {
+        request_ = impl_->yield( resp);
+        return * this;
+    }
+#else
+    bidirectional_coroutine_yield & operator()( Resp resp)
+    {
+        request_ = impl_->yield( resp);
+        return * this;
+    }
+#endif
+
+    Req get() const
+    {
+        if ( 0 == request_)
+            boost::throw_exception(
+                invalid_result() );
+
+        return * request_;
+    }
+
+    // the request is owned by the caller until the next context switch,
+    // it is moved out instead of copied
+    Req take()
+    {
+        if ( 0 == request_)
+            boost::throw_exception(
+                invalid_result() );
+
+        return boost::move( * request_);
+    }
+};
+
+template< typename Req, typename Resp >
+void swap( bidirectional_coroutine_yield< Req, Resp > & l,
+           bidirectional_coroutine_yield< Req, Resp > & r)
+{ l.swap( r); }
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_BIDIRECTIONAL_COROUTINE_YIELD_H
@@ -14,7 +14,18 @@
 # undef BOOST_COROUTINES_DECL
 #endif
 
-#if (defined(BOOST_ALL_DYN_LINK) || defined(BOOST_COROUTINES_DYN_LINK) ) && ! defined(BOOST_COROUTINES_STATIC_LINK)
+#ifdef BOOST_COROUTINES_INLINE
+# undef BOOST_COROUTINES_INLINE
+#endif
+
+#if defined(BOOST_COROUTINES_HEADER_ONLY)
+// the implementation of the library is included by its headers, the
+// context switch path is visible to the compiler and can be inlined
+# if defined(BOOST_COROUTINES_SOURCE)
+#  error "the library must not be built with BOOST_COROUTINES_HEADER_ONLY"
+# endif
+# define BOOST_COROUTINES_INLINE inline
+#elif (defined(BOOST_ALL_DYN_LINK) || defined(BOOST_COROUTINES_DYN_LINK) ) && ! defined(BOOST_COROUTINES_STATIC_LINK)
 # if defined(BOOST_COROUTINES_SOURCE)
 #  define BOOST_COROUTINES_DECL BOOST_SYMBOL_EXPORT
 #  define BOOST_COROUTINES_BUILD_DLL
@@ -23,11 +34,16 @@
 # endif
 #endif
 
+#if ! defined(BOOST_COROUTINES_INLINE)
+# define BOOST_COROUTINES_INLINE
+#endif
+
 #if ! defined(BOOST_COROUTINES_DECL)
 # define BOOST_COROUTINES_DECL
 #endif
 
-#if ! defined(BOOST_COROUTINES_SOURCE) && ! defined(BOOST_ALL_NO_LIB) && ! defined(BOOST_COROUTINES_NO_LIB)
+#if ! defined(BOOST_COROUTINES_SOURCE) && ! defined(BOOST_ALL_NO_LIB) && ! defined(BOOST_COROUTINES_NO_LIB) \
+    && ! defined(BOOST_COROUTINES_HEADER_ONLY)
 # define BOOST_LIB_NAME boost_coroutine
 # if defined(BOOST_ALL_DYN_LINK) || defined(BOOST_COROUTINES_DYN_LINK)
 #  define BOOST_DYN_LINK
@@ -38,6 +54,19 @@
 #define BOOST_COROUTINES_UNIDIRECT
 #define BOOST_COROUTINES_SYMMETRIC
 
+#if ! defined(BOOST_COROUTINES_CACHELINE_SIZE)
+// the members of a control block accessed by a context switch are placed
+// within one cache line
+# define BOOST_COROUTINES_CACHELINE_SIZE 64
+#endif
+
+#if defined(__linux__) && defined(__GNUC__) && ! defined(BOOST_USE_SEGMENTED_STACKS) \
+    && ( ( defined(__x86_64__) && ! defined(__ILP32__) ) || defined(__aarch64__) )
+// context switch saving only the callee-saved general purpose registers
+// (attributes::preserve_fpu == fpu_not_preserved)
+# define BOOST_COROUTINES_HAS_FCONTEXT_NOFPU
+#endif
+
 #if defined(__OpenBSD__)
 // stacks need mmap(2) with MAP_STACK
 # define BOOST_COROUTINES_USE_MAP_STACK
@@ -0,0 +1,68 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_CONTROL_BLOCK_H
+#define BOOST_COROUTINES_DETAIL_CONTROL_BLOCK_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// the members of a control block accessed by each context switch (flags,
+// execution-contexts, result) follow the cold members at its begin (vtable
+// pointer, stored exception, pending batch), `ControlBlock::hot_offset` is
+// the offset of the first of them
+
+// upper bound of the bytes reserved in addition to `sizeof( ControlBlock)`
+template< typename ControlBlock >
+struct control_block_padding
+{
+    static const std::size_t value =
+        BOOST_COROUTINES_CACHELINE_SIZE - 1 + alignment_of< ControlBlock >::value - 1;
+};
+
+// returns the number of bytes to reserve on top of the stack `sctx` for the
+// control block so that its hot members start at a cache line boundary; the
+// address of the control block is rounded down to its alignment
+template< typename ControlBlock >
+std::size_t control_block_size( stack_context const& sctx) BOOST_NOEXCEPT
+{
+    const std::size_t top = reinterpret_cast< std::size_t >( sctx.sp);
+    const std::size_t hot = top - sizeof( ControlBlock) + ControlBlock::hot_offset;
+    std::size_t address = top - sizeof( ControlBlock) - ( hot & ( BOOST_COROUTINES_CACHELINE_SIZE - 1) );
+    address &= ~static_cast< std::size_t >( alignment_of< ControlBlock >::value - 1);
+    BOOST_ASSERT( top - address < sctx.size);
+    return top - address;
+}
+
+// returns true if [begin, end) is part of one cache line
+inline bool one_cache_line( void const* begin, void const* end) BOOST_NOEXCEPT
+{
+    const std::size_t mask = ~static_cast< std::size_t >( BOOST_COROUTINES_CACHELINE_SIZE - 1);
+    return ( reinterpret_cast< std::size_t >( begin) & mask)
+        == ( ( reinterpret_cast< std::size_t >( end) - 1) & mask);
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_CONTROL_BLOCK_H
@@ -12,9 +12,15 @@
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
 #include <boost/context/detail/fcontext.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/type_traits/has_trivial_copy.hpp>
+#include <boost/type_traits/has_trivial_destructor.hpp>
 
 #include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/fcontext_nofpu.hpp>
 #include <boost/coroutine/detail/preallocated.hpp>
+#include <boost/coroutine/detail/shared_stack_record.hpp>
+#include <boost/coroutine/flags.hpp>
 #include <boost/coroutine/stack_context.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -25,7 +31,11 @@ namespace boost {
 namespace coroutines {
 namespace detail {
 
-// class hold stack-context and coroutines execution-context
+BOOST_COROUTINES_DECL void shared_stack_switch( context::detail::transfer_t);
+
+// class hold execution-context; contexts of callers consist of the
+// suspended execution-context only, the stack of a coroutine is described by
+// coroutine_stack_context
 class BOOST_COROUTINES_DECL coroutine_context
 {
 private:
@@ -39,9 +49,100 @@ private:
     friend void trampoline_push( context::detail::transfer_t);
     template< typename Coro >
     friend void trampoline_push_void( context::detail::transfer_t);
+    friend void shared_stack_switch( context::detail::transfer_t);
+
+    // records `fctx` of the execution-context which has been left
+    void suspended_( context::detail::fcontext_t fctx) BOOST_NOEXCEPT
+    {
+        ctx_ = fctx;
+        shared_stack_record * r = stack_record_();
+        if ( 0 != r) r->sp = fctx;
+    }
+
+    // resumes `other` from jump_record_(), the execution-context left is
+    // suspended by the same function as `other` was (tagged by nofpu_tag)
+    context::detail::transfer_t switch_( coroutine_context & other, void * vp) BOOST_NOEXCEPT
+    {
+#if defined(BOOST_COROUTINES_HAS_FCONTEXT_NOFPU)
+        record_ = tagged_( stack_record_(), ( tags_() & assigned_tag) | ( other.tags_() & nofpu_tag) );
+        if ( other.nofpu_() )
+            return boost_coroutines_jump_fcontext_nofpu( other.ctx_, vp);
+#endif
+        return context::detail::jump_fcontext( other.ctx_, vp);
+    }
+
+    // moves the stack of this execution-context onto its shared stack,
+    // the stack of the current owner is saved
+    void occupy_();
+
+    void * switch_shared_( coroutine_context &, void *);
+
+    // jump() to an execution-context on a shared stack or a hibernated one,
+    // kept out of the inlined path of jump()
+    void * jump_record_( coroutine_context &, void *);
+
+    // restores the stack of a hibernated execution-context
+    void wake_();
+
+    void * saved_( void const*) const BOOST_NOEXCEPT;
 
-    preallocated            palloc_;
+    void * passed_( void const*) const BOOST_NOEXCEPT;
+
+    // objects are moved together with the stack by memcpy(), only objects
+    // of trivially copyable types can be accessed at their copy
+    template< typename T >
+    static T * relocated_( T * p, T * copy) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT_MSG( p == copy ||
+                          ( has_trivial_copy< T >::value && has_trivial_destructor< T >::value),
+                          "object on a saved shared stack is not trivially copyable");
+        ( void) p;
+        return copy;
+    }
+
+protected:
     context::detail::fcontext_t     ctx_;
+    // shared stack holding the execution-context suspended in `ctx_`, or
+    // buffer of a hibernated execution-context (record without stack)
+    // a context without a record of its own (caller) is assigned the record
+    // of the coroutine of the shared stack it was suspended on, tagged by
+    // assigned_tag (see jump_record_()); the assigned record is valid only
+    // while the context is suspended
+    // nofpu_tag marks an execution-context suspended by
+    // jump_fcontext_nofpu(), set for contexts created with
+    // fpu_not_preserved and for the contexts which resumed them; a context
+    // with any bit set is switched by jump_record_(), jump() calls
+    // jump_fcontext() for the others
+    shared_stack_record *   record_;
+#if defined(BOOST_USE_SEGMENTED_STACKS)
+    // segments of the execution-context suspended in `ctx_`
+    stack_context::segments_context segments_ctx_;
+#endif
+
+    enum { assigned_tag = 1, nofpu_tag = 2, tag_mask = 3 };
+
+    static shared_stack_record * tagged_( shared_stack_record * r, boost::uintptr_t tags) BOOST_NOEXCEPT
+    {
+        return reinterpret_cast< shared_stack_record * >(
+            reinterpret_cast< boost::uintptr_t >( r) | tags);
+    }
+
+    boost::uintptr_t tags_() const BOOST_NOEXCEPT
+    { return reinterpret_cast< boost::uintptr_t >( record_) & tag_mask; }
+
+    // record assigned by jump_record_()
+    bool assigned_() const BOOST_NOEXCEPT
+    { return 0 != ( tags_() & assigned_tag); }
+
+    bool nofpu_() const BOOST_NOEXCEPT
+    { return 0 != ( tags_() & nofpu_tag); }
+
+    // `record_` without the tags
+    shared_stack_record * stack_record_() const BOOST_NOEXCEPT
+    {
+        return reinterpret_cast< shared_stack_record * >(
+            reinterpret_cast< boost::uintptr_t >( record_) & ~static_cast< boost::uintptr_t >( tag_mask) );
+    }
 
 public:
     typedef void( * ctx_fn)( context::detail::transfer_t);
@@ -52,16 +153,72 @@ public:
     // ctor creates a new execution-context running coroutine-fn `fn`
     // `ctx_` will be allocated on top of the stack managed by parameter
     // `stack_ctx`
-    coroutine_context( ctx_fn fn, preallocated const& palloc);
+    // a coroutine on a shared stack (`palloc.shared`) is set up when it
+    // occupies the shared stack for the first time
+    // with `fpu_not_preserved` the floating-point control registers (and
+    // callee-saved floating-point registers) are not preserved across a
+    // context switch from or to this context (ignored for shared stacks or
+    // if BOOST_COROUTINES_HAS_FCONTEXT_NOFPU is not defined)
+    coroutine_context( ctx_fn fn, preallocated const& palloc,
+                       flag_fpu_t preserve_fpu = fpu_preserved);
 
     coroutine_context( coroutine_context const&);
 
+    ~coroutine_context();
+
     coroutine_context& operator=( coroutine_context const&);
 
     void * jump( coroutine_context &, void * = 0);
 
-    stack_context & stack_ctx()
-    { return palloc_.sctx; }
+    bool is_hibernated() const BOOST_NOEXCEPT
+    { return 0 != stack_record_() && ! assigned_() && 0 == stack_record_()->stack; }
+
+    // `p` points to an object on the stack of this suspended
+    // execution-context; returns the address of its copy while another
+    // coroutine occupies the shared stack (the stack is saved to a buffer)
+    template< typename T >
+    T * saved( T * p) const BOOST_NOEXCEPT
+    { return 0 != stack_record_() ? relocated_( p, static_cast< T * >( saved_( p) ) ) : p; }
+
+    // `p` has been passed to this execution-context by the jump() resuming
+    // it; returns the address of its copy if the sender runs on the same
+    // shared stack (its stack has been saved by the switch)
+    template< typename T >
+    T * passed( T * p) const BOOST_NOEXCEPT
+    { return 0 != stack_record_() ? relocated_( p, static_cast< T * >( passed_( p) ) ) : p; }
+};
+
+// execution-context of a coroutine together with the only copy of the
+// descriptor of its stack
+class BOOST_COROUTINES_DECL coroutine_stack_context : public coroutine_context
+{
+private:
+    stack_context       sctx_;
+    // the control block of the coroutine is placed in [sp_, sctx_.sp)
+    void            *   sp_;
+
+public:
+    coroutine_stack_context( ctx_fn fn, preallocated const& palloc,
+                             flag_fpu_t preserve_fpu = fpu_preserved);
+
+    // copies the live part of the stack of the suspended execution-context
+    // to a buffer and hands the other pages of the stack back to the
+    // operating system, the stack is restored by the next jump() to this
+    // context
+    // the pages holding [keep, keep + keep_size) stay in place
+    // returns false if the stack is not hibernated (shared or segmented
+    // stack, BOOST_COROUTINES_NO_HIBERNATE, see impl/hibernate.ipp)
+    bool hibernate( void const* keep = 0, std::size_t keep_size = 0);
+
+    stack_context & stack_ctx() BOOST_NOEXCEPT
+    {
+#if defined(BOOST_USE_SEGMENTED_STACKS)
+        // the segments are tracked by the execution-context
+        for ( std::size_t i = 0; i < BOOST_CONTEXT_SEGMENTS; ++i)
+            sctx_.segments_ctx[i] = segments_ctx_[i];
+#endif
+        return sctx_;
+    }
 };
 
 }}}
@@ -70,4 +227,9 @@ public:
 #  include BOOST_ABI_SUFFIX
 #endif
 
+#if defined(BOOST_COROUTINES_HEADER_ONLY)
+# include <boost/coroutine/detail/impl/coroutine_context.ipp>
+# include <boost/coroutine/detail/impl/hibernate.ipp>
+#endif
+
 #endif // BOOST_COROUTINES_DETAIL_COROUTINE_CONTEXT_H
@@ -0,0 +1,45 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_FCONTEXT_NOFPU_H
+#define BOOST_COROUTINES_DETAIL_FCONTEXT_NOFPU_H
+
+#include <cstddef>
+
+#include <boost/config.hpp>
+#include <boost/context/detail/fcontext.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#if defined(BOOST_COROUTINES_HAS_FCONTEXT_NOFPU)
+// counterparts of make_fcontext()/jump_fcontext() of Boost.Context saving
+// and restoring only the callee-saved general purpose registers (and the
+// return address), the floating-point control words (MXCSR and x87 control
+// word on x86_64) and the callee-saved floating-point registers (d8-d15 on
+// AArch64) are left as they are; the stack layout differs from the one of
+// Boost.Context, a context suspended by jump_fcontext_nofpu() must be
+// resumed by jump_fcontext_nofpu()
+extern "C" {
+
+boost::context::detail::transfer_t
+boost_coroutines_jump_fcontext_nofpu( boost::context::detail::fcontext_t const to, void * vp);
+
+boost::context::detail::fcontext_t
+boost_coroutines_make_fcontext_nofpu( void * sp, std::size_t size,
+                                      void ( * fn)( boost::context::detail::transfer_t) );
+
+}
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_FCONTEXT_NOFPU_H
@@ -23,7 +23,14 @@ enum flag_t
     flag_running        = 1 << 2,
     flag_complete       = 1 << 3,
     flag_unwind_stack   = 1 << 4,
-    flag_force_unwind   = 1 << 5
+    flag_force_unwind   = 1 << 5,
+    flag_deferred       = 1 << 6,
+    // values are passed in the data word of a context switch
+    flag_by_value       = 1 << 7,
+    // the value passed by value is stored in the coroutine
+    flag_has_value      = 1 << 8,
+    // the values of a batch are pulled without a context switch
+    flag_batch          = 1 << 9
 };
 
 struct unwind_t
@@ -0,0 +1,397 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_IMPL_COROUTINE_CONTEXT_IPP
+#define BOOST_COROUTINES_DETAIL_IMPL_COROUTINE_CONTEXT_IPP
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/coroutine_context.hpp>
+#include <boost/coroutine/detail/data.hpp>
+#include <boost/coroutine/detail/impl/fcontext_nofpu.ipp>
+#include <boost/coroutine/detail/shared_stack.hpp>
+#include <boost/coroutine/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+#if defined(_MSC_VER)
+# pragma warning(push)
+# pragma warning(disable:4355)
+#endif
+
+#if defined(BOOST_USE_SEGMENTED_STACKS)
+extern "C" {
+
+void __splitstack_getcontext( void * [BOOST_CONTEXT_SEGMENTS]);
+
+void __splitstack_setcontext( void * [BOOST_CONTEXT_SEGMENTS]);
+
+}
+#endif
+
+#if ! defined(BOOST_NO_CXX11_THREAD_LOCAL)
+# define BOOST_COROUTINES_THREAD_LOCAL thread_local
+#elif defined(BOOST_MSVC)
+# define BOOST_COROUTINES_THREAD_LOCAL __declspec(thread)
+#else
+# define BOOST_COROUTINES_THREAD_LOCAL __thread
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+BOOST_COROUTINES_INLINE
+shared_stack *& running_stack() BOOST_NOEXCEPT
+{
+    static BOOST_COROUTINES_THREAD_LOCAL shared_stack * stack = 0;
+    return stack;
+}
+
+// true if `p` lies within the shared stack `s`
+inline
+bool on_stack( shared_stack const& s, void const* p) BOOST_NOEXCEPT
+{
+    char const* top = static_cast< char const* >( s.sctx.sp);
+    char const* c = static_cast< char const* >( p);
+    return top - s.sctx.size < c && c <= top;
+}
+
+// upper bound of the stack used by jump() below the address of a local
+// variable (frame of jump_fcontext())
+const std::size_t jump_frame_size = 1024;
+
+BOOST_COROUTINES_INLINE
+void reserve_buffer( shared_stack_record & r, std::size_t size)
+{
+    if ( size <= r.capacity) return;
+    // round up to limit the number of reallocations
+    size = ( size + 255) & ~static_cast< std::size_t >( 255);
+    char * buffer = static_cast< char * >( std::realloc( r.buffer, size) );
+    if ( 0 == buffer) throw std::bad_alloc();
+    r.stack->buffer_bytes += size - r.capacity;
+    r.buffer = buffer;
+    r.capacity = size;
+}
+
+// copies the live part of the stack of `r` to its buffer
+BOOST_COROUTINES_INLINE
+void save_stack( shared_stack_record & r)
+{
+    // the stack pointer of the owner is recorded if it has been suspended
+    // by jump_record_() or switch_shared_() (checked by jump_record_())
+    BOOST_ASSERT( 0 != r.sp);
+    char * top = static_cast< char * >( r.stack->sctx.sp);
+    char * sp = static_cast< char * >( r.sp);
+    BOOST_ASSERT( top - r.stack->sctx.size < sp && sp <= top);
+    r.size = top - sp;
+    reserve_buffer( r, r.size);
+    std::memcpy( r.buffer, sp, r.size);
+    r.stack->copied_bytes += r.size;
+}
+
+// maps `p` from the live part of the saved stack of `r` to its buffer
+inline
+void * relocate( shared_stack_record const& r, void const* p) BOOST_NOEXCEPT
+{
+    char * c = static_cast< char * >( const_cast< void * >( p) );
+    char * sp = static_cast< char * >( r.sp);
+    if ( 0 != sp && sp <= c && c < static_cast< char * >( r.stack->sctx.sp) )
+        return r.buffer + ( c - sp);
+    return c;
+}
+
+BOOST_COROUTINES_INLINE
+coroutine_context::coroutine_context() :
+    ctx_( 0),
+    record_( 0)
+#if defined(BOOST_USE_SEGMENTED_STACKS)
+    , segments_ctx_()
+#endif
+{}
+
+BOOST_COROUTINES_INLINE
+coroutine_context::coroutine_context( ctx_fn fn, preallocated const& palloc,
+                                      flag_fpu_t preserve_fpu) :
+    ctx_( 0),
+    record_( palloc.shared)
+{
+    if ( 0 == record_)
+    {
+#if defined(BOOST_COROUTINES_HAS_FCONTEXT_NOFPU)
+        if ( fpu_not_preserved == preserve_fpu)
+        {
+            ctx_ = boost_coroutines_make_fcontext_nofpu( palloc.sp, palloc.size, fn);
+            record_ = tagged_( 0, nofpu_tag);
+        }
+        else
+#endif
+            ctx_ = context::detail::make_fcontext( palloc.sp, palloc.size, fn);
+    }
+#if defined(BOOST_USE_SEGMENTED_STACKS)
+    std::memcpy( segments_ctx_, palloc.sctx.segments_ctx, sizeof( segments_ctx_) );
+#endif
+    if ( 0 != palloc.shared)
+    {
+        // the control block must fit into the memory of the allocator
+        BOOST_ASSERT( palloc.size < palloc.sctx.size);
+        record_->fn = fn;
+    }
+}
+
+BOOST_COROUTINES_INLINE
+coroutine_context::coroutine_context( coroutine_context const& other) :
+    ctx_( other.ctx_),
+    record_( other.record_)
+{
+    BOOST_ASSERT( ! other.is_hibernated() );
+#if defined(BOOST_USE_SEGMENTED_STACKS)
+    std::memcpy( segments_ctx_, other.segments_ctx_, sizeof( segments_ctx_) );
+#endif
+}
+
+BOOST_COROUTINES_INLINE
+coroutine_context::~coroutine_context()
+{
+    // a hibernated coroutine destroyed without unwinding its stack
+    if ( is_hibernated() )
+    {
+        std::free( stack_record_()->buffer);
+        delete stack_record_();
+    }
+}
+
+BOOST_COROUTINES_INLINE coroutine_context &
+coroutine_context::operator=( coroutine_context const& other)
+{
+    if ( this == & other) return * this;
+
+    BOOST_ASSERT( ! is_hibernated() && ! other.is_hibernated() );
+    ctx_ = other.ctx_;
+    record_ = other.record_;
+#if defined(BOOST_USE_SEGMENTED_STACKS)
+    std::memcpy( segments_ctx_, other.segments_ctx_, sizeof( segments_ctx_) );
+#endif
+
+    return * this;
+}
+
+BOOST_COROUTINES_INLINE void
+coroutine_context::occupy_()
+{
+    shared_stack_record & r = * stack_record_();
+    shared_stack * s = r.stack;
+    if ( 0 != s->owner) save_stack( * s->owner);
+    if ( 0 != r.fn)
+    {
+        ctx_ = context::detail::make_fcontext( s->sctx.sp, s->sctx.size, r.fn);
+        r.fn = 0;
+    }
+    else
+    {
+        BOOST_ASSERT( ctx_ == r.sp);
+        std::memcpy( r.sp, r.buffer, r.size);
+        s->copied_bytes += r.size;
+    }
+    s->owner = & r;
+}
+
+// the running coroutine and the resumed coroutine share a stack; the stacks
+// are exchanged by the switcher which does not run on the shared stack
+struct switch_data
+{
+    coroutine_context   *   from;
+    coroutine_context   *   to;
+    void                *   data;
+};
+
+BOOST_COROUTINES_INLINE
+void shared_stack_switch( context::detail::transfer_t t)
+{
+    for (;;)
+    {
+        // `switch_data` lives on the shared stack
+        switch_data * sd = static_cast< switch_data * >( t.data);
+        coroutine_context * to = sd->to;
+        char * param = static_cast< char * >( sd->data);
+        shared_stack_record * from = sd->from->stack_record_();
+        sd->from->suspended_( t.fctx);
+        to->occupy_();
+        // the parameter lives on the stack of the leaving coroutine, it is
+        // passed from its copy; the receiver maps the pointers into the
+        // parameter (coroutine_context::passed())
+        param = static_cast< char * >( relocate( * from, param) );
+        shared_stack_record * r = to->stack_record_();
+        r->stack->sender = from;
+        r->sp = 0;
+        coroutine_context & switcher = r->stack->switcher;
+        data_t data = { & switcher, param };
+        t = switcher.switch_( * to, & data);
+    }
+}
+
+BOOST_COROUTINES_INLINE void *
+coroutine_context::switch_shared_( coroutine_context & other, void * param)
+{
+    shared_stack * s = other.stack_record_()->stack;
+    // the buffer is reserved here, allocation might throw
+    char c = 0;
+    reserve_buffer( * stack_record_(),
+             static_cast< char * >( s->sctx.sp) - & c + jump_frame_size);
+    running_stack() = s;
+    switch_data sd = { this, & other, param };
+    context::detail::transfer_t t = switch_( s->switcher, & sd);
+    data_t * ret = static_cast< data_t * >( t.data);
+    ret->from->suspended_( t.fctx);
+    if ( assigned_() ) record_ = 0;
+    return ret->data;
+}
+
+BOOST_COROUTINES_INLINE void *
+coroutine_context::saved_( void const* p) const BOOST_NOEXCEPT
+{
+    shared_stack_record * r = stack_record_();
+    if ( 0 == r->stack || r->stack->owner == r) return const_cast< void * >( p);
+    return relocate( * r, p);
+}
+
+BOOST_COROUTINES_INLINE void *
+coroutine_context::passed_( void const* p) const BOOST_NOEXCEPT
+{
+    shared_stack * s = stack_record_()->stack;
+    if ( 0 == s || 0 == s->sender || s->sender == s->owner) return const_cast< void * >( p);
+    return relocate( * s->sender, p);
+}
+
+BOOST_COROUTINES_INLINE
+coroutine_stack_context::coroutine_stack_context( ctx_fn fn, preallocated const& palloc,
+                                                  flag_fpu_t preserve_fpu) :
+    coroutine_context( fn, palloc, preserve_fpu),
+    sctx_( palloc.sctx),
+    sp_( palloc.sp)
+{}
+
+BOOST_COROUTINES_INLINE void
+coroutine_context::wake_()
+{
+    BOOST_ASSERT( is_hibernated() );
+    shared_stack_record * r = stack_record_();
+    if ( 0 != r->size)
+    {
+        char * sp = static_cast< char * >( r->sp);
+        const std::size_t below = r->kept - sp;
+        std::memcpy( sp, r->buffer, below);
+        std::memcpy( r->kept + r->kept_size, r->buffer + below,
+                     r->size - below);
+    }
+    std::free( r->buffer);
+    delete r;
+    record_ = tagged_( 0, tags_() );
+}
+
+BOOST_COROUTINES_INLINE BOOST_NOINLINE void *
+coroutine_context::jump_record_( coroutine_context & other, void * param)
+{
+    shared_stack_record * r = other.stack_record_();
+    if ( 0 == r && 0 == stack_record_() )
+    {
+        // only tagged by nofpu_tag, switched like the contexts without tags
+        data_t data = { this, param };
+        context::detail::transfer_t t = switch_( other, & data);
+        data_t * ret = static_cast< data_t * >( t.data);
+        ret->from->suspended_( t.fctx);
+        return ret->data;
+    }
+    if ( 0 == stack_record_() || assigned_() )
+    {
+        // a context without a record of its own is assigned the record of
+        // the coroutine occupying the shared stack it runs on: the stack of
+        // `other` or the hint, checked by the address of a local
+        char c = 0;
+        shared_stack * s = 0;
+        if ( 0 != r && 0 != r->stack && on_stack( * r->stack, & c) )
+            s = r->stack;
+        else if ( 0 != running_stack() && on_stack( * running_stack(), & c) )
+            s = running_stack();
+        record_ = 0 != s ? tagged_( s->owner, assigned_tag) : 0;
+    }
+    if ( 0 != r && 0 == r->stack)
+    {
+        other.wake_();
+        r = 0;
+    }
+    else if ( 0 != r)
+    {
+        shared_stack * s = r->stack;
+        if ( s->owner != r)
+        {
+            if ( 0 != stack_record_() && stack_record_()->stack == s)
+                return switch_shared_( other, param);
+            // the owner has resumed a coroutine with a stack of its own
+            // which has not switched back, the switch between stacks of
+            // their own does not record the stack pointer of the owner
+            if ( 0 != s->owner && 0 == s->owner->sp)
+            {
+                if ( assigned_() ) record_ = 0;
+                boost::throw_exception(
+                    coroutine_error(
+                        system::make_error_code( coroutine_errc::shared_stack_occupied) ) );
+            }
+            other.occupy_();
+        }
+        // `r` runs, its stack pointer is recorded if it is suspended
+        s->sender = 0;
+        r->sp = 0;
+    }
+    running_stack() = 0 != r ? r->stack : 0;
+    data_t data = { this, param };
+    context::detail::transfer_t t = switch_( other, & data);
+    data_t * ret = static_cast< data_t * >( t.data);
+    ret->from->suspended_( t.fctx);
+    if ( assigned_() ) record_ = 0;
+    return ret->data;
+}
+
+BOOST_COROUTINES_INLINE void *
+coroutine_context::jump( coroutine_context & other, void * param)
+{
+#if defined(BOOST_USE_SEGMENTED_STACKS)
+    __splitstack_getcontext( segments_ctx_);
+    __splitstack_setcontext( other.segments_ctx_);
+#endif
+    // a context switch between execution-contexts with stacks of their own
+    // (or running on a shared stack without a record, see jump_record_())
+    // suspended by jump_fcontext()
+    if ( 0 != record_ || 0 != other.record_) return jump_record_( other, param);
+    data_t data = { this, param };
+    context::detail::transfer_t t = context::detail::jump_fcontext( other.ctx_, & data);
+    data_t * ret = static_cast< data_t * >( t.data);
+    ret->from->suspended_( t.fctx);
+    return ret->data;
+}
+
+}}}
+
+#if defined(_MSC_VER)
+# pragma warning(pop)
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#undef BOOST_COROUTINES_THREAD_LOCAL
+
+#endif // BOOST_COROUTINES_DETAIL_IMPL_COROUTINE_CONTEXT_IPP
@@ -0,0 +1,59 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_IMPL_EXCEPTIONS_IPP
+#define BOOST_COROUTINES_DETAIL_IMPL_EXCEPTIONS_IPP
+
+#include <string>
+
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/exceptions.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+class coroutine_error_category : public system::error_category
+{
+public:
+    virtual const char* name() const BOOST_NOEXCEPT
+    { return "coroutine"; }
+
+    virtual std::string message( int ev) const
+    {
+        switch (BOOST_SCOPED_ENUM_NATIVE(coroutine_errc)(ev))
+        {
+        case coroutine_errc::no_data:
+            return std::string("Operation not permitted because coroutine "
+                          "has no valid result.");
+        case coroutine_errc::shared_stack_occupied:
+            return std::string("Operation not permitted because the coroutine "
+                          "occupying the shared stack is suspended by a switch "
+                          "to a coroutine with a stack of its own.");
+        }
+        return std::string("unspecified coroutine_errc value\n");
+    }
+};
+
+BOOST_COROUTINES_INLINE
+system::error_category const& coroutine_category() BOOST_NOEXCEPT
+{
+    static coroutines::coroutine_error_category cat;
+    return cat;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_IMPL_EXCEPTIONS_IPP
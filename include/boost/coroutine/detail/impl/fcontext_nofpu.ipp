@@ -0,0 +1,155 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_IMPL_FCONTEXT_NOFPU_IPP
+#define BOOST_COROUTINES_DETAIL_IMPL_FCONTEXT_NOFPU_IPP
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/fcontext_nofpu.hpp>
+
+#if defined(BOOST_COROUTINES_HAS_FCONTEXT_NOFPU)
+// the functions are emitted as weak symbols into COMDAT sections: each
+// translation unit including this file in the header-only configuration
+// carries a copy, the linker keeps one of them
+
+# if defined(__x86_64__)
+/****************************************************************************************
+ *  fcontext (x86_64 System V, without MXCSR and x87 control word)                      *
+ *  ----------------------------------------------------------------------------------  *
+ *  |    0x0    |    0x8    |   0x10    |   0x18    |   0x20    |   0x28    |   0x30  | *
+ *  ----------------------------------------------------------------------------------  *
+ *  |    R12    |    R13    |    R14    |    R15    |    RBX    |    RBP    |   RIP   | *
+ *  ----------------------------------------------------------------------------------  *
+ ****************************************************************************************/
+__asm__ (
+    ".section .text.boost_coroutines_jump_fcontext_nofpu,\"axG\",@progbits,boost_coroutines_jump_fcontext_nofpu,comdat\n"
+    ".weak boost_coroutines_jump_fcontext_nofpu\n"
+    ".type boost_coroutines_jump_fcontext_nofpu,@function\n"
+    ".align 16\n"
+"boost_coroutines_jump_fcontext_nofpu:\n"
+    // RDI: fcontext to resume, RSI: data
+    "    leaq  -0x30(%rsp), %rsp\n"
+    "    movq  %r12, 0x00(%rsp)\n"
+    "    movq  %r13, 0x08(%rsp)\n"
+    "    movq  %r14, 0x10(%rsp)\n"
+    "    movq  %r15, 0x18(%rsp)\n"
+    "    movq  %rbx, 0x20(%rsp)\n"
+    "    movq  %rbp, 0x28(%rsp)\n"
+    // fcontext of the suspended context
+    "    movq  %rsp, %rax\n"
+    "    movq  %rdi, %rsp\n"
+    "    movq  0x30(%rsp), %r8\n"
+    "    movq  0x00(%rsp), %r12\n"
+    "    movq  0x08(%rsp), %r13\n"
+    "    movq  0x10(%rsp), %r14\n"
+    "    movq  0x18(%rsp), %r15\n"
+    "    movq  0x20(%rsp), %rbx\n"
+    "    movq  0x28(%rsp), %rbp\n"
+    "    leaq  0x38(%rsp), %rsp\n"
+    // transfer_t is returned in RAX:RDX, passed to the context-function
+    // of a new context in RDI:RSI
+    "    movq  %rsi, %rdx\n"
+    "    movq  %rax, %rdi\n"
+    "    jmp   *%r8\n"
+    ".size boost_coroutines_jump_fcontext_nofpu,.-boost_coroutines_jump_fcontext_nofpu\n"
+    ".text\n"
+);
+
+__asm__ (
+    ".section .text.boost_coroutines_make_fcontext_nofpu,\"axG\",@progbits,boost_coroutines_make_fcontext_nofpu,comdat\n"
+    ".weak boost_coroutines_make_fcontext_nofpu\n"
+    ".type boost_coroutines_make_fcontext_nofpu,@function\n"
+    ".align 16\n"
+"boost_coroutines_make_fcontext_nofpu:\n"
+    // RDI: top of the stack, RSI: size of the stack, RDX: context-function
+    "    movq  %rdi, %rax\n"
+    "    andq  $-16, %rax\n"
+    // RSP is 16 byte aligned after the context is resumed
+    "    leaq  -0x48(%rax), %rax\n"
+    // the context-function is called from RBX
+    "    movq  %rdx, 0x20(%rax)\n"
+    "    movq  $0, 0x28(%rax)\n"
+    "    leaq  1f(%rip), %rcx\n"
+    "    movq  %rcx, 0x30(%rax)\n"
+    "    ret\n"
+"1:\n"
+    "    call  *%rbx\n"
+    // the context-function must not return
+    "    ud2\n"
+    ".size boost_coroutines_make_fcontext_nofpu,.-boost_coroutines_make_fcontext_nofpu\n"
+    ".text\n"
+);
+# elif defined(__aarch64__)
+/****************************************************************************************
+ *  fcontext (AArch64 AAPCS64, without FPCR and d8-d15)                                 *
+ *  ----------------------------------------------------------------------------------  *
+ *  |    0x0    |    0x8    |   0x10    |   0x18    |   0x20    |   0x28    |   ...   | *
+ *  ----------------------------------------------------------------------------------  *
+ *  |    x19    |    x20    |    x21    |    x22    |    x23    |    x24    |   ...   | *
+ *  ----------------------------------------------------------------------------------  *
+ *  |   0x30    |   0x38    |   0x40    |   0x48    |   0x50    |   0x58    |           *
+ *  ----------------------------------------------------------------------------------  *
+ *  |    x25    |    x26    |    x27    |    x28    |  FP (x29) |  LR (x30) |           *
+ *  ----------------------------------------------------------------------------------  *
+ ****************************************************************************************/
+__asm__ (
+    ".section .text.boost_coroutines_jump_fcontext_nofpu,\"axG\",@progbits,boost_coroutines_jump_fcontext_nofpu,comdat\n"
+    ".weak boost_coroutines_jump_fcontext_nofpu\n"
+    ".type boost_coroutines_jump_fcontext_nofpu,%function\n"
+    ".align 4\n"
+"boost_coroutines_jump_fcontext_nofpu:\n"
+    // x0: fcontext to resume, x1: data
+    "    sub  sp, sp, #0x60\n"
+    "    stp  x19, x20, [sp, #0x00]\n"
+    "    stp  x21, x22, [sp, #0x10]\n"
+    "    stp  x23, x24, [sp, #0x20]\n"
+    "    stp  x25, x26, [sp, #0x30]\n"
+    "    stp  x27, x28, [sp, #0x40]\n"
+    "    stp  x29, x30, [sp, #0x50]\n"
+    // fcontext of the suspended context
+    "    mov  x4, sp\n"
+    "    mov  sp, x0\n"
+    "    ldp  x19, x20, [sp, #0x00]\n"
+    "    ldp  x21, x22, [sp, #0x10]\n"
+    "    ldp  x23, x24, [sp, #0x20]\n"
+    "    ldp  x25, x26, [sp, #0x30]\n"
+    "    ldp  x27, x28, [sp, #0x40]\n"
+    "    ldp  x29, x30, [sp, #0x50]\n"
+    "    add  sp, sp, #0x60\n"
+    // transfer_t is returned in x0:x1, passed to the context-function of
+    // a new context in x0:x1
+    "    mov  x0, x4\n"
+    "    ret\n"
+    ".size boost_coroutines_jump_fcontext_nofpu,.-boost_coroutines_jump_fcontext_nofpu\n"
+    ".text\n"
+);
+
+__asm__ (
+    ".section .text.boost_coroutines_make_fcontext_nofpu,\"axG\",@progbits,boost_coroutines_make_fcontext_nofpu,comdat\n"
+    ".weak boost_coroutines_make_fcontext_nofpu\n"
+    ".type boost_coroutines_make_fcontext_nofpu,%function\n"
+    ".align 4\n"
+"boost_coroutines_make_fcontext_nofpu:\n"
+    // x0: top of the stack, x1: size of the stack, x2: context-function
+    "    and  x0, x0, #~0xF\n"
+    "    sub  x0, x0, #0x70\n"
+    // the context-function is called from x19
+    "    str  x2, [x0, #0x00]\n"
+    "    str  xzr, [x0, #0x50]\n"
+    "    adr  x3, 1f\n"
+    "    str  x3, [x0, #0x58]\n"
+    "    ret\n"
+"1:\n"
+    "    blr  x19\n"
+    // the context-function must not return
+    "    brk  #0\n"
+    ".size boost_coroutines_make_fcontext_nofpu,.-boost_coroutines_make_fcontext_nofpu\n"
+    ".text\n"
+);
+# endif
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_IMPL_FCONTEXT_NOFPU_IPP
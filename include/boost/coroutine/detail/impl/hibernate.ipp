@@ -0,0 +1,128 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_IMPL_HIBERNATE_IPP
+#define BOOST_COROUTINES_DETAIL_IMPL_HIBERNATE_IPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/coroutine_context.hpp>
+#include <boost/coroutine/detail/shared_stack_record.hpp>
+#include <boost/coroutine/stack_traits.hpp>
+
+// with BOOST_COROUTINES_HEADER_ONLY the headers include this file, defining
+// BOOST_COROUTINES_NO_HIBERNATE keeps <windows.h> and <sys/mman.h> out of
+// the translation units, hibernate() keeps the stack then
+#if ! defined(BOOST_USE_SEGMENTED_STACKS) && \
+    ! ( defined(BOOST_COROUTINES_HEADER_ONLY) && defined(BOOST_COROUTINES_NO_HIBERNATE) )
+# define BOOST_COROUTINES_HIBERNATE
+# if defined(BOOST_WINDOWS)
+#  include <boost/coroutine/detail/windows.hpp>
+# else
+extern "C" {
+#include <sys/mman.h>
+}
+# endif
+#endif
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+#if defined(BOOST_COROUTINES_HIBERNATE)
+BOOST_COROUTINES_INLINE
+void discard_pages( char * first, char * last)
+{
+    if ( last <= first) return;
+# if defined(BOOST_WINDOWS)
+    ::VirtualAlloc( first, last - first, MEM_RESET, PAGE_READWRITE);
+# else
+    ::madvise( first, last - first, MADV_DONTNEED);
+# endif
+}
+#endif
+
+BOOST_COROUTINES_INLINE bool
+coroutine_stack_context::hibernate( void const* keep, std::size_t keep_size)
+{
+#if ! defined(BOOST_COROUTINES_HIBERNATE)
+    ( void) keep;
+    ( void) keep_size;
+    return false;
+#else
+    if ( 0 != stack_record_() ) return is_hibernated();
+
+    // the page holding the control block of the coroutine stays in place
+    const boost::uintptr_t page = stack_traits::page_size();
+    const boost::uintptr_t limit =
+        reinterpret_cast< boost::uintptr_t >( sctx_.sp) - sctx_.size;
+    char * first = reinterpret_cast< char * >( ( limit + page - 1) & ~( page - 1) );
+    char * last = reinterpret_cast< char * >(
+        reinterpret_cast< boost::uintptr_t >( sp_) & ~( page - 1) );
+    if ( last <= first) return false;
+
+    char * sp = static_cast< char * >( ctx_);
+    BOOST_ASSERT( first <= sp);
+    // pages left in place, [kept_first, kept_last) within [first, last)
+    char * kept_first = last, * kept_last = last;
+    if ( 0 != keep)
+    {
+        const boost::uintptr_t k = reinterpret_cast< boost::uintptr_t >( keep);
+        kept_first = reinterpret_cast< char * >( k & ~( page - 1) );
+        kept_last = reinterpret_cast< char * >( ( k + keep_size + page - 1) & ~( page - 1) );
+        if ( kept_first < first) kept_first = first;
+        if ( last < kept_last) kept_last = last;
+        if ( kept_last <= kept_first || kept_last <= sp) kept_first = kept_last = last;
+    }
+    // live bytes left in place
+    char * live_first = kept_first < sp ? sp : kept_first;
+
+    shared_stack_record * r = new shared_stack_record( 0);
+    r->sp = sp;
+    r->kept = live_first;
+    r->kept_size = kept_last - live_first;
+    if ( sp < last) r->size = last - sp - r->kept_size;
+    if ( 0 != r->size)
+    {
+        r->buffer = static_cast< char * >( std::malloc( r->size) );
+        if ( 0 == r->buffer)
+        {
+            delete r;
+            throw std::bad_alloc();
+        }
+        r->capacity = r->size;
+        std::memcpy( r->buffer, sp, live_first - sp);
+        std::memcpy( r->buffer + ( live_first - sp), kept_last, last - kept_last);
+    }
+    discard_pages( first, kept_first);
+    discard_pages( kept_last, last);
+    // keeps the tag of the function the context has been suspended by
+    record_ = tagged_( r, tags_() );
+    return true;
+#endif
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#undef BOOST_COROUTINES_HIBERNATE
+
+#endif // BOOST_COROUTINES_DETAIL_IMPL_HIBERNATE_IPP
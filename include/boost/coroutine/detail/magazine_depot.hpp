@@ -0,0 +1,170 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_MAGAZINE_DEPOT_H
+#define BOOST_COROUTINES_DETAIL_MAGAZINE_DEPOT_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// a magazine holds up to `capacity` stacks of one size class
+struct magazine
+{
+    enum { capacity = 16 };
+
+    std::atomic< std::uint32_t >    next;
+    std::uint32_t                   index;
+    std::size_t                     rounds;
+    stack_context                   stacks[capacity];
+
+    explicit magazine( std::uint32_t index_) BOOST_NOEXCEPT :
+        next( 0),
+        index( index_),
+        rounds( 0),
+        stacks()
+    {}
+
+    bool empty() const BOOST_NOEXCEPT
+    { return 0 == rounds; }
+
+    bool full() const BOOST_NOEXCEPT
+    { return capacity == rounds; }
+
+    void push( stack_context const& ctx) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( ! full() );
+        stacks[rounds++] = ctx;
+    }
+
+    stack_context pop() BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( ! empty() );
+        return stacks[--rounds];
+    }
+};
+
+// process-wide store of magazines: one list of (partially) filled magazines
+// per size class and one list of empty magazines
+// the lists are lock-free stacks; magazines are addressed by their index
+// into `table_`, the head carries a tag in its upper half (ABA)
+// magazines are never freed, the depot has a trivial destructor so that
+// it outlives the thread caches returning their magazines at thread exit
+class magazine_depot
+{
+public:
+    enum
+    {
+        size_classes = sizeof( std::size_t) * 8,
+        max_magazines = 4096
+    };
+
+private:
+    std::atomic< std::uint64_t >    full_[size_classes];
+    std::atomic< std::uint64_t >    empty_;
+    std::atomic< std::uint32_t >    count_;
+    std::atomic< magazine * >       table_[max_magazines];
+
+    void push_( std::atomic< std::uint64_t > & head, magazine * m) BOOST_NOEXCEPT
+    {
+        std::uint64_t old_head = head.load( std::memory_order_relaxed);
+        std::uint64_t new_head;
+        do
+        {
+            m->next.store( static_cast< std::uint32_t >( old_head), std::memory_order_relaxed);
+            new_head = ( ( ( old_head >> 32) + 1) << 32) | ( m->index + 1);
+        }
+        while ( ! head.compare_exchange_weak(
+                    old_head, new_head,
+                    std::memory_order_release, std::memory_order_relaxed) );
+    }
+
+    magazine * pop_( std::atomic< std::uint64_t > & head) BOOST_NOEXCEPT
+    {
+        std::uint64_t old_head = head.load( std::memory_order_acquire);
+        magazine * m = 0;
+        std::uint64_t new_head;
+        do
+        {
+            const std::uint32_t idx = static_cast< std::uint32_t >( old_head);
+            if ( 0 == idx) return 0;
+            m = table_[idx - 1].load( std::memory_order_acquire);
+            new_head = ( ( ( old_head >> 32) + 1) << 32) |
+                m->next.load( std::memory_order_relaxed);
+        }
+        while ( ! head.compare_exchange_weak(
+                    old_head, new_head,
+                    std::memory_order_acquire, std::memory_order_acquire) );
+        return m;
+    }
+
+public:
+    magazine_depot() BOOST_NOEXCEPT :
+        empty_( 0),
+        count_( 0)
+    {
+        for ( std::size_t i = 0; i < size_classes; ++i)
+            full_[i].store( 0, std::memory_order_relaxed);
+    }
+
+    void push_full( std::size_t size_class, magazine * m) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( size_class < size_classes);
+        BOOST_ASSERT( ! m->empty() );
+        push_( full_[size_class], m);
+    }
+
+    magazine * pop_full( std::size_t size_class) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( size_class < size_classes);
+        return pop_( full_[size_class]);
+    }
+
+    void push_empty( magazine * m) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( m->empty() );
+        push_( empty_, m);
+    }
+
+    // returns an empty magazine, a new one is constructed if the
+    // list of empty magazines is exhausted
+    // returns null if `max_magazines` have been constructed
+    magazine * pop_empty() BOOST_NOEXCEPT
+    {
+        magazine * m = pop_( empty_);
+        if ( 0 != m) return m;
+        if ( max_magazines <= count_.load( std::memory_order_relaxed) ) return 0;
+        const std::uint32_t idx = count_.fetch_add( 1, std::memory_order_relaxed);
+        if ( max_magazines <= idx) return 0;
+        m = new ( std::nothrow) magazine( idx);
+        // a slot which could not be filled is never published
+        if ( 0 != m) table_[idx].store( m, std::memory_order_release);
+        return m;
+    }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_MAGAZINE_DEPOT_H
@@ -9,6 +9,8 @@
 
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
+#include <boost/type_traits/has_trivial_copy.hpp>
+#include <boost/type_traits/has_trivial_destructor.hpp>
 
 #include <boost/coroutine/detail/flags.hpp>
 
@@ -20,6 +22,19 @@ namespace boost {
 namespace coroutines {
 namespace detail {
 
+// values of trivially copyable types not larger than a pointer are passed
+// in the data word of a context switch instead of a pointer to them
+// (push_coroutine_impl::push() of a synthesized push-coroutine to
+// pull_coroutine_impl::pull())
+template< typename T >
+struct pass_by_value
+{
+    BOOST_STATIC_CONSTANT( bool, value =
+        sizeof( T) <= sizeof( void *) &&
+        has_trivial_copy< T >::value &&
+        has_trivial_destructor< T >::value);
+};
+
 template< typename Data >
 struct parameters
 {
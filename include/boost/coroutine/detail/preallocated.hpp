@@ -22,20 +22,44 @@ namespace boost {
 namespace coroutines {
 namespace detail {
 
+struct shared_stack_record;
+
 struct BOOST_COROUTINES_DECL preallocated {
     void        *   sp;
     std::size_t     size;
     stack_context   sctx;
+    // set for coroutines running on a shared stack
+    shared_stack_record *   shared;
 
     preallocated() BOOST_NOEXCEPT :
-        sp( 0), size( 0), sctx() {
+        sp( 0), size( 0), sctx(), shared( 0) {
     }
 
     preallocated( void * sp_, std::size_t size_, stack_context sctx_) BOOST_NOEXCEPT :
-        sp( sp_), size( size_), sctx( sctx_) {
+        sp( sp_), size( size_), sctx( sctx_), shared( 0) {
     }
 };
 
+// stack allocators running their coroutines on a shared stack specialise
+// `shared_stack_of` to find the record of a coroutine from its stack_context
+template< typename StackAllocator >
+struct shared_stack_of
+{
+    static const bool value = false;
+
+    static shared_stack_record * record( stack_context const&) BOOST_NOEXCEPT
+    { return 0; }
+};
+
+// `palloc` with the record of the coroutine if `StackAllocator` hands out
+// a shared stack
+template< typename StackAllocator >
+preallocated with_shared_stack( preallocated palloc) BOOST_NOEXCEPT
+{
+    palloc.shared = shared_stack_of< StackAllocator >::record( palloc.sctx);
+    return palloc;
+}
+
 }}}
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -0,0 +1,73 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_PREFAULT_STACK_H
+#define BOOST_COROUTINES_DETAIL_PREFAULT_STACK_H
+
+#include <cstddef>
+
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+
+#if defined(__linux__)
+extern "C" {
+#include <sys/mman.h>
+}
+#endif
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/stack_context.hpp>
+#include <boost/coroutine/stack_traits.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// faults in the pages of the top `size` bytes of a stack, the lowest page
+// is skipped (might be a guard page); the content of the stack is preserved
+// pages already resident are touched without a fault, e.g. stacks recycled
+// by a pool stay warm
+inline
+void prefault_stack( stack_context const& ctx, std::size_t size) BOOST_NOEXCEPT
+{
+    const std::size_t page = stack_traits::page_size();
+    if ( 0 == ctx.sp || 0 == size || ctx.size <= page) return;
+    const boost::uintptr_t top = reinterpret_cast< boost::uintptr_t >( ctx.sp);
+    boost::uintptr_t limit = top - ctx.size + page;
+    if ( size < top - limit) limit = top - size;
+#if defined(MADV_POPULATE_WRITE)
+    // one system call instead of a page fault per page (Linux 5.14), used
+    // for larger ranges if the lowest page is not resident (stacks recycled
+    // by a pool are resident)
+    const boost::uintptr_t first = ( limit + page - 1) & ~( page - 1);
+    const boost::uintptr_t last = top & ~( page - 1);
+    unsigned char resident = 0;
+    if ( first + 4 * page <= last &&
+         0 == ::mincore( reinterpret_cast< void * >( first), page, & resident) &&
+         0 == ( resident & 1) )
+        ::madvise( reinterpret_cast< void * >( first), last - first, MADV_POPULATE_WRITE);
+#endif
+    for ( boost::uintptr_t p = top - 1; ; p -= page)
+    {
+        volatile char * c = reinterpret_cast< volatile char * >( p);
+        * c = * c;
+        if ( p < limit + page) break;
+    }
+    volatile char * c = reinterpret_cast< volatile char * >( limit);
+    * c = * c;
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_PREFAULT_STACK_H
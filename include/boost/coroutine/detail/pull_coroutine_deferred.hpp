@@ -0,0 +1,109 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_PULL_COROUTINE_DEFERRED_H
+#define BOOST_COROUTINES_DETAIL_PULL_COROUTINE_DEFERRED_H
+
+#include <cstddef>
+#include <new>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/move/move.hpp>
+
+#include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/detail/allocate_stack.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/control_block.hpp>
+#include <boost/coroutine/detail/flags.hpp>
+#include <boost/coroutine/detail/preallocated.hpp>
+#include <boost/coroutine/detail/pull_coroutine_impl.hpp>
+#include <boost/coroutine/detail/pull_coroutine_object.hpp>
+#include <boost/coroutine/flags.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// a pull-coroutine created with start_lazy: holds the coroutine-function,
+// the attributes and the stack allocator (heap allocated) until the
+// coroutine is used; start() allocates the stack and creates the
+// pull_coroutine_object on it
+template< typename PushCoro, typename R, typename Fn, typename StackAllocator >
+class pull_coroutine_deferred : public pull_coroutine_impl< R >
+{
+private:
+    typedef pull_coroutine_impl< R >                                    base_t;
+    typedef pull_coroutine_object< PushCoro, R, Fn, StackAllocator >    object_t;
+
+    Fn                  fn_;
+    attributes          attrs_;
+    StackAllocator      stack_alloc_;
+
+public:
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+    pull_coroutine_deferred( Fn fn, attributes const& attrs,
+                             StackAllocator const& stack_alloc) :
+        base_t( 0, 0, stack_unwind == attrs.do_unwind),
+        fn_( fn),
+        attrs_( attrs),
+        stack_alloc_( stack_alloc)
+    { this->flags_ |= flag_deferred; }
+#endif
+
+    pull_coroutine_deferred( BOOST_RV_REF( Fn) fn, attributes const& attrs,
+                             StackAllocator const& stack_alloc) :
+        base_t( 0, 0, stack_unwind == attrs.do_unwind),
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+        fn_( fn),
+#else
+        fn_( boost::forward< Fn >( fn) ),
+#endif
+        attrs_( attrs),
+        stack_alloc_( stack_alloc)
+    { this->flags_ |= flag_deferred; }
+
+    base_t * start()
+    {
+        // create a stack-context
+        stack_context stack_ctx;
+        // allocate the coroutine-stack
+        allocate_stack( stack_alloc_, stack_ctx, attrs_, kind_of( fn_) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        // reserve space on top of coroutine-stack for internal coroutine-type
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != size);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
+        BOOST_ASSERT( 0 != sp);
+        // placement new for internal coroutine
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+        return new ( sp) object_t(
+                boost::move( fn_), attrs_, preallocated( sp, size, stack_ctx), stack_alloc_);
+#else
+        return new ( sp) object_t(
+                boost::forward< Fn >( fn_), attrs_, preallocated( sp, size, stack_ctx), stack_alloc_);
+#endif
+    }
+
+    void destroy()
+    { delete this; }
+
+    bool recycle( stack_context &, void *, std::size_t)
+    { return false; }
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_PULL_COROUTINE_DEFERRED_H
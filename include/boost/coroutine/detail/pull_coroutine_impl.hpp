@@ -7,9 +7,15 @@
 #ifndef BOOST_COROUTINES_DETAIL_PULL_COROUTINE_IMPL_H
 #define BOOST_COROUTINES_DETAIL_PULL_COROUTINE_IMPL_H
 
+#include <cstddef>
+#include <cstring>
+
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
 #include <boost/exception_ptr.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/move/move.hpp>
+#include <boost/mpl/if.hpp>
 #include <boost/throw_exception.hpp>
 #include <boost/utility.hpp>
 
@@ -17,6 +23,7 @@
 #include <boost/coroutine/detail/coroutine_context.hpp>
 #include <boost/coroutine/detail/flags.hpp>
 #include <boost/coroutine/detail/parameters.hpp>
+#include <boost/coroutine/detail/stored_exception.hpp>
 #include <boost/coroutine/detail/trampoline_pull.hpp>
 #include <boost/coroutine/exceptions.hpp>
 
@@ -34,42 +41,124 @@ namespace detail {
 template< typename R >
 class pull_coroutine_impl : private noncopyable
 {
+private:
+    typedef mpl::bool_< pass_by_value< R >::value >   by_value_t;
+
 protected:
+    // read only after the coroutine has completed
+    exception_ptr       *   except_;
+    // remaining values of a batch pushed by push_batch(), accessed only
+    // while flag_batch is set
+    R                   *   batch_;
+    R                   *   batch_end_;
+    // accessed by each context switch (see control_block.hpp)
     int                     flags_;
-    exception_ptr           except_;
     coroutine_context   *   caller_;
     coroutine_context   *   callee_;
-    R                   *   result_;
+    // the value if passed by value (valid if flag_has_value is set),
+    // otherwise a pointer to the value on the stack of the coroutine
+    typename mpl::if_< by_value_t, R, R * >::type   result_;
+
+private:
+    void set_result_( R * result, mpl::false_) BOOST_NOEXCEPT
+    { result_ = result; }
+
+    void set_result_( R * result, mpl::true_) BOOST_NOEXCEPT
+    {
+        if ( 0 != result)
+        {
+            result_ = * callee_->saved( result);
+            flags_ |= flag_has_value;
+        }
+        else
+            flags_ &= ~flag_has_value;
+    }
+
+    // the stack of the coroutine might be saved by a shared stack
+    R * result_ptr_( mpl::false_) const BOOST_NOEXCEPT
+    { return callee_->saved( result_); }
+
+    R * result_ptr_( mpl::true_) const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_has_value) ? const_cast< R * >( & result_) : 0; }
+
+    void const* stack_result_( mpl::false_) const BOOST_NOEXCEPT
+    { return result_; }
+
+    // the value is copied into the control block
+    void const* stack_result_( mpl::true_) const BOOST_NOEXCEPT
+    { return 0; }
+
+    // `data` received by pull() is a pointer to the parameters of the
+    // coroutine-function
+    void receive_( void * data, mpl::false_)
+    {
+        param_type * from( static_cast< param_type * >( data) );
+        result_ = from->data;
+        if ( from->do_unwind) throw forced_unwind();
+    }
+
+    void receive_( void * data, mpl::true_)
+    {
+        if ( 0 == ( flags_ & flag_by_value) )
+        {
+            param_type * from( static_cast< param_type * >( data) );
+            set_result_( from->data, mpl::true_() );
+            if ( from->do_unwind) throw forced_unwind();
+        }
+        // the data word carries the value, a completed coroutine passes
+        // no value
+        else if ( ! is_complete() )
+        {
+            std::memcpy( & result_, & data, sizeof( R) );
+            flags_ |= flag_has_value;
+        }
+        else
+            flags_ &= ~flag_has_value;
+    }
 
 public:
+    // offset of the members accessed by each context switch
+    static const std::size_t hot_offset = 4 * sizeof( void *);
+
     typedef parameters< R >                           param_type;
 
+    // used by pull-coroutines created by the user, the values are pushed
+    // by a synthesized push-coroutine
     pull_coroutine_impl( coroutine_context * caller,
                          coroutine_context * callee,
                          bool unwind) :
+        except_( 0),
+        batch_( 0),
+        batch_end_( 0),
         flags_( 0),
-        except_(),
         caller_( caller),
         callee_( callee),
-        result_( 0)
+        result_()
     {
         if ( unwind) flags_ |= flag_force_unwind;
+        if ( by_value_t::value) flags_ |= flag_by_value;
     }
 
+    // used by synthesized pull-coroutines, the values are pushed by a
+    // push-coroutine created by the user
     pull_coroutine_impl( coroutine_context * caller,
                          coroutine_context * callee,
                          bool unwind,
                          R * result) :
+        except_( 0),
+        batch_( 0),
+        batch_end_( 0),
         flags_( 0),
-        except_(),
         caller_( caller),
         callee_( callee),
-        result_( result)
+        result_()
     {
         if ( unwind) flags_ |= flag_force_unwind;
+        set_result_( result, by_value_t() );
     }
 
-    virtual ~pull_coroutine_impl() {}
+    virtual ~pull_coroutine_impl()
+    { release_exception( except_); }
 
     bool force_unwind() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_force_unwind); }
@@ -83,9 +172,38 @@ public:
     bool is_running() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_running); }
 
+    // execution-context and stack of the coroutine-function, null if the
+    // coroutine was passed to the coroutine-function
+    virtual coroutine_stack_context * callee_stack_() BOOST_NOEXCEPT
+    { return 0; }
+
+    stack_context const& stack_ctx() BOOST_NOEXCEPT
+    {
+        static const stack_context empty;
+        coroutine_stack_context * ctx = callee_stack_();
+        return 0 != ctx ? ctx->stack_ctx() : empty;
+    }
+
+    bool hibernate()
+    {
+        BOOST_ASSERT( ! is_running() );
+        coroutine_stack_context * ctx = callee_stack_();
+        // the result might live on the stack of the coroutine, as well as
+        // the values of a batch
+        return 0 != ctx && ! is_complete() && ! has_batch() &&
+            ctx->hibernate( stack_result_( by_value_t() ), sizeof( R) );
+    }
+
+    bool is_hibernated() const BOOST_NOEXCEPT
+    { return callee_->is_hibernated(); }
+
     bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
+    // created with start_lazy and not used yet, no stack is allocated
+    bool is_deferred() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_deferred); }
+
     void unwind_stack() BOOST_NOEXCEPT
     {
         if ( is_started() && ! is_complete() && force_unwind() )
@@ -101,33 +219,72 @@ public:
         }
     }
 
+    bool has_batch() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_batch); }
+
+    // the values of [first, last) are the results of the next pulls, set
+    // by the coroutine pushing them before it passes the value preceding
+    // `first`; the range has to be kept alive until they are pulled
+    void set_batch( R * first, R * last) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( first != last);
+        batch_ = first;
+        batch_end_ = last;
+        flags_ |= flag_batch;
+    }
+
     void pull()
     {
         BOOST_ASSERT( ! is_running() );
         BOOST_ASSERT( ! is_complete() );
 
+        if ( has_batch() )
+        {
+            // no context switch
+            set_result_( batch_, by_value_t() );
+            if ( ++batch_ == batch_end_) flags_ &= ~flag_batch;
+            return;
+        }
+
         flags_ |= flag_running;
         param_type to( this);
-        param_type * from(
-            static_cast< param_type * >(
-                caller_->jump(
+        void * data = 0;
+        try
+        {
+            data = caller_->jump(
                     * callee_,
-                    & to) ) );
+                    & to);
+        }
+        catch (...)
+        {
+            // the coroutine has not been resumed (see
+            // coroutine_context::jump_record_())
+            flags_ &= ~flag_running;
+            throw;
+        }
         flags_ &= ~flag_running;
-        result_ = from->data;
-        if ( from->do_unwind) throw forced_unwind();
-        if ( except_) rethrow_exception( except_);
+        receive_( data, by_value_t() );
+        if ( is_complete() && except_) rethrow_exception( * except_);
     }
 
     bool has_result() const
-    { return 0 != result_; }
+    { return 0 != result_ptr_( by_value_t() ); }
 
     R get() const
     {
         if ( ! has_result() )
             boost::throw_exception(
                 invalid_result() );
-        return * result_;
+        return * result_ptr_( by_value_t() );
+    }
+
+    // the value is owned by the pushing side until the next pull()
+    R take()
+    {
+        if ( ! has_result() )
+            boost::throw_exception(
+                invalid_result() );
+        return boost::move( * result_ptr_( by_value_t() ) );
     }
 
     R * get_pointer() const
@@ -135,30 +292,48 @@ public:
         if ( ! has_result() )
             boost::throw_exception(
                 invalid_result() );
-        return result_;
+        return result_ptr_( by_value_t() );
     }
 
     virtual void destroy() = 0;
+
+    // destroys the coroutine but keeps its stack if it was allocated by a
+    // stack allocator of type `alloc_id`; the allocator is assigned to
+    // `stack_alloc`
+    virtual bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id) = 0;
+
+    // allocates the stack of a deferred coroutine and creates the coroutine
+    // on it; the deferred coroutine has to be destroyed by the caller
+    virtual pull_coroutine_impl * start()
+    {
+        BOOST_ASSERT_MSG( false, "coroutine is not deferred");
+        return this;
+    }
 };
 
 template< typename R >
 class pull_coroutine_impl< R & > : private noncopyable
 {
 protected:
+    // read only after the coroutine has completed
+    exception_ptr       *   except_;
+    // accessed by each context switch (see control_block.hpp)
     int                     flags_;
-    exception_ptr           except_;
     coroutine_context   *   caller_;
     coroutine_context   *   callee_;
     R                   *   result_;
 
 public:
+    // offset of the members accessed by each context switch
+    static const std::size_t hot_offset = 2 * sizeof( void *);
+
     typedef parameters< R & >                           param_type;
 
     pull_coroutine_impl( coroutine_context * caller,
                          coroutine_context * callee,
                          bool unwind) :
+        except_( 0),
         flags_( 0),
-        except_(),
         caller_( caller),
         callee_( callee),
         result_( 0)
@@ -170,8 +345,8 @@ public:
                          coroutine_context * callee,
                          bool unwind,
                          R * result) :
+        except_( 0),
         flags_( 0),
-        except_(),
         caller_( caller),
         callee_( callee),
         result_( result)
@@ -179,7 +354,8 @@ public:
         if ( unwind) flags_ |= flag_force_unwind;
     }
 
-    virtual ~pull_coroutine_impl() {}
+    virtual ~pull_coroutine_impl()
+    { release_exception( except_); }
 
     bool force_unwind() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_force_unwind); }
@@ -193,9 +369,36 @@ public:
     bool is_running() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_running); }
 
+    // execution-context and stack of the coroutine-function, null if the
+    // coroutine was passed to the coroutine-function
+    virtual coroutine_stack_context * callee_stack_() BOOST_NOEXCEPT
+    { return 0; }
+
+    stack_context const& stack_ctx() BOOST_NOEXCEPT
+    {
+        static const stack_context empty;
+        coroutine_stack_context * ctx = callee_stack_();
+        return 0 != ctx ? ctx->stack_ctx() : empty;
+    }
+
+    bool hibernate()
+    {
+        BOOST_ASSERT( ! is_running() );
+        coroutine_stack_context * ctx = callee_stack_();
+        // the result might live on the stack of the coroutine
+        return 0 != ctx && ! is_complete() && ctx->hibernate( result_, sizeof( R) );
+    }
+
+    bool is_hibernated() const BOOST_NOEXCEPT
+    { return callee_->is_hibernated(); }
+
     bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
+    // created with start_lazy and not used yet, no stack is allocated
+    bool is_deferred() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_deferred); }
+
     void unwind_stack() BOOST_NOEXCEPT
     {
         if ( is_started() && ! is_complete() && force_unwind() )
@@ -218,15 +421,25 @@ public:
 
         flags_ |= flag_running;
         param_type to( this);
-        param_type * from(
-            static_cast< param_type * >(
+        param_type * from = 0;
+        try
+        {
+            from = static_cast< param_type * >(
                 caller_->jump(
                     * callee_,
-                    & to) ) );
+                    & to) );
+        }
+        catch (...)
+        {
+            // the coroutine has not been resumed (see
+            // coroutine_context::jump_record_())
+            flags_ &= ~flag_running;
+            throw;
+        }
         flags_ &= ~flag_running;
         result_ = from->data;
         if ( from->do_unwind) throw forced_unwind();
-        if ( except_) rethrow_exception( except_);
+        if ( is_complete() && except_) rethrow_exception( * except_);
     }
 
     bool has_result() const
@@ -237,7 +450,7 @@ public:
         if ( ! has_result() )
             boost::throw_exception(
                 invalid_result() );
-        return * result_;
+        return * callee_->saved( result_);
     }
 
     R * get_pointer() const
@@ -245,36 +458,55 @@ public:
         if ( ! has_result() )
             boost::throw_exception(
                 invalid_result() );
-        return result_;
+        return callee_->saved( result_);
     }
 
     virtual void destroy() = 0;
+
+    // destroys the coroutine but keeps its stack if it was allocated by a
+    // stack allocator of type `alloc_id`; the allocator is assigned to
+    // `stack_alloc`
+    virtual bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id) = 0;
+
+    // allocates the stack of a deferred coroutine and creates the coroutine
+    // on it; the deferred coroutine has to be destroyed by the caller
+    virtual pull_coroutine_impl * start()
+    {
+        BOOST_ASSERT_MSG( false, "coroutine is not deferred");
+        return this;
+    }
 };
 
 template<>
 class pull_coroutine_impl< void > : private noncopyable
 {
 protected:
+    // read only after the coroutine has completed
+    exception_ptr       *   except_;
+    // accessed by each context switch (see control_block.hpp)
     int                     flags_;
-    exception_ptr           except_;
     coroutine_context   *   caller_;
     coroutine_context   *   callee_;
 
 public:
+    // offset of the members accessed by each context switch
+    static const std::size_t hot_offset = 2 * sizeof( void *);
+
     typedef parameters< void >      param_type;
 
     pull_coroutine_impl( coroutine_context * caller,
                          coroutine_context * callee,
                          bool unwind) :
+        except_( 0),
         flags_( 0),
-        except_(),
         caller_( caller),
         callee_( callee)
     {
         if ( unwind) flags_ |= flag_force_unwind;
     }
 
-    virtual ~pull_coroutine_impl() {}
+    virtual ~pull_coroutine_impl()
+    { release_exception( except_); }
 
     inline bool force_unwind() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_force_unwind); }
@@ -288,9 +520,35 @@ public:
     inline bool is_running() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_running); }
 
+    // execution-context and stack of the coroutine-function, null if the
+    // coroutine was passed to the coroutine-function
+    virtual coroutine_stack_context * callee_stack_() BOOST_NOEXCEPT
+    { return 0; }
+
+    inline stack_context const& stack_ctx() BOOST_NOEXCEPT
+    {
+        static const stack_context empty;
+        coroutine_stack_context * ctx = callee_stack_();
+        return 0 != ctx ? ctx->stack_ctx() : empty;
+    }
+
+    inline bool hibernate()
+    {
+        BOOST_ASSERT( ! is_running() );
+        coroutine_stack_context * ctx = callee_stack_();
+        return 0 != ctx && ! is_complete() && ctx->hibernate();
+    }
+
+    inline bool is_hibernated() const BOOST_NOEXCEPT
+    { return callee_->is_hibernated(); }
+
     inline bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
+    // created with start_lazy and not used yet, no stack is allocated
+    inline bool is_deferred() const BOOST_NOEXCEPT
+    { return 0 != ( flags_ & flag_deferred); }
+
     inline void unwind_stack() BOOST_NOEXCEPT
     {
         if ( is_started() && ! is_complete() && force_unwind() )
@@ -313,17 +571,40 @@ public:
 
         flags_ |= flag_running;
         param_type to( this);
-        param_type * from(
-            static_cast< param_type * >(
+        param_type * from = 0;
+        try
+        {
+            from = static_cast< param_type * >(
                 caller_->jump(
                     * callee_,
-                    & to) ) );
+                    & to) );
+        }
+        catch (...)
+        {
+            // the coroutine has not been resumed (see
+            // coroutine_context::jump_record_())
+            flags_ &= ~flag_running;
+            throw;
+        }
         flags_ &= ~flag_running;
         if ( from->do_unwind) throw forced_unwind();
-        if ( except_) rethrow_exception( except_);
+        if ( is_complete() && except_) rethrow_exception( * except_);
     }
 
     virtual void destroy() = 0;
+
+    // destroys the coroutine but keeps its stack if it was allocated by a
+    // stack allocator of type `alloc_id`; the allocator is assigned to
+    // `stack_alloc`
+    virtual bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id) = 0;
+
+    // allocates the stack of a deferred coroutine and creates the coroutine
+    // on it; the deferred coroutine has to be destroyed by the caller
+    virtual pull_coroutine_impl * start()
+    {
+        BOOST_ASSERT_MSG( false, "coroutine is not deferred");
+        return this;
+    }
 };
 
 }}}
@@ -13,12 +13,16 @@
 #include <boost/cstdint.hpp>
 #include <boost/exception_ptr.hpp>
 #include <boost/move/move.hpp>
+#include <boost/static_assert.hpp>
 
+#include <boost/coroutine/detail/allocate_stack.hpp>
 #include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/control_block.hpp>
 #include <boost/coroutine/detail/coroutine_context.hpp>
 #include <boost/coroutine/detail/flags.hpp>
 #include <boost/coroutine/detail/preallocated.hpp>
 #include <boost/coroutine/detail/pull_coroutine_impl.hpp>
+#include <boost/coroutine/detail/stack_capacity.hpp>
 #include <boost/coroutine/detail/trampoline_pull.hpp>
 #include <boost/coroutine/exceptions.hpp>
 #include <boost/coroutine/flags.hpp>
@@ -39,13 +43,13 @@ namespace detail {
 
 struct pull_coroutine_context
 {
-    coroutine_context   caller;
-    coroutine_context   callee;
+    coroutine_context       caller;
+    coroutine_stack_context callee;
 
     template< typename Coro >
-    pull_coroutine_context( preallocated const& palloc, Coro *) :
+    pull_coroutine_context( preallocated const& palloc, flag_fpu_t preserve_fpu, Coro *) :
         caller(),
-        callee( trampoline_pull< Coro >, palloc)
+        callee( trampoline_pull< Coro >, palloc, preserve_fpu)
     {}
 };
 
@@ -58,13 +62,20 @@ private:
     typedef pull_coroutine_impl< R >                                    base_t;
     typedef pull_coroutine_object< PushCoro, R, Fn, StackAllocator >    obj_t;
 
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+    // base_t is the primary base, the execution-contexts follow its members;
+    // the members accessed by a context switch fit into one cache line
+    BOOST_STATIC_ASSERT( sizeof( base_t) - base_t::hot_offset + 2 * sizeof( coroutine_context)
+                         <= BOOST_COROUTINES_CACHELINE_SIZE);
+#endif
+
     Fn                  fn_;
-    stack_context       stack_ctx_;
     StackAllocator      stack_alloc_;
 
     static void deallocate_( obj_t * obj)
     {
-        stack_context stack_ctx( obj->stack_ctx_);
+        check_stack_capacity< obj_t, StackAllocator >();
+        stack_context stack_ctx( obj->callee.stack_ctx() );
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
         obj->~obj_t();
@@ -76,20 +87,22 @@ public:
     pull_coroutine_object( Fn fn, attributes const& attrs,
                            preallocated const& palloc,
                            StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        ctx_t( palloc, this),
+        ctx_t( with_shared_stack< StackAllocator >( palloc), attrs.preserve_fpu, this),
         base_t( & this->caller,
                 & this->callee,
                 stack_unwind == attrs.do_unwind),
         fn_( fn),
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
-    {}
+    {
+        BOOST_ASSERT( shared_stack_of< StackAllocator >::value ||
+            one_cache_line( & this->flags_, static_cast< coroutine_context * >( & this->callee) + 1) );
+    }
 #endif
 
     pull_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
                            preallocated const& palloc,
                            StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        ctx_t( palloc, this),
+        ctx_t( with_shared_stack< StackAllocator >( palloc), attrs.preserve_fpu, this),
         base_t( & this->caller,
                 & this->callee,
                 stack_unwind == attrs.do_unwind),
@@ -98,9 +111,11 @@ public:
 #else
         fn_( boost::forward< Fn >( fn) ),
 #endif
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
-    {}
+    {
+        BOOST_ASSERT( shared_stack_of< StackAllocator >::value ||
+            one_cache_line( & this->flags_, static_cast< coroutine_context * >( & this->callee) + 1) );
+    }
 
     void run()
     {
@@ -110,7 +125,7 @@ public:
         base_t::flags_ |= flag_running;
 
         // create push_coroutine
-        typename PushCoro::synth_type b( & this->callee, & this->caller, false);
+        typename PushCoro::synth_type b( & this->callee, & this->caller, false, this);
         PushCoro push_coro( synthesized_t::syntesized, b);
         try
         { fn_( push_coro); }
@@ -121,7 +136,7 @@ public:
         { throw; }
 #endif
         catch (...)
-        { base_t::except_ = current_exception(); }
+        { base_t::except_ = store_current_exception(); }
 
         base_t::flags_ |= flag_complete;
         base_t::flags_ &= ~flag_running;
@@ -134,6 +149,21 @@ public:
 
     void destroy()
     { deallocate_( this); }
+
+    coroutine_stack_context * callee_stack_() BOOST_NOEXCEPT
+    { return & this->callee; }
+
+    bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id)
+    {
+        // a shared stack is not owned by the coroutine
+        if ( allocator_id< StackAllocator >() != alloc_id || shared_stack_of< StackAllocator >::value)
+            return false;
+        sctx = this->callee.stack_ctx();
+        * static_cast< StackAllocator * >( stack_alloc) = stack_alloc_;
+        this->unwind_stack();
+        this->~obj_t();
+        return true;
+    }
 };
 
 template< typename PushCoro, typename R, typename Fn, typename StackAllocator >
@@ -145,13 +175,20 @@ private:
     typedef pull_coroutine_impl< R & >                                  base_t;
     typedef pull_coroutine_object< PushCoro, R &, Fn, StackAllocator >  obj_t;
 
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+    // base_t is the primary base, the execution-contexts follow its members;
+    // the members accessed by a context switch fit into one cache line
+    BOOST_STATIC_ASSERT( sizeof( base_t) - base_t::hot_offset + 2 * sizeof( coroutine_context)
+                         <= BOOST_COROUTINES_CACHELINE_SIZE);
+#endif
+
     Fn                  fn_;
-    stack_context       stack_ctx_;
     StackAllocator      stack_alloc_;
 
     static void deallocate_( obj_t * obj)
     {
-        stack_context stack_ctx( obj->stack_ctx_);
+        check_stack_capacity< obj_t, StackAllocator >();
+        stack_context stack_ctx( obj->callee.stack_ctx() );
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
         obj->~obj_t();
@@ -163,20 +200,22 @@ public:
     pull_coroutine_object( Fn fn, attributes const& attrs,
                            preallocated const& palloc,
                            StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        ctx_t( palloc, this),
+        ctx_t( with_shared_stack< StackAllocator >( palloc), attrs.preserve_fpu, this),
         base_t( & this->caller,
                 & this->callee,
                 stack_unwind == attrs.do_unwind),
         fn_( fn),
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
-    {}
+    {
+        BOOST_ASSERT( shared_stack_of< StackAllocator >::value ||
+            one_cache_line( & this->flags_, static_cast< coroutine_context * >( & this->callee) + 1) );
+    }
 #endif
 
     pull_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
                            preallocated const& palloc,
                            StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        ctx_t( palloc, this),
+        ctx_t( with_shared_stack< StackAllocator >( palloc), attrs.preserve_fpu, this),
         base_t( & this->caller,
                 & this->callee,
                 stack_unwind == attrs.do_unwind),
@@ -185,9 +224,11 @@ public:
 #else
         fn_( boost::forward< Fn >( fn) ),
 #endif
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
-    {}
+    {
+        BOOST_ASSERT( shared_stack_of< StackAllocator >::value ||
+            one_cache_line( & this->flags_, static_cast< coroutine_context * >( & this->callee) + 1) );
+    }
 
     void run()
     {
@@ -208,7 +249,7 @@ public:
         { throw; }
 #endif
         catch (...)
-        { base_t::except_ = current_exception(); }
+        { base_t::except_ = store_current_exception(); }
 
         base_t::flags_ |= flag_complete;
         base_t::flags_ &= ~flag_running;
@@ -221,6 +262,21 @@ public:
 
     void destroy()
     { deallocate_( this); }
+
+    coroutine_stack_context * callee_stack_() BOOST_NOEXCEPT
+    { return & this->callee; }
+
+    bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id)
+    {
+        // a shared stack is not owned by the coroutine
+        if ( allocator_id< StackAllocator >() != alloc_id || shared_stack_of< StackAllocator >::value)
+            return false;
+        sctx = this->callee.stack_ctx();
+        * static_cast< StackAllocator * >( stack_alloc) = stack_alloc_;
+        this->unwind_stack();
+        this->~obj_t();
+        return true;
+    }
 };
 
 template< typename PushCoro, typename Fn, typename StackAllocator >
@@ -232,13 +288,20 @@ private:
     typedef pull_coroutine_impl< void >                                 base_t;
     typedef pull_coroutine_object< PushCoro, void, Fn, StackAllocator > obj_t;
 
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+    // base_t is the primary base, the execution-contexts follow its members;
+    // the members accessed by a context switch fit into one cache line
+    BOOST_STATIC_ASSERT( sizeof( base_t) - base_t::hot_offset + 2 * sizeof( coroutine_context)
+                         <= BOOST_COROUTINES_CACHELINE_SIZE);
+#endif
+
     Fn                  fn_;
-    stack_context       stack_ctx_;
     StackAllocator      stack_alloc_;
 
     static void deallocate_( obj_t * obj)
     {
-        stack_context stack_ctx( obj->stack_ctx_);
+        check_stack_capacity< obj_t, StackAllocator >();
+        stack_context stack_ctx( obj->callee.stack_ctx() );
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
         obj->~obj_t();
@@ -250,20 +313,22 @@ public:
     pull_coroutine_object( Fn fn, attributes const& attrs,
                            preallocated const& palloc,
                            StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        ctx_t( palloc, this),
+        ctx_t( with_shared_stack< StackAllocator >( palloc), attrs.preserve_fpu, this),
         base_t( & this->caller,
                 & this->callee,
                 stack_unwind == attrs.do_unwind),
         fn_( fn),
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
-    {}
+    {
+        BOOST_ASSERT( shared_stack_of< StackAllocator >::value ||
+            one_cache_line( & this->flags_, static_cast< coroutine_context * >( & this->callee) + 1) );
+    }
 #endif
 
     pull_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
                            preallocated const& palloc,
                            StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        ctx_t( palloc, this),
+        ctx_t( with_shared_stack< StackAllocator >( palloc), attrs.preserve_fpu, this),
         base_t( & this->caller,
                 & this->callee,
                 stack_unwind == attrs.do_unwind),
@@ -272,9 +337,11 @@ public:
 #else
         fn_( boost::forward< Fn >( fn) ),
 #endif
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
-    {}
+    {
+        BOOST_ASSERT( shared_stack_of< StackAllocator >::value ||
+            one_cache_line( & this->flags_, static_cast< coroutine_context * >( & this->callee) + 1) );
+    }
 
     void run()
     {
@@ -295,7 +362,7 @@ public:
         { throw; }
 #endif
         catch (...)
-        { base_t::except_ = current_exception(); }
+        { base_t::except_ = store_current_exception(); }
 
         base_t::flags_ |= flag_complete;
         base_t::flags_ &= ~flag_running;
@@ -308,6 +375,21 @@ public:
 
     void destroy()
     { deallocate_( this); }
+
+    coroutine_stack_context * callee_stack_() BOOST_NOEXCEPT
+    { return & this->callee; }
+
+    bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id)
+    {
+        // a shared stack is not owned by the coroutine
+        if ( allocator_id< StackAllocator >() != alloc_id || shared_stack_of< StackAllocator >::value)
+            return false;
+        sctx = this->callee.stack_ctx();
+        * static_cast< StackAllocator * >( stack_alloc) = stack_alloc_;
+        this->unwind_stack();
+        this->~obj_t();
+        return true;
+    }
 };
 
 }}}
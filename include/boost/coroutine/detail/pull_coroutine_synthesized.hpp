@@ -7,6 +7,9 @@
 #ifndef BOOST_COROUTINES_DETAIL_PULL_COROUTINE_SYNTHESIZED_H
 #define BOOST_COROUTINES_DETAIL_PULL_COROUTINE_SYNTHESIZED_H
 
+#include <cstddef>
+
+#include <boost/assert.hpp>
 #include <boost/config.hpp>
 
 #include <boost/coroutine/detail/config.hpp>
@@ -36,6 +39,12 @@ public:
     {}
 
     void destroy() {}
+
+    bool recycle( stack_context &, void *, std::size_t)
+    {
+        BOOST_ASSERT_MSG( false, "coroutine passed to the coroutine-function can not be reset");
+        return false;
+    }
 };
 
 template< typename R >
@@ -53,6 +62,12 @@ public:
     {}
 
     void destroy() {}
+
+    bool recycle( stack_context &, void *, std::size_t)
+    {
+        BOOST_ASSERT_MSG( false, "coroutine passed to the coroutine-function can not be reset");
+        return false;
+    }
 };
 
 template<>
@@ -69,6 +84,12 @@ public:
     {}
 
     inline void destroy() {}
+
+    inline bool recycle( stack_context &, void *, std::size_t)
+    {
+        BOOST_ASSERT_MSG( false, "coroutine passed to the coroutine-function can not be reset");
+        return false;
+    }
 };
 
 }}}
@@ -7,9 +7,13 @@
 #ifndef BOOST_COROUTINES_DETAIL_PUSH_COROUTINE_IMPL_H
 #define BOOST_COROUTINES_DETAIL_PUSH_COROUTINE_IMPL_H
 
+#include <cstddef>
+#include <cstring>
+
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
 #include <boost/exception_ptr.hpp>
+#include <boost/mpl/bool.hpp>
 #include <boost/throw_exception.hpp>
 #include <boost/utility.hpp>
 
@@ -17,6 +21,7 @@
 #include <boost/coroutine/detail/coroutine_context.hpp>
 #include <boost/coroutine/detail/flags.hpp>
 #include <boost/coroutine/detail/parameters.hpp>
+#include <boost/coroutine/detail/stored_exception.hpp>
 #include <boost/coroutine/detail/trampoline_push.hpp>
 #include <boost/coroutine/exceptions.hpp>
 
@@ -31,30 +36,56 @@ struct stack_context;
 
 namespace detail {
 
+template< typename R >
+class pull_coroutine_impl;
+
 template< typename Arg >
 class push_coroutine_impl : private noncopyable
 {
 protected:
+    // read only after the coroutine has completed
+    exception_ptr       *   except_;
+    // accessed by each context switch (see control_block.hpp)
     int                     flags_;
-    exception_ptr           except_;
     coroutine_context   *   caller_;
     coroutine_context   *   callee_;
+    // pull-coroutine receiving the values, null until the coroutine has
+    // been started (push-coroutine created by the user)
+    pull_coroutine_impl< Arg >  *   receiver_;
+
+private:
+    void * send_( void * to, Arg const&, mpl::false_) const BOOST_NOEXCEPT
+    { return to; }
+
+    // a synthesized push-coroutine passes the value in the data word
+    void * send_( void * to, Arg const& arg, mpl::true_) const BOOST_NOEXCEPT
+    {
+        if ( 0 == ( flags_ & flag_by_value) ) return to;
+        void * data = 0;
+        std::memcpy( & data, & arg, sizeof( Arg) );
+        return data;
+    }
 
 public:
+    // offset of the members accessed by each context switch
+    static const std::size_t hot_offset = 2 * sizeof( void *);
+
     typedef parameters< Arg >                           param_type;
 
     push_coroutine_impl( coroutine_context * caller,
                          coroutine_context * callee,
                          bool unwind) :
+        except_( 0),
         flags_( 0),
-        except_(),
         caller_( caller),
-        callee_( callee)
+        callee_( callee),
+        receiver_( 0)
     {
         if ( unwind) flags_ |= flag_force_unwind;
     }
 
-    virtual ~push_coroutine_impl() {}
+    virtual ~push_coroutine_impl()
+    { release_exception( except_); }
 
     bool force_unwind() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_force_unwind); }
@@ -68,6 +99,28 @@ public:
     bool is_running() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_running); }
 
+    // execution-context and stack of the coroutine-function, null if the
+    // coroutine was passed to the coroutine-function
+    virtual coroutine_stack_context * callee_stack_() BOOST_NOEXCEPT
+    { return 0; }
+
+    stack_context const& stack_ctx() BOOST_NOEXCEPT
+    {
+        static const stack_context empty;
+        coroutine_stack_context * ctx = callee_stack_();
+        return 0 != ctx ? ctx->stack_ctx() : empty;
+    }
+
+    bool hibernate()
+    {
+        BOOST_ASSERT( ! is_running() );
+        coroutine_stack_context * ctx = callee_stack_();
+        return 0 != ctx && ! is_complete() && ctx->hibernate();
+    }
+
+    bool is_hibernated() const BOOST_NOEXCEPT
+    { return callee_->is_hibernated(); }
+
     bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
@@ -93,14 +146,24 @@ public:
 
         flags_ |= flag_running;
         param_type to( const_cast< Arg * >( & arg), this);
-        param_type * from(
-            static_cast< param_type * >(
+        param_type * from = 0;
+        try
+        {
+            from = static_cast< param_type * >(
                 caller_->jump(
                     * callee_,
-                    & to) ) );
+                    send_( & to, arg, mpl::bool_< pass_by_value< Arg >::value >() ) ) );
+        }
+        catch (...)
+        {
+            // the coroutine has not been resumed (see
+            // coroutine_context::jump_record_())
+            flags_ &= ~flag_running;
+            throw;
+        }
         flags_ &= ~flag_running;
         if ( from->do_unwind) throw forced_unwind();
-        if ( except_) rethrow_exception( except_);
+        if ( is_complete() && except_) rethrow_exception( * except_);
     }
 
     void push( BOOST_RV_REF( Arg) arg)
@@ -110,43 +173,81 @@ public:
 
         flags_ |= flag_running;
         param_type to( const_cast< Arg * >( & arg), this);
-        param_type * from(
-            static_cast< param_type * >(
+        param_type * from = 0;
+        try
+        {
+            from = static_cast< param_type * >(
                 caller_->jump(
                     * callee_,
-                    & to) ) );
+                    send_( & to, arg, mpl::bool_< pass_by_value< Arg >::value >() ) ) );
+        }
+        catch (...)
+        {
+            // the coroutine has not been resumed (see
+            // coroutine_context::jump_record_())
+            flags_ &= ~flag_running;
+            throw;
+        }
         flags_ &= ~flag_running;
         if ( from->do_unwind) throw forced_unwind();
-        if ( except_) rethrow_exception( except_);
+        if ( is_complete() && except_) rethrow_exception( * except_);
+    }
+
+    // pushes the values of [first, last) with one context switch, the
+    // receiver pulls the values following the first one from the range
+    void push_batch( Arg * first, Arg * last)
+    {
+        for ( ; first != last && ! is_complete(); ++first)
+        {
+            if ( 0 != receiver_ && 1 < last - first)
+            {
+                receiver_->set_batch( first + 1, last);
+                push( * first);
+                return;
+            }
+            // the receiver is known after the first value has been pushed
+            push( * first);
+        }
     }
 
     virtual void destroy() = 0;
+
+    // destroys the coroutine but keeps its stack if it was allocated by a
+    // stack allocator of type `alloc_id`; the allocator is assigned to
+    // `stack_alloc`
+    virtual bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id) = 0;
 };
 
 template< typename Arg >
 class push_coroutine_impl< Arg & > : private noncopyable
 {
 protected:
+    // read only after the coroutine has completed
+    exception_ptr       *   except_;
+    // accessed by each context switch (see control_block.hpp)
     int                     flags_;
-    exception_ptr           except_;
     coroutine_context   *   caller_;
     coroutine_context   *   callee_;
 
 public:
+    // offset of the members accessed by each context switch
+    static const std::size_t hot_offset = 2 * sizeof( void *);
+
     typedef parameters< Arg & >                         param_type;
 
     push_coroutine_impl( coroutine_context * caller,
                          coroutine_context * callee,
                          bool unwind) :
+        except_( 0),
         flags_( 0),
-        except_(),
         caller_( caller),
         callee_( callee)
     {
         if ( unwind) flags_ |= flag_force_unwind;
     }
 
-    virtual ~push_coroutine_impl() {}
+    virtual ~push_coroutine_impl()
+    { release_exception( except_); }
 
     bool force_unwind() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_force_unwind); }
@@ -160,6 +261,28 @@ public:
     bool is_running() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_running); }
 
+    // execution-context and stack of the coroutine-function, null if the
+    // coroutine was passed to the coroutine-function
+    virtual coroutine_stack_context * callee_stack_() BOOST_NOEXCEPT
+    { return 0; }
+
+    stack_context const& stack_ctx() BOOST_NOEXCEPT
+    {
+        static const stack_context empty;
+        coroutine_stack_context * ctx = callee_stack_();
+        return 0 != ctx ? ctx->stack_ctx() : empty;
+    }
+
+    bool hibernate()
+    {
+        BOOST_ASSERT( ! is_running() );
+        coroutine_stack_context * ctx = callee_stack_();
+        return 0 != ctx && ! is_complete() && ctx->hibernate();
+    }
+
+    bool is_hibernated() const BOOST_NOEXCEPT
+    { return callee_->is_hibernated(); }
+
     bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
@@ -185,43 +308,64 @@ public:
 
         flags_ |= flag_running;
         param_type to( & arg, this);
-        param_type * from(
-            static_cast< param_type * >(
+        param_type * from = 0;
+        try
+        {
+            from = static_cast< param_type * >(
                 caller_->jump(
                     * callee_,
-                    & to) ) );
+                    & to) );
+        }
+        catch (...)
+        {
+            // the coroutine has not been resumed (see
+            // coroutine_context::jump_record_())
+            flags_ &= ~flag_running;
+            throw;
+        }
         flags_ &= ~flag_running;
         if ( from->do_unwind) throw forced_unwind();
-        if ( except_) rethrow_exception( except_);
+        if ( is_complete() && except_) rethrow_exception( * except_);
     }
 
     virtual void destroy() = 0;
+
+    // destroys the coroutine but keeps its stack if it was allocated by a
+    // stack allocator of type `alloc_id`; the allocator is assigned to
+    // `stack_alloc`
+    virtual bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id) = 0;
 };
 
 template<>
 class push_coroutine_impl< void > : private noncopyable
 {
 protected:
+    // read only after the coroutine has completed
+    exception_ptr       *   except_;
+    // accessed by each context switch (see control_block.hpp)
     int                     flags_;
-    exception_ptr           except_;
     coroutine_context   *   caller_;
     coroutine_context   *   callee_;
 
 public:
+    // offset of the members accessed by each context switch
+    static const std::size_t hot_offset = 2 * sizeof( void *);
+
     typedef parameters< void >                          param_type;
 
     push_coroutine_impl( coroutine_context * caller,
                          coroutine_context * callee,
                          bool unwind) :
+        except_( 0),
         flags_( 0),
-        except_(),
         caller_( caller),
         callee_( callee)
     {
         if ( unwind) flags_ |= flag_force_unwind;
     }
 
-    virtual ~push_coroutine_impl() {}
+    virtual ~push_coroutine_impl()
+    { release_exception( except_); }
 
     inline bool force_unwind() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_force_unwind); }
@@ -235,6 +379,28 @@ public:
     inline bool is_running() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_running); }
 
+    // execution-context and stack of the coroutine-function, null if the
+    // coroutine was passed to the coroutine-function
+    virtual coroutine_stack_context * callee_stack_() BOOST_NOEXCEPT
+    { return 0; }
+
+    inline stack_context const& stack_ctx() BOOST_NOEXCEPT
+    {
+        static const stack_context empty;
+        coroutine_stack_context * ctx = callee_stack_();
+        return 0 != ctx ? ctx->stack_ctx() : empty;
+    }
+
+    inline bool hibernate()
+    {
+        BOOST_ASSERT( ! is_running() );
+        coroutine_stack_context * ctx = callee_stack_();
+        return 0 != ctx && ! is_complete() && ctx->hibernate();
+    }
+
+    inline bool is_hibernated() const BOOST_NOEXCEPT
+    { return callee_->is_hibernated(); }
+
     inline bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
@@ -260,17 +426,32 @@ public:
 
         flags_ |= flag_running;
         param_type to( this);
-        param_type * from(
-            static_cast< param_type * >(
+        param_type * from = 0;
+        try
+        {
+            from = static_cast< param_type * >(
                 caller_->jump(
                     * callee_,
-                    & to) ) );
+                    & to) );
+        }
+        catch (...)
+        {
+            // the coroutine has not been resumed (see
+            // coroutine_context::jump_record_())
+            flags_ &= ~flag_running;
+            throw;
+        }
         flags_ &= ~flag_running;
         if ( from->do_unwind) throw forced_unwind();
-        if ( except_) rethrow_exception( except_);
+        if ( is_complete() && except_) rethrow_exception( * except_);
     }
 
     virtual void destroy() = 0;
+
+    // destroys the coroutine but keeps its stack if it was allocated by a
+    // stack allocator of type `alloc_id`; the allocator is assigned to
+    // `stack_alloc`
+    virtual bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id) = 0;
 };
 
 }}}
@@ -13,12 +13,16 @@
 #include <boost/cstdint.hpp>
 #include <boost/exception_ptr.hpp>
 #include <boost/move/move.hpp>
+#include <boost/static_assert.hpp>
 
+#include <boost/coroutine/detail/allocate_stack.hpp>
 #include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/control_block.hpp>
 #include <boost/coroutine/detail/coroutine_context.hpp>
 #include <boost/coroutine/detail/flags.hpp>
 #include <boost/coroutine/detail/preallocated.hpp>
 #include <boost/coroutine/detail/push_coroutine_impl.hpp>
+#include <boost/coroutine/detail/stack_capacity.hpp>
 #include <boost/coroutine/detail/trampoline_push.hpp>
 #include <boost/coroutine/exceptions.hpp>
 #include <boost/coroutine/flags.hpp>
@@ -39,25 +43,25 @@ namespace detail {
 
 struct push_coroutine_context
 {
-    coroutine_context   caller;
-    coroutine_context   callee;
+    coroutine_context       caller;
+    coroutine_stack_context callee;
 
     template< typename Coro >
-    push_coroutine_context( preallocated const& palloc, Coro *) :
+    push_coroutine_context( preallocated const& palloc, flag_fpu_t preserve_fpu, Coro *) :
         caller(),
-        callee( trampoline_push< Coro >, palloc)
+        callee( trampoline_push< Coro >, palloc, preserve_fpu)
     {}
 };
 
 struct push_coroutine_context_void
 {
-    coroutine_context   caller;
-    coroutine_context   callee;
+    coroutine_context       caller;
+    coroutine_stack_context callee;
 
     template< typename Coro >
-    push_coroutine_context_void( preallocated const& palloc, Coro *) :
+    push_coroutine_context_void( preallocated const& palloc, flag_fpu_t preserve_fpu, Coro *) :
         caller(),
-        callee( trampoline_push_void< Coro >, palloc)
+        callee( trampoline_push_void< Coro >, palloc, preserve_fpu)
     {}
 };
 
@@ -70,13 +74,20 @@ private:
     typedef push_coroutine_impl< R >                                    base_t;
     typedef push_coroutine_object< PullCoro, R, Fn, StackAllocator >    obj_t;
 
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+    // base_t is the primary base, the execution-contexts follow its members;
+    // the members accessed by a context switch fit into one cache line
+    BOOST_STATIC_ASSERT( sizeof( base_t) - base_t::hot_offset + 2 * sizeof( coroutine_context)
+                         <= BOOST_COROUTINES_CACHELINE_SIZE);
+#endif
+
     Fn                  fn_;
-    stack_context       stack_ctx_;
     StackAllocator      stack_alloc_;
 
     static void deallocate_( obj_t * obj)
     {
-        stack_context stack_ctx( obj->stack_ctx_);
+        check_stack_capacity< obj_t, StackAllocator >();
+        stack_context stack_ctx( obj->callee.stack_ctx() );
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
         obj->~obj_t();
@@ -88,20 +99,22 @@ public:
     push_coroutine_object( Fn fn, attributes const& attrs,
                            preallocated const& palloc,
                            StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        ctx_t( palloc, this),
+        ctx_t( with_shared_stack< StackAllocator >( palloc), attrs.preserve_fpu, this),
         base_t( & this->caller,
                 & this->callee,
                 stack_unwind == attrs.do_unwind),
         fn_( fn),
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
-    {}
+    {
+        BOOST_ASSERT( shared_stack_of< StackAllocator >::value ||
+            one_cache_line( & this->flags_, static_cast< coroutine_context * >( & this->callee) + 1) );
+    }
 #endif
 
     push_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
                            preallocated const& palloc,
                            StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        ctx_t( palloc, this),
+        ctx_t( with_shared_stack< StackAllocator >( palloc), attrs.preserve_fpu, this),
         base_t( & this->caller,
                 & this->callee,
                 stack_unwind == attrs.do_unwind),
@@ -110,9 +123,11 @@ public:
 #else
         fn_( boost::forward< Fn >( fn) ),
 #endif
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
-    {}
+    {
+        BOOST_ASSERT( shared_stack_of< StackAllocator >::value ||
+            one_cache_line( & this->flags_, static_cast< coroutine_context * >( & this->callee) + 1) );
+    }
 
     void run( R * result)
     {
@@ -124,6 +139,7 @@ public:
         // create push_coroutine
         typename PullCoro::synth_type b( & this->callee, & this->caller, false, result);
         PullCoro pull_coro( synthesized_t::syntesized, b);
+        base_t::receiver_ = & b;
         try
         { fn_( pull_coro); }
         catch ( forced_unwind const&)
@@ -133,8 +149,9 @@ public:
         { throw; }
 #endif
         catch (...)
-        { base_t::except_ = current_exception(); }
+        { base_t::except_ = store_current_exception(); }
 
+        base_t::receiver_ = 0;
         base_t::flags_ |= flag_complete;
         base_t::flags_ &= ~flag_running;
         typename base_t::param_type to;
@@ -146,6 +163,21 @@ public:
 
     void destroy()
     { deallocate_( this); }
+
+    coroutine_stack_context * callee_stack_() BOOST_NOEXCEPT
+    { return & this->callee; }
+
+    bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id)
+    {
+        // a shared stack is not owned by the coroutine
+        if ( allocator_id< StackAllocator >() != alloc_id || shared_stack_of< StackAllocator >::value)
+            return false;
+        sctx = this->callee.stack_ctx();
+        * static_cast< StackAllocator * >( stack_alloc) = stack_alloc_;
+        this->unwind_stack();
+        this->~obj_t();
+        return true;
+    }
 };
 
 template< typename PullCoro, typename R, typename Fn, typename StackAllocator >
@@ -157,13 +189,20 @@ private:
     typedef push_coroutine_impl< R & >                                      base_t;
     typedef push_coroutine_object< PullCoro, R &, Fn, StackAllocator >      obj_t;
 
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+    // base_t is the primary base, the execution-contexts follow its members;
+    // the members accessed by a context switch fit into one cache line
+    BOOST_STATIC_ASSERT( sizeof( base_t) - base_t::hot_offset + 2 * sizeof( coroutine_context)
+                         <= BOOST_COROUTINES_CACHELINE_SIZE);
+#endif
+
     Fn                  fn_;
-    stack_context       stack_ctx_;
     StackAllocator      stack_alloc_;
 
     static void deallocate_( obj_t * obj)
     {
-        stack_context stack_ctx( obj->stack_ctx_);
+        check_stack_capacity< obj_t, StackAllocator >();
+        stack_context stack_ctx( obj->callee.stack_ctx() );
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
         obj->~obj_t();
@@ -175,20 +214,22 @@ public:
     push_coroutine_object( Fn fn, attributes const& attrs,
                            preallocated const& palloc,
                            StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        ctx_t( palloc, this),
+        ctx_t( with_shared_stack< StackAllocator >( palloc), attrs.preserve_fpu, this),
         base_t( & this->caller,
                 & this->callee,
                 stack_unwind == attrs.do_unwind),
         fn_( fn),
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
-    {}
+    {
+        BOOST_ASSERT( shared_stack_of< StackAllocator >::value ||
+            one_cache_line( & this->flags_, static_cast< coroutine_context * >( & this->callee) + 1) );
+    }
 #endif
 
     push_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
                            preallocated const& palloc,
                            StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        ctx_t( palloc, this),
+        ctx_t( with_shared_stack< StackAllocator >( palloc), attrs.preserve_fpu, this),
         base_t( & this->caller,
                 & this->callee,
                 stack_unwind == attrs.do_unwind),
@@ -197,9 +238,11 @@ public:
 #else
         fn_( boost::forward< Fn >( fn) ),
 #endif
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
-    {}
+    {
+        BOOST_ASSERT( shared_stack_of< StackAllocator >::value ||
+            one_cache_line( & this->flags_, static_cast< coroutine_context * >( & this->callee) + 1) );
+    }
 
     void run( R * result)
     {
@@ -220,7 +263,7 @@ public:
         { throw; }
 #endif
         catch (...)
-        { base_t::except_ = current_exception(); }
+        { base_t::except_ = store_current_exception(); }
 
         base_t::flags_ |= flag_complete;
         base_t::flags_ &= ~flag_running;
@@ -233,6 +276,21 @@ public:
 
     void destroy()
     { deallocate_( this); }
+
+    coroutine_stack_context * callee_stack_() BOOST_NOEXCEPT
+    { return & this->callee; }
+
+    bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id)
+    {
+        // a shared stack is not owned by the coroutine
+        if ( allocator_id< StackAllocator >() != alloc_id || shared_stack_of< StackAllocator >::value)
+            return false;
+        sctx = this->callee.stack_ctx();
+        * static_cast< StackAllocator * >( stack_alloc) = stack_alloc_;
+        this->unwind_stack();
+        this->~obj_t();
+        return true;
+    }
 };
 
 template< typename PullCoro, typename Fn, typename StackAllocator >
@@ -244,13 +302,20 @@ private:
     typedef push_coroutine_impl< void >                                     base_t;
     typedef push_coroutine_object< PullCoro, void, Fn, StackAllocator >     obj_t;
 
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+    // base_t is the primary base, the execution-contexts follow its members;
+    // the members accessed by a context switch fit into one cache line
+    BOOST_STATIC_ASSERT( sizeof( base_t) - base_t::hot_offset + 2 * sizeof( coroutine_context)
+                         <= BOOST_COROUTINES_CACHELINE_SIZE);
+#endif
+
     Fn                  fn_;
-    stack_context       stack_ctx_;
     StackAllocator      stack_alloc_;
 
     static void deallocate_( obj_t * obj)
     {
-        stack_context stack_ctx( obj->stack_ctx_);
+        check_stack_capacity< obj_t, StackAllocator >();
+        stack_context stack_ctx( obj->callee.stack_ctx() );
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
         obj->~obj_t();
@@ -262,20 +327,22 @@ public:
     push_coroutine_object( Fn fn, attributes const& attrs,
                            preallocated const& palloc,
                            StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        ctx_t( palloc, this),
+        ctx_t( with_shared_stack< StackAllocator >( palloc), attrs.preserve_fpu, this),
         base_t( & this->caller,
                 & this->callee,
                 stack_unwind == attrs.do_unwind),
         fn_( fn),
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
-    {}
+    {
+        BOOST_ASSERT( shared_stack_of< StackAllocator >::value ||
+            one_cache_line( & this->flags_, static_cast< coroutine_context * >( & this->callee) + 1) );
+    }
 #endif
 
     push_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
                            preallocated const& palloc,
                            StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        ctx_t( palloc, this),
+        ctx_t( with_shared_stack< StackAllocator >( palloc), attrs.preserve_fpu, this),
         base_t( & this->caller,
                 & this->callee,
                 stack_unwind == attrs.do_unwind),
@@ -284,9 +351,11 @@ public:
 #else
         fn_( boost::forward< Fn >( fn) ),
 #endif
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
-    {}
+    {
+        BOOST_ASSERT( shared_stack_of< StackAllocator >::value ||
+            one_cache_line( & this->flags_, static_cast< coroutine_context * >( & this->callee) + 1) );
+    }
 
     void run()
     {
@@ -307,7 +376,7 @@ public:
         { throw; }
 #endif
         catch (...)
-        { base_t::except_ = current_exception(); }
+        { base_t::except_ = store_current_exception(); }
 
         base_t::flags_ |= flag_complete;
         base_t::flags_ &= ~flag_running;
@@ -320,6 +389,21 @@ public:
 
     void destroy()
     { deallocate_( this); }
+
+    coroutine_stack_context * callee_stack_() BOOST_NOEXCEPT
+    { return & this->callee; }
+
+    bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id)
+    {
+        // a shared stack is not owned by the coroutine
+        if ( allocator_id< StackAllocator >() != alloc_id || shared_stack_of< StackAllocator >::value)
+            return false;
+        sctx = this->callee.stack_ctx();
+        * static_cast< StackAllocator * >( stack_alloc) = stack_alloc_;
+        this->unwind_stack();
+        this->~obj_t();
+        return true;
+    }
 };
 
 }}}
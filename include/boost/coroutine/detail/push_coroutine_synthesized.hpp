@@ -7,10 +7,15 @@
 #ifndef BOOST_COROUTINES_DETAIL_PUSH_COROUTINE_SYNTHESIZED_H
 #define BOOST_COROUTINES_DETAIL_PUSH_COROUTINE_SYNTHESIZED_H
 
+#include <cstddef>
+
+#include <boost/assert.hpp>
 #include <boost/config.hpp>
 
 #include <boost/coroutine/detail/config.hpp>
 #include <boost/coroutine/detail/coroutine_context.hpp>
+#include <boost/coroutine/detail/flags.hpp>
+#include <boost/coroutine/detail/parameters.hpp>
 #include <boost/coroutine/detail/push_coroutine_impl.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -30,11 +35,22 @@ private:
 public:
     push_coroutine_synthesized( coroutine_context * caller,
                                 coroutine_context * callee,
-                                bool unwind) :
+                                bool unwind,
+                                pull_coroutine_impl< R > * receiver) :
         impl_t( caller, callee, unwind)
-    {}
+    {
+        // the values are pulled by a pull-coroutine created by the user
+        if ( pass_by_value< R >::value) this->flags_ |= flag_by_value;
+        this->receiver_ = receiver;
+    }
 
     void destroy() {}
+
+    bool recycle( stack_context &, void *, std::size_t)
+    {
+        BOOST_ASSERT_MSG( false, "coroutine passed to the coroutine-function can not be reset");
+        return false;
+    }
 };
 
 template< typename R >
@@ -51,6 +67,12 @@ public:
     {}
 
     void destroy() {}
+
+    bool recycle( stack_context &, void *, std::size_t)
+    {
+        BOOST_ASSERT_MSG( false, "coroutine passed to the coroutine-function can not be reset");
+        return false;
+    }
 };
 
 template<>
@@ -67,6 +89,12 @@ public:
     {}
 
     inline void destroy() {}
+
+    inline bool recycle( stack_context &, void *, std::size_t)
+    {
+        BOOST_ASSERT_MSG( false, "coroutine passed to the coroutine-function can not be reset");
+        return false;
+    }
 };
 
 }}}
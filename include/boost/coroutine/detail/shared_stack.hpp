@@ -0,0 +1,68 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_SHARED_STACK_H
+#define BOOST_COROUTINES_DETAIL_SHARED_STACK_H
+
+#include <cstddef>
+
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/coroutine_context.hpp>
+#include <boost/coroutine/detail/shared_stack_record.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// a stack shared by coroutines, only `owner` has its stack in place
+// `switcher` runs on a private stack and copies the stacks if a coroutine
+// resumes another coroutine of the same shared stack
+struct shared_stack
+{
+    stack_context               sctx;
+    stack_context               switcher_sctx;
+    coroutine_context           switcher;
+    shared_stack_record     *   owner;
+    // coroutine which has resumed `owner` through `switcher` (its stack is
+    // saved), null if `owner` was resumed otherwise
+    shared_stack_record     *   sender;
+    // capacity of all buffers
+    std::size_t                 buffer_bytes;
+    // bytes copied from and to the shared stack
+    std::size_t                 copied_bytes;
+
+    shared_stack() BOOST_NOEXCEPT :
+        sctx(),
+        switcher_sctx(),
+        switcher(),
+        owner( 0),
+        sender( 0),
+        buffer_bytes( 0),
+        copied_bytes( 0)
+    {}
+};
+
+// entry of `shared_stack::switcher`
+BOOST_COROUTINES_DECL void shared_stack_switch( context::detail::transfer_t);
+
+// shared stack resumed last by a jump() to a coroutine of a shared stack in
+// this thread, a hint for the stack the running execution-context is on
+BOOST_COROUTINES_DECL shared_stack *& running_stack() BOOST_NOEXCEPT;
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_SHARED_STACK_H
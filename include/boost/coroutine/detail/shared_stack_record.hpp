@@ -0,0 +1,63 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_SHARED_STACK_RECORD_H
+#define BOOST_COROUTINES_DETAIL_SHARED_STACK_RECORD_H
+
+#include <cstddef>
+
+#include <boost/config.hpp>
+#include <boost/context/detail/fcontext.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+struct shared_stack;
+
+// a coroutine running on a shared stack
+// while another coroutine occupies the stack, the live part of its stack
+// ([sp, top of the shared stack)) is kept in `buffer`
+// a record without stack describes a hibernated coroutine: `buffer` holds
+// [sp, sp + size + kept_size) except the bytes [kept, kept + kept_size) left
+// in place
+struct shared_stack_record
+{
+    shared_stack                *   stack;
+    // entry of a coroutine which has not occupied the stack yet
+    void( * fn)( context::detail::transfer_t);
+    void                        *   sp;
+    char                        *   buffer;
+    std::size_t                     capacity;
+    std::size_t                     size;
+    char                        *   kept;
+    std::size_t                     kept_size;
+
+    explicit shared_stack_record( shared_stack * stack_) BOOST_NOEXCEPT :
+        stack( stack_),
+        fn( 0),
+        sp( 0),
+        buffer( 0),
+        capacity( 0),
+        size( 0),
+        kept( 0),
+        kept_size( 0)
+    {}
+};
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_SHARED_STACK_RECORD_H
@@ -0,0 +1,50 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_STACK_CAPACITY_H
+#define BOOST_COROUTINES_DETAIL_STACK_CAPACITY_H
+
+#include <cstddef>
+
+#include <boost/config.hpp>
+#include <boost/static_assert.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/control_block.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// size of the stacks handed out by `StackAllocator` if known at compile
+// time, zero otherwise
+template< typename StackAllocator >
+struct stack_capacity
+{ static const std::size_t value = 0; };
+
+// the control block of a coroutine is placed on top of its stack, padded
+// as computed by control_block_size()
+template< typename Object, typename StackAllocator >
+void check_stack_capacity() BOOST_NOEXCEPT
+{
+    BOOST_STATIC_ASSERT_MSG(
+        0 == stack_capacity< StackAllocator >::value ||
+        sizeof( Object) + control_block_padding< Object >::value
+            < stack_capacity< StackAllocator >::value,
+        "stack does not hold the control block of the coroutine");
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_STACK_CAPACITY_H
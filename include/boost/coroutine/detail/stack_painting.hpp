@@ -0,0 +1,93 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_STACK_PAINTING_H
+#define BOOST_COROUTINES_DETAIL_STACK_PAINTING_H
+
+#include <cstddef>
+
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/stack_context.hpp>
+#include <boost/coroutine/stack_traits.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+typedef boost::uintptr_t    paint_word;
+
+inline
+paint_word paint_pattern() BOOST_NOEXCEPT
+{ return static_cast< paint_word >( 0xcafebabedeadbeefULL); }
+
+// stored in the lowest painted word, tells painted stacks apart from others
+inline
+paint_word paint_marker() BOOST_NOEXCEPT
+{ return static_cast< paint_word >( 0x5eed5eedfeedc0deULL); }
+
+// the painted range of a stack, the lowest page is skipped (might be a
+// guard page)
+inline
+bool painted_range( stack_context const& ctx, paint_word *& first, paint_word *& last) BOOST_NOEXCEPT
+{
+    if ( 0 == ctx.sp || ctx.size <= stack_traits::page_size() ) return false;
+    const std::size_t align = sizeof( paint_word);
+    const boost::uintptr_t top = reinterpret_cast< boost::uintptr_t >( ctx.sp);
+    const boost::uintptr_t limit = top - ctx.size + stack_traits::page_size();
+    first = reinterpret_cast< paint_word * >( ( limit + align - 1) & ~( align - 1) );
+    last = reinterpret_cast< paint_word * >( top & ~( align - 1) );
+    return first < last;
+}
+
+inline
+void paint_stack( stack_context const& ctx) BOOST_NOEXCEPT
+{
+    paint_word * first = 0, * last = 0;
+    if ( ! painted_range( ctx, first, last) ) return;
+    * first = paint_marker();
+    const paint_word pattern = paint_pattern();
+    for ( paint_word * p = first + 1; p != last; ++p) * p = pattern;
+}
+
+// bytes of a painted stack which have been used (high-water mark),
+// the scan starts above the marker and stops at the first word which does
+// not match the pattern
+// 0 if the marker is missing: the stack was not painted (or the stack has
+// been used down to the marker)
+inline
+std::size_t painted_stack_usage( stack_context const& ctx) BOOST_NOEXCEPT
+{
+    paint_word * first = 0, * last = 0;
+    if ( ! painted_range( ctx, first, last) || paint_marker() != * first) return 0;
+    const paint_word pattern = paint_pattern();
+    paint_word * p = first + 1;
+    while ( p != last && pattern == * p) ++p;
+    return static_cast< char * >( ctx.sp) - reinterpret_cast< char * >( p);
+}
+
+// removes the marker before the stack is deallocated, memory reused by
+// another allocation (malloc) does not appear painted
+inline
+void unpaint_stack( stack_context const& ctx) BOOST_NOEXCEPT
+{
+    paint_word * first = 0, * last = 0;
+    if ( painted_range( ctx, first, last) ) * first = 0;
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_STACK_PAINTING_H
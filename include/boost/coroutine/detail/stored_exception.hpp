@@ -0,0 +1,56 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_STORED_EXCEPTION_H
+#define BOOST_COROUTINES_DETAIL_STORED_EXCEPTION_H
+
+#include <new>
+
+#include <boost/config.hpp>
+#include <boost/exception_ptr.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+namespace detail {
+
+// the exception escaping a coroutine-function is stored out of line, the
+// control block of the coroutine holds a pointer only
+
+inline
+exception_ptr * out_of_memory_exception()
+{
+    static exception_ptr except( copy_exception( std::bad_alloc() ) );
+    return & except;
+}
+
+// must be called from a catch block
+inline
+exception_ptr * store_current_exception()
+{
+    exception_ptr * except = new ( std::nothrow) exception_ptr( current_exception() );
+    return 0 != except ? except : out_of_memory_exception();
+}
+
+inline
+void release_exception( exception_ptr * except) BOOST_NOEXCEPT
+{
+    if ( 0 != except && out_of_memory_exception() != except)
+        delete except;
+}
+
+}}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_STORED_EXCEPTION_H
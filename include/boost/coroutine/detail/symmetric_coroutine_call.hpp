@@ -13,8 +13,11 @@
 #include <boost/utility/explicit_operator_bool.hpp>
 
 #include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/detail/allocate_stack.hpp>
 #include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/control_block.hpp>
 #include <boost/coroutine/detail/preallocated.hpp>
+#include <boost/coroutine/detail/stack_painting.hpp>
 #include <boost/coroutine/detail/symmetric_coroutine_impl.hpp>
 #include <boost/coroutine/detail/symmetric_coroutine_object.hpp>
 #include <boost/coroutine/detail/symmetric_coroutine_yield.hpp>
@@ -64,14 +67,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg, coroutine_fn, stack_allocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -88,14 +91,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg, coroutine_fn, StackAllocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -112,14 +115,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg, Fn, stack_allocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -136,14 +139,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg, Fn, StackAllocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -160,14 +163,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg, Fn, stack_allocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -184,14 +187,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg, Fn, StackAllocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -208,14 +211,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg, Fn, stack_allocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -232,14 +235,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg, Fn, StackAllocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -270,12 +273,74 @@ public:
 
     BOOST_EXPLICIT_OPERATOR_BOOL();
 
+    // bytes used by the coroutine so far, 0 unless the stack was painted
+    std::size_t stack_high_water_mark() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return detail::painted_stack_usage( impl_->stack_ctx() );
+    }
+
+    bool hibernate()
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->hibernate();
+    }
+
+    bool is_hibernated() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->is_hibernated();
+    }
+
     bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete() || impl_->is_running(); }
 
+    // replaces the coroutine-function by `fn`, the coroutine starts from the
+    // beginning; the stack is reused if it was allocated by a `StackAllocator`
+    // and is not smaller than `attrs.size`
+    template< typename Fn >
+    void reset( Fn fn, attributes const& attrs = attributes() )
+    { reset< Fn, stack_allocator >( boost::move( fn), attrs, stack_allocator() ); }
+
+    template< typename Fn, typename StackAllocator >
+    void reset( Fn fn, attributes const& attrs, StackAllocator stack_alloc)
+    {
+        BOOST_ASSERT( 0 == impl_ || ! impl_->is_running() );
+
+        typedef symmetric_coroutine_object< Arg, Fn, StackAllocator > object_t;
+        stack_context stack_ctx;
+        impl_type * impl = impl_;
+        impl_ = 0;
+        // unwinds and destroys the previous coroutine
+        recycle_stack( impl, stack_alloc, stack_ctx, attrs, kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
+        impl_ = new ( sp) object_t(
+                boost::move( fn), attrs, preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+    }
+
     void swap( symmetric_coroutine_call & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    // passes a copy of `arg`
+    symmetric_coroutine_call & operator()( Arg const& arg)
+    {
+        Arg tmp( arg);
+        return ( * this)( boost::move( tmp) );
+    }
+
+    // passes `arg` without a copy, the coroutine may move it out
+    symmetric_coroutine_call & operator()( Arg && arg) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( * this);
+
+        impl_->resume( arg);
+        return * this;
+    }
+#else
     symmetric_coroutine_call & operator()( Arg arg) BOOST_NOEXCEPT
     {
         BOOST_ASSERT( * this);
@@ -283,6 +348,7 @@ public:
         impl_->resume( arg);
         return * this;
     }
+#endif
 };
 
 template< typename Arg >
@@ -320,14 +386,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg &, coroutine_fn, stack_allocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -344,14 +410,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg &, coroutine_fn, StackAllocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -368,14 +434,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg &, Fn, stack_allocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -392,14 +458,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg &, Fn, StackAllocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -416,14 +482,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg &, Fn, stack_allocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -440,14 +506,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg &, Fn, StackAllocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -464,14 +530,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg &, Fn, stack_allocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -488,14 +554,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< Arg &, Fn, StackAllocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -526,9 +592,54 @@ public:
 
     BOOST_EXPLICIT_OPERATOR_BOOL();
 
+    // bytes used by the coroutine so far, 0 unless the stack was painted
+    std::size_t stack_high_water_mark() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return detail::painted_stack_usage( impl_->stack_ctx() );
+    }
+
+    bool hibernate()
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->hibernate();
+    }
+
+    bool is_hibernated() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->is_hibernated();
+    }
+
     bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete() || impl_->is_running(); }
 
+    // replaces the coroutine-function by `fn`, the coroutine starts from the
+    // beginning; the stack is reused if it was allocated by a `StackAllocator`
+    // and is not smaller than `attrs.size`
+    template< typename Fn >
+    void reset( Fn fn, attributes const& attrs = attributes() )
+    { reset< Fn, stack_allocator >( boost::move( fn), attrs, stack_allocator() ); }
+
+    template< typename Fn, typename StackAllocator >
+    void reset( Fn fn, attributes const& attrs, StackAllocator stack_alloc)
+    {
+        BOOST_ASSERT( 0 == impl_ || ! impl_->is_running() );
+
+        typedef symmetric_coroutine_object< Arg &, Fn, StackAllocator > object_t;
+        stack_context stack_ctx;
+        impl_type * impl = impl_;
+        impl_ = 0;
+        // unwinds and destroys the previous coroutine
+        recycle_stack( impl, stack_alloc, stack_ctx, attrs, kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
+        impl_ = new ( sp) object_t(
+                boost::move( fn), attrs, preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+    }
+
     void swap( symmetric_coroutine_call & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
@@ -576,14 +687,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< void, coroutine_fn, stack_allocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -600,14 +711,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< void, coroutine_fn, StackAllocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -624,14 +735,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< void, Fn, stack_allocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -648,14 +759,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< void, Fn, StackAllocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -672,14 +783,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< void, Fn, stack_allocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -696,14 +807,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< void, Fn, StackAllocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -720,14 +831,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< void, Fn, stack_allocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -744,14 +855,14 @@ public:
         // create a stack-context
         stack_context stack_ctx;
         // allocate the coroutine-stack
-        stack_alloc.allocate( stack_ctx, attrs.size);
+        detail::allocate_stack( stack_alloc, stack_ctx, attrs, detail::kind_of( fn) );
         BOOST_ASSERT( 0 != stack_ctx.sp);
         // typedef of internal coroutine-type
         typedef symmetric_coroutine_object< void, Fn, StackAllocator > object_t;
         // reserve space on top of coroutine-stack for internal coroutine-type
-        std::size_t size = stack_ctx.size - sizeof( object_t);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != size);
-        void * sp = static_cast< char * >( stack_ctx.sp) - sizeof( object_t);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
         BOOST_ASSERT( 0 != sp);
         // placement new for internal coroutine
         impl_ = new ( sp) object_t(
@@ -782,9 +893,54 @@ public:
 
     BOOST_EXPLICIT_OPERATOR_BOOL();
 
+    // bytes used by the coroutine so far, 0 unless the stack was painted
+    inline std::size_t stack_high_water_mark() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return detail::painted_stack_usage( impl_->stack_ctx() );
+    }
+
+    inline bool hibernate()
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->hibernate();
+    }
+
+    inline bool is_hibernated() const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != impl_);
+        return impl_->is_hibernated();
+    }
+
     inline bool operator!() const BOOST_NOEXCEPT
     { return 0 == impl_ || impl_->is_complete() || impl_->is_running(); }
 
+    // replaces the coroutine-function by `fn`, the coroutine starts from the
+    // beginning; the stack is reused if it was allocated by a `StackAllocator`
+    // and is not smaller than `attrs.size`
+    template< typename Fn >
+    inline void reset( Fn fn, attributes const& attrs = attributes() )
+    { reset< Fn, stack_allocator >( boost::move( fn), attrs, stack_allocator() ); }
+
+    template< typename Fn, typename StackAllocator >
+    inline void reset( Fn fn, attributes const& attrs, StackAllocator stack_alloc)
+    {
+        BOOST_ASSERT( 0 == impl_ || ! impl_->is_running() );
+
+        typedef symmetric_coroutine_object< void, Fn, StackAllocator > object_t;
+        stack_context stack_ctx;
+        impl_type * impl = impl_;
+        impl_ = 0;
+        // unwinds and destroys the previous coroutine
+        recycle_stack( impl, stack_alloc, stack_ctx, attrs, kind_of( fn) );
+        BOOST_ASSERT( 0 != stack_ctx.sp);
+        std::size_t size = stack_ctx.size - control_block_size< object_t >( stack_ctx);
+        void * sp = static_cast< char * >( stack_ctx.sp) - control_block_size< object_t >( stack_ctx);
+        impl_ = new ( sp) object_t(
+                boost::move( fn), attrs, preallocated( sp, size, stack_ctx), stack_alloc);
+        BOOST_ASSERT( impl_);
+    }
+
     inline void swap( symmetric_coroutine_call & other) BOOST_NOEXCEPT
     { std::swap( impl_, other.impl_); }
 
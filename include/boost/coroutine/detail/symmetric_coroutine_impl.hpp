@@ -7,18 +7,22 @@
 #ifndef BOOST_COROUTINES_DETAIL_SYMMETRIC_COROUTINE_IMPL_H
 #define BOOST_COROUTINES_DETAIL_SYMMETRIC_COROUTINE_IMPL_H
 
+#include <cstddef>
+
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
 #include <boost/cstdint.hpp>
 #include <boost/utility.hpp>
 
 #include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/control_block.hpp>
 #include <boost/coroutine/detail/coroutine_context.hpp>
 #include <boost/coroutine/detail/flags.hpp>
 #include <boost/coroutine/detail/parameters.hpp>
 #include <boost/coroutine/detail/preallocated.hpp>
 #include <boost/coroutine/detail/trampoline.hpp>
 #include <boost/coroutine/exceptions.hpp>
+#include <boost/coroutine/flags.hpp>
 #include <boost/coroutine/stack_context.hpp>
 
 #ifdef BOOST_HAS_ABI_HEADERS
@@ -33,15 +37,21 @@ template< typename R >
 class symmetric_coroutine_impl : private noncopyable
 {
 public:
+    // offset of the members accessed by each context switch
+    static const std::size_t hot_offset = sizeof( void *);
+
     typedef parameters< R >                           param_type;
 
     symmetric_coroutine_impl( preallocated const& palloc,
-                              bool unwind) BOOST_NOEXCEPT :
+                              bool unwind,
+                              flag_fpu_t preserve_fpu) BOOST_NOEXCEPT :
         flags_( 0),
         caller_(),
-        callee_( trampoline< symmetric_coroutine_impl< R > >, palloc)
+        callee_( trampoline< symmetric_coroutine_impl< R > >, palloc, preserve_fpu)
     {
         if ( unwind) flags_ |= flag_force_unwind;
+        BOOST_ASSERT( 0 != palloc.shared ||
+            one_cache_line( & flags_, static_cast< coroutine_context * >( & callee_) + 1) );
     }
 
     virtual ~symmetric_coroutine_impl() {}
@@ -58,6 +68,18 @@ public:
     bool is_running() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_running); }
 
+    stack_context & stack_ctx() BOOST_NOEXCEPT
+    { return callee_.stack_ctx(); }
+
+    bool hibernate()
+    {
+        BOOST_ASSERT( ! is_running() );
+        return ! is_complete() && callee_.hibernate();
+    }
+
+    bool is_hibernated() const BOOST_NOEXCEPT
+    { return callee_.is_hibernated(); }
+
     bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
@@ -78,9 +100,11 @@ public:
         }
     }
 
-    void resume( R r) BOOST_NOEXCEPT
+    // `r` is owned by the caller until the coroutine suspends, the
+    // coroutine may move it out
+    void resume( R & r) BOOST_NOEXCEPT
     {
-        param_type to( const_cast< R * >( & r), this);
+        param_type to( & r, this);
         resume_( & to);
     }
 
@@ -99,11 +123,11 @@ public:
         flags_ |= flag_running;
         if ( from->do_unwind) throw forced_unwind();
         BOOST_ASSERT( from->data);
-        return from->data;
+        return callee_.passed( from->data);
     }
 
     template< typename X >
-    R * yield_to( symmetric_coroutine_impl< X > * other, X x)
+    R * yield_to( symmetric_coroutine_impl< X > * other, X & x)
     {
         typename symmetric_coroutine_impl< X >::param_type to( & x, other);
         return yield_to_( other, & to);
@@ -116,6 +140,18 @@ public:
         return yield_to_( other, & to);
     }
 
+    // `x` is copied for coroutines taking values
+    template< typename X >
+    R * yield_to_copy( symmetric_coroutine_impl< X > * other, X const& x)
+    {
+        X tmp( x);
+        return yield_to( other, tmp);
+    }
+
+    template< typename X >
+    R * yield_to_copy( symmetric_coroutine_impl< X & > * other, X & x)
+    { return yield_to( other, x); }
+
     template< typename X >
     R * yield_to( symmetric_coroutine_impl< X > * other)
     {
@@ -127,13 +163,19 @@ public:
 
     virtual void destroy() = 0;
 
+    // destroys the coroutine but keeps its stack if it was allocated by a
+    // stack allocator of type `alloc_id`; the allocator is assigned to
+    // `stack_alloc`
+    virtual bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id) = 0;
+
 protected:
     template< typename X >
     friend class symmetric_coroutine_impl;
 
-    int                 flags_;
-    coroutine_context   caller_;
-    coroutine_context   callee_;
+    // accessed by each context switch (see control_block.hpp)
+    int                     flags_;
+    coroutine_context       caller_;
+    coroutine_stack_context callee_;
 
     void resume_( param_type * to) BOOST_NOEXCEPT
     {
@@ -165,7 +207,7 @@ protected:
         flags_ |= flag_running;
         if ( from->do_unwind) throw forced_unwind();
         BOOST_ASSERT( from->data);
-        return from->data;
+        return callee_.passed( from->data);
     }
 };
 
@@ -173,15 +215,21 @@ template< typename R >
 class symmetric_coroutine_impl< R & > : private noncopyable
 {
 public:
+    // offset of the members accessed by each context switch
+    static const std::size_t hot_offset = sizeof( void *);
+
     typedef parameters< R & >                         param_type;
 
     symmetric_coroutine_impl( preallocated const& palloc,
-                              bool unwind) BOOST_NOEXCEPT :
+                              bool unwind,
+                              flag_fpu_t preserve_fpu) BOOST_NOEXCEPT :
         flags_( 0),
         caller_(),
-        callee_( trampoline< symmetric_coroutine_impl< R > >, palloc)
+        callee_( trampoline< symmetric_coroutine_impl< R > >, palloc, preserve_fpu)
     {
         if ( unwind) flags_ |= flag_force_unwind;
+        BOOST_ASSERT( 0 != palloc.shared ||
+            one_cache_line( & flags_, static_cast< coroutine_context * >( & callee_) + 1) );
     }
 
     virtual ~symmetric_coroutine_impl() {}
@@ -198,6 +246,18 @@ public:
     bool is_running() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_running); }
 
+    stack_context & stack_ctx() BOOST_NOEXCEPT
+    { return callee_.stack_ctx(); }
+
+    bool hibernate()
+    {
+        BOOST_ASSERT( ! is_running() );
+        return ! is_complete() && callee_.hibernate();
+    }
+
+    bool is_hibernated() const BOOST_NOEXCEPT
+    { return callee_.is_hibernated(); }
+
     bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
@@ -239,11 +299,11 @@ public:
         flags_ |= flag_running;
         if ( from->do_unwind) throw forced_unwind();
         BOOST_ASSERT( from->data);
-        return from->data;
+        return callee_.passed( from->data);
     }
 
     template< typename X >
-    R * yield_to( symmetric_coroutine_impl< X > * other, X x)
+    R * yield_to( symmetric_coroutine_impl< X > * other, X & x)
     {
         typename symmetric_coroutine_impl< X >::param_type to( & x, other);
         return yield_to_( other, & to);
@@ -256,6 +316,18 @@ public:
         return yield_to_( other, & to);
     }
 
+    // `x` is copied for coroutines taking values
+    template< typename X >
+    R * yield_to_copy( symmetric_coroutine_impl< X > * other, X const& x)
+    {
+        X tmp( x);
+        return yield_to( other, tmp);
+    }
+
+    template< typename X >
+    R * yield_to_copy( symmetric_coroutine_impl< X & > * other, X & x)
+    { return yield_to( other, x); }
+
     template< typename X >
     R * yield_to( symmetric_coroutine_impl< X > * other)
     {
@@ -267,13 +339,19 @@ public:
 
     virtual void destroy() = 0;
 
+    // destroys the coroutine but keeps its stack if it was allocated by a
+    // stack allocator of type `alloc_id`; the allocator is assigned to
+    // `stack_alloc`
+    virtual bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id) = 0;
+
 protected:
     template< typename X >
     friend class symmetric_coroutine_impl;
 
-    int                 flags_;
-    coroutine_context   caller_;
-    coroutine_context   callee_;
+    // accessed by each context switch (see control_block.hpp)
+    int                     flags_;
+    coroutine_context       caller_;
+    coroutine_stack_context callee_;
 
     void resume_( param_type * to) BOOST_NOEXCEPT
     {
@@ -305,7 +383,7 @@ protected:
         flags_ |= flag_running;
         if ( from->do_unwind) throw forced_unwind();
         BOOST_ASSERT( from->data);
-        return from->data;
+        return callee_.passed( from->data);
     }
 };
 
@@ -313,15 +391,21 @@ template<>
 class symmetric_coroutine_impl< void > : private noncopyable
 {
 public:
+    // offset of the members accessed by each context switch
+    static const std::size_t hot_offset = sizeof( void *);
+
     typedef parameters< void >                          param_type;
 
     symmetric_coroutine_impl( preallocated const& palloc,
-                              bool unwind) BOOST_NOEXCEPT :
+                              bool unwind,
+                              flag_fpu_t preserve_fpu) BOOST_NOEXCEPT :
         flags_( 0),
         caller_(),
-        callee_( trampoline_void< symmetric_coroutine_impl< void > >, palloc)
+        callee_( trampoline_void< symmetric_coroutine_impl< void > >, palloc, preserve_fpu)
     {
         if ( unwind) flags_ |= flag_force_unwind;
+        BOOST_ASSERT( 0 != palloc.shared ||
+            one_cache_line( & flags_, static_cast< coroutine_context * >( & callee_) + 1) );
     }
 
     virtual ~symmetric_coroutine_impl() {}
@@ -338,6 +422,18 @@ public:
     inline bool is_running() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_running); }
 
+    inline stack_context & stack_ctx() BOOST_NOEXCEPT
+    { return callee_.stack_ctx(); }
+
+    inline bool hibernate()
+    {
+        BOOST_ASSERT( ! is_running() );
+        return ! is_complete() && callee_.hibernate();
+    }
+
+    inline bool is_hibernated() const BOOST_NOEXCEPT
+    { return callee_.is_hibernated(); }
+
     inline bool is_complete() const BOOST_NOEXCEPT
     { return 0 != ( flags_ & flag_complete); }
 
@@ -388,7 +484,7 @@ public:
     }
 
     template< typename X >
-    void yield_to( symmetric_coroutine_impl< X > * other, X x)
+    void yield_to( symmetric_coroutine_impl< X > * other, X & x)
     {
         typename symmetric_coroutine_impl< X >::param_type to( & x, other);
         yield_to_( other, & to);
@@ -401,6 +497,18 @@ public:
         yield_to_( other, & to);
     }
 
+    // `x` is copied for coroutines taking values
+    template< typename X >
+    void yield_to_copy( symmetric_coroutine_impl< X > * other, X const& x)
+    {
+        X tmp( x);
+        yield_to( other, tmp);
+    }
+
+    template< typename X >
+    void yield_to_copy( symmetric_coroutine_impl< X & > * other, X & x)
+    { yield_to( other, x); }
+
     template< typename X >
     void yield_to( symmetric_coroutine_impl< X > * other)
     {
@@ -412,13 +520,19 @@ public:
 
     virtual void destroy() = 0;
 
+    // destroys the coroutine but keeps its stack if it was allocated by a
+    // stack allocator of type `alloc_id`; the allocator is assigned to
+    // `stack_alloc`
+    virtual bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id) = 0;
+
 protected:
     template< typename X >
     friend class symmetric_coroutine_impl;
 
-    int                 flags_;
-    coroutine_context   caller_;
-    coroutine_context   callee_;
+    // accessed by each context switch (see control_block.hpp)
+    int                     flags_;
+    coroutine_context       caller_;
+    coroutine_stack_context callee_;
 
     template< typename Other >
     void yield_to_( Other * other, typename Other::param_type * to)
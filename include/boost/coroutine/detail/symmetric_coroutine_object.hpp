@@ -10,10 +10,13 @@
 #include <boost/assert.hpp>
 #include <boost/config.hpp>
 #include <boost/move/move.hpp>
+#include <boost/static_assert.hpp>
 
+#include <boost/coroutine/detail/allocate_stack.hpp>
 #include <boost/coroutine/detail/config.hpp>
 #include <boost/coroutine/detail/flags.hpp>
 #include <boost/coroutine/detail/preallocated.hpp>
+#include <boost/coroutine/detail/stack_capacity.hpp>
 #include <boost/coroutine/detail/symmetric_coroutine_impl.hpp>
 #include <boost/coroutine/detail/symmetric_coroutine_yield.hpp>
 #include <boost/coroutine/exceptions.hpp>
@@ -37,13 +40,20 @@ private:
     typedef symmetric_coroutine_impl< R >                       impl_t;
     typedef symmetric_coroutine_object< R, Fn, StackAllocator > obj_t;
 
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+    // the members accessed by a context switch fit into one cache line
+    BOOST_STATIC_ASSERT( sizeof( impl_t) - impl_t::hot_offset
+                         - sizeof( coroutine_stack_context) + sizeof( coroutine_context)
+                         <= BOOST_COROUTINES_CACHELINE_SIZE);
+#endif
+
     Fn                  fn_;
-    stack_context       stack_ctx_;
     StackAllocator      stack_alloc_;
 
     static void deallocate_( obj_t * obj)
     {
-        stack_context stack_ctx( obj->stack_ctx_);
+        check_stack_capacity< obj_t, StackAllocator >();
+        stack_context stack_ctx( obj->callee_.stack_ctx() );
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
         obj->~obj_t();
@@ -55,10 +65,10 @@ public:
     symmetric_coroutine_object( Fn fn, attributes const& attrs,
                                 preallocated const& palloc,
                                 StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        impl_t( palloc,
-                stack_unwind == attrs.do_unwind),
+        impl_t( with_shared_stack< StackAllocator >( palloc),
+                stack_unwind == attrs.do_unwind,
+                attrs.preserve_fpu),
         fn_( fn),
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
     {}
 #endif
@@ -66,14 +76,14 @@ public:
     symmetric_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
                                 preallocated const& palloc,
                                 StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        impl_t( palloc,
-                stack_unwind == attrs.do_unwind),
+        impl_t( with_shared_stack< StackAllocator >( palloc),
+                stack_unwind == attrs.do_unwind,
+                attrs.preserve_fpu),
 #ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
         fn_( fn),
 #else
         fn_( boost::forward< Fn >( fn) ),
 #endif
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
     {}
 
@@ -85,7 +95,7 @@ public:
         impl_t::flags_ |= flag_running;
         try
         {
-            symmetric_coroutine_yield< R > yc( this, r);
+            symmetric_coroutine_yield< R > yc( this, impl_t::callee_.passed( r) );
             fn_( yc);
         }
         catch ( forced_unwind const&)
@@ -104,6 +114,18 @@ public:
 
     void destroy()
     { deallocate_( this); }
+
+    bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id)
+    {
+        // a shared stack is not owned by the coroutine
+        if ( allocator_id< StackAllocator >() != alloc_id || shared_stack_of< StackAllocator >::value)
+            return false;
+        sctx = this->callee_.stack_ctx();
+        * static_cast< StackAllocator * >( stack_alloc) = stack_alloc_;
+        this->unwind_stack();
+        this->~obj_t();
+        return true;
+    }
 };
 
 template< typename R, typename Fn, typename StackAllocator >
@@ -113,13 +135,20 @@ private:
     typedef symmetric_coroutine_impl< R & >                         impl_t;
     typedef symmetric_coroutine_object< R &, Fn, StackAllocator >   obj_t;
 
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+    // the members accessed by a context switch fit into one cache line
+    BOOST_STATIC_ASSERT( sizeof( impl_t) - impl_t::hot_offset
+                         - sizeof( coroutine_stack_context) + sizeof( coroutine_context)
+                         <= BOOST_COROUTINES_CACHELINE_SIZE);
+#endif
+
     Fn                  fn_;
-    stack_context       stack_ctx_;
     StackAllocator      stack_alloc_;
 
     static void deallocate_( obj_t * obj)
     {
-        stack_context stack_ctx( obj->stack_ctx_);
+        check_stack_capacity< obj_t, StackAllocator >();
+        stack_context stack_ctx( obj->callee_.stack_ctx() );
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
         obj->~obj_t();
@@ -131,10 +160,10 @@ public:
     symmetric_coroutine_object( Fn fn, attributes const& attrs,
                                 preallocated const& palloc,
                                 StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        impl_t( palloc,
-                stack_unwind == attrs.do_unwind),
+        impl_t( with_shared_stack< StackAllocator >( palloc),
+                stack_unwind == attrs.do_unwind,
+                attrs.preserve_fpu),
         fn_( fn),
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
     {}
 #endif
@@ -142,14 +171,14 @@ public:
     symmetric_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
                                 preallocated const& palloc,
                                 StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        impl_t( palloc,
-                stack_unwind == attrs.do_unwind),
+        impl_t( with_shared_stack< StackAllocator >( palloc),
+                stack_unwind == attrs.do_unwind,
+                attrs.preserve_fpu),
 #ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
         fn_( fn),
 #else
         fn_( boost::forward< Fn >( fn) ),
 #endif
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
     {}
 
@@ -161,7 +190,7 @@ public:
         impl_t::flags_ |= flag_running;
         try
         {
-            symmetric_coroutine_yield< R & > yc( this, r);
+            symmetric_coroutine_yield< R & > yc( this, impl_t::callee_.passed( r) );
             fn_( yc);
         }
         catch ( forced_unwind const&)
@@ -180,6 +209,18 @@ public:
 
     void destroy()
     { deallocate_( this); }
+
+    bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id)
+    {
+        // a shared stack is not owned by the coroutine
+        if ( allocator_id< StackAllocator >() != alloc_id || shared_stack_of< StackAllocator >::value)
+            return false;
+        sctx = this->callee_.stack_ctx();
+        * static_cast< StackAllocator * >( stack_alloc) = stack_alloc_;
+        this->unwind_stack();
+        this->~obj_t();
+        return true;
+    }
 };
 
 template< typename Fn, typename StackAllocator >
@@ -189,13 +230,20 @@ private:
     typedef symmetric_coroutine_impl< void >                        impl_t;
     typedef symmetric_coroutine_object< void, Fn, StackAllocator >  obj_t;
 
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+    // the members accessed by a context switch fit into one cache line
+    BOOST_STATIC_ASSERT( sizeof( impl_t) - impl_t::hot_offset
+                         - sizeof( coroutine_stack_context) + sizeof( coroutine_context)
+                         <= BOOST_COROUTINES_CACHELINE_SIZE);
+#endif
+
     Fn                  fn_;
-    stack_context       stack_ctx_;
     StackAllocator      stack_alloc_;
 
     static void deallocate_( obj_t * obj)
     {
-        stack_context stack_ctx( obj->stack_ctx_);
+        check_stack_capacity< obj_t, StackAllocator >();
+        stack_context stack_ctx( obj->callee_.stack_ctx() );
         StackAllocator stack_alloc( obj->stack_alloc_);
         obj->unwind_stack();
         obj->~obj_t();
@@ -207,10 +255,10 @@ public:
     symmetric_coroutine_object( Fn fn, attributes const& attrs,
                                 preallocated const& palloc,
                                 StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        impl_t( palloc,
-                stack_unwind == attrs.do_unwind),
+        impl_t( with_shared_stack< StackAllocator >( palloc),
+                stack_unwind == attrs.do_unwind,
+                attrs.preserve_fpu),
         fn_( fn),
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
     {}
 #endif
@@ -218,14 +266,14 @@ public:
     symmetric_coroutine_object( BOOST_RV_REF( Fn) fn, attributes const& attrs,
                                 preallocated const& palloc,
                                 StackAllocator const& stack_alloc) BOOST_NOEXCEPT :
-        impl_t( palloc,
-                stack_unwind == attrs.do_unwind),
+        impl_t( with_shared_stack< StackAllocator >( palloc),
+                stack_unwind == attrs.do_unwind,
+                attrs.preserve_fpu),
 #ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
         fn_( fn),
 #else
         fn_( boost::forward< Fn >( fn) ),
 #endif
-        stack_ctx_( palloc.sctx),
         stack_alloc_( stack_alloc)
     {}
 
@@ -256,6 +304,18 @@ public:
 
     void destroy()
     { deallocate_( this); }
+
+    bool recycle( stack_context & sctx, void * stack_alloc, std::size_t alloc_id)
+    {
+        // a shared stack is not owned by the coroutine
+        if ( allocator_id< StackAllocator >() != alloc_id || shared_stack_of< StackAllocator >::value)
+            return false;
+        sctx = this->callee_.stack_ctx();
+        * static_cast< StackAllocator * >( stack_alloc) = stack_alloc_;
+        this->unwind_stack();
+        this->~obj_t();
+        return true;
+    }
 };
 
 }}}
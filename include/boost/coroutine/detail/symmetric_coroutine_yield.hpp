@@ -87,8 +87,38 @@ public:
         return * this;
     }
 
+    // passes a copy of `x`, or `x` itself if `other` takes references
     template< typename Coro >
-    symmetric_coroutine_yield & operator()( Coro & other, typename Coro::value_type x,
+    symmetric_coroutine_yield & operator()( Coro & other, typename Coro::value_type & x,
+                                            typename disable_if<
+                                                is_same< typename Coro::value_type, void >,
+                                                dummy*
+                                            >::type = 0)
+    {
+        BOOST_ASSERT( other);
+
+        result_ = impl_->yield_to_copy( other.impl_, x);
+        return * this;
+    }
+
+    // passes a copy of `x`
+    template< typename Coro >
+    symmetric_coroutine_yield & operator()( Coro & other, typename Coro::value_type const& x,
+                                            typename disable_if<
+                                                is_same< typename Coro::value_type, void >,
+                                                dummy*
+                                            >::type = 0)
+    {
+        BOOST_ASSERT( other);
+
+        result_ = impl_->yield_to_copy( other.impl_, x);
+        return * this;
+    }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    // passes `x` without a copy, `other` may move it out
+    template< typename Coro >
+    symmetric_coroutine_yield & operator()( Coro & other, typename Coro::value_type && x,
                                             typename disable_if<
                                                 is_same< typename Coro::value_type, void >,
                                                 dummy*
@@ -99,6 +129,7 @@ public:
         result_ = impl_->yield_to( other.impl_, x);
         return * this;
     }
+#endif
 
     template< typename Coro >
     symmetric_coroutine_yield & operator()( Coro & other,
@@ -121,6 +152,17 @@ public:
 
         return * result_; 
     }
+
+    // the value is owned by the resuming side until the next context
+    // switch, it is moved out instead of copied
+    R take()
+    {
+        if ( 0 == result_)
+            boost::throw_exception(
+                invalid_result() );
+
+        return boost::move( * result_);
+    }
 };
 
 template< typename R >
@@ -182,6 +224,7 @@ public:
         return * this;
     }
 
+    // passes a copy of `x`, or `x` itself if `other` takes references
     template< typename Coro >
     symmetric_coroutine_yield & operator()( Coro & other, typename Coro::value_type & x,
                                             typename disable_if<
@@ -191,9 +234,39 @@ public:
     {
         BOOST_ASSERT( other);
 
+        result_ = impl_->yield_to_copy( other.impl_, x);
+        return * this;
+    }
+
+    // passes a copy of `x`
+    template< typename Coro >
+    symmetric_coroutine_yield & operator()( Coro & other, typename Coro::value_type const& x,
+                                            typename disable_if<
+                                                is_same< typename Coro::value_type, void >,
+                                                dummy*
+                                            >::type = 0)
+    {
+        BOOST_ASSERT( other);
+
+        result_ = impl_->yield_to_copy( other.impl_, x);
+        return * this;
+    }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    // passes `x` without a copy, `other` may move it out
+    template< typename Coro >
+    symmetric_coroutine_yield & operator()( Coro & other, typename Coro::value_type && x,
+                                            typename disable_if<
+                                                is_same< typename Coro::value_type, void >,
+                                                dummy*
+                                            >::type = 0)
+    {
+        BOOST_ASSERT( other);
+
         result_ = impl_->yield_to( other.impl_, x);
         return * this;
     }
+#endif
 
     template< typename Coro >
     symmetric_coroutine_yield & operator()( Coro & other,
@@ -267,6 +340,7 @@ public:
         return * this;
     }
 
+    // passes a copy of `x`, or `x` itself if `other` takes references
     template< typename Coro >
     symmetric_coroutine_yield & operator()( Coro & other, typename Coro::value_type & x,
                                             typename disable_if<
@@ -276,9 +350,39 @@ public:
     {
         BOOST_ASSERT( other);
 
+        impl_->yield_to_copy( other.impl_, x);
+        return * this;
+    }
+
+    // passes a copy of `x`
+    template< typename Coro >
+    symmetric_coroutine_yield & operator()( Coro & other, typename Coro::value_type const& x,
+                                            typename disable_if<
+                                                is_same< typename Coro::value_type, void >,
+                                                dummy*
+                                            >::type = 0)
+    {
+        BOOST_ASSERT( other);
+
+        impl_->yield_to_copy( other.impl_, x);
+        return * this;
+    }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    // passes `x` without a copy, `other` may move it out
+    template< typename Coro >
+    symmetric_coroutine_yield & operator()( Coro & other, typename Coro::value_type && x,
+                                            typename disable_if<
+                                                is_same< typename Coro::value_type, void >,
+                                                dummy*
+                                            >::type = 0)
+    {
+        BOOST_ASSERT( other);
+
         impl_->yield_to( other.impl_, x);
         return * this;
     }
+#endif
 
     template< typename Coro >
     symmetric_coroutine_yield & operator()( Coro & other,
@@ -29,7 +29,7 @@ void trampoline_pull( context::detail::transfer_t t)
     typedef typename Coro::param_type   param_type;
 
     data_t * data = static_cast< data_t * >( t.data);
-    data->from->ctx_ = t.fctx;
+    data->from->suspended_( t.fctx);
     param_type * param(
         static_cast< param_type * >( data->data) );
     BOOST_ASSERT( 0 != param);
@@ -0,0 +1,36 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_DETAIL_WINDOWS_H
+#define BOOST_COROUTINES_DETAIL_WINDOWS_H
+
+// includes <windows.h> for the implementation files included by the headers
+// (BOOST_COROUTINES_HEADER_ONLY) without the rarely used APIs and without the
+// macros min() and max(), the macros are not left defined
+
+#if ! defined(WIN32_LEAN_AND_MEAN)
+# define WIN32_LEAN_AND_MEAN
+# define BOOST_COROUTINES_UNDEF_WIN32_LEAN_AND_MEAN
+#endif
+#if ! defined(NOMINMAX)
+# define NOMINMAX
+# define BOOST_COROUTINES_UNDEF_NOMINMAX
+#endif
+
+extern "C" {
+#include <windows.h>
+}
+
+#if defined(BOOST_COROUTINES_UNDEF_WIN32_LEAN_AND_MEAN)
+# undef WIN32_LEAN_AND_MEAN
+# undef BOOST_COROUTINES_UNDEF_WIN32_LEAN_AND_MEAN
+#endif
+#if defined(BOOST_COROUTINES_UNDEF_NOMINMAX)
+# undef NOMINMAX
+# undef BOOST_COROUTINES_UNDEF_NOMINMAX
+#endif
+
+#endif // BOOST_COROUTINES_DETAIL_WINDOWS_H
@@ -32,7 +32,8 @@ struct forced_unwind {};
 
 BOOST_SCOPED_ENUM_DECLARE_BEGIN(coroutine_errc)
 {
-  no_data = 1
+  no_data = 1,
+  shared_stack_occupied
 }
 BOOST_SCOPED_ENUM_DECLARE_END(coroutine_errc)
 
@@ -100,4 +101,8 @@ public:
 #  include BOOST_ABI_SUFFIX
 #endif
 
+#if defined(BOOST_COROUTINES_HEADER_ONLY)
+# include <boost/coroutine/detail/impl/exceptions.ipp>
+#endif
+
 #endif // BOOST_COROUTINES_EXCEPTIONS_H
@@ -0,0 +1,132 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_FIXED_STACK_H
+#define BOOST_COROUTINES_FIXED_STACK_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/utility.hpp>
+
+#if defined(BOOST_USE_SEGMENTED_STACKS)
+# error "fixed_stack does not support segmented stacks"
+#endif
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/stack_capacity.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+template< std::size_t N >
+class fixed_stack;
+
+// hands out memory owned by the caller as stack, allocate() and
+// deallocate() never allocate or release memory
+// the stack size requested by the attributes is ignored; the memory must
+// be used by one coroutine at a time and must outlive it
+// the size of the control block of the coroutine is checked at compile
+// time against `N`, zero means unknown
+template< std::size_t N = 0 >
+class fixed_stack_allocator
+{
+private:
+    stack_context   sctx_;
+
+public:
+    explicit fixed_stack_allocator( fixed_stack< N > & stack) BOOST_NOEXCEPT :
+        sctx_( stack.context() )
+    {}
+
+    // `sctx.sp` is the top of the memory (stack grows downwards)
+    explicit fixed_stack_allocator( stack_context const& sctx) BOOST_NOEXCEPT :
+        sctx_( sctx)
+    { BOOST_ASSERT( N <= sctx_.size); }
+
+    // `size` bytes at `memory`, the top is aligned to 16 byte
+    fixed_stack_allocator( void * memory, std::size_t size) BOOST_NOEXCEPT :
+        sctx_()
+    {
+        BOOST_ASSERT( 0 != memory);
+        std::size_t top = reinterpret_cast< std::size_t >( memory) + size;
+        top &= ~static_cast< std::size_t >( 15);
+        sctx_.sp = reinterpret_cast< void * >( top);
+        sctx_.size = top - reinterpret_cast< std::size_t >( memory);
+        BOOST_ASSERT( N <= sctx_.size);
+    }
+
+    void allocate( stack_context & ctx, std::size_t = 0) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 != sctx_.sp);
+        ctx = sctx_;
+    }
+
+    void deallocate( stack_context & ctx) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( sctx_.sp == ctx.sp);
+        ctx.sp = 0;
+    }
+
+    stack_context const& context() const BOOST_NOEXCEPT
+    { return sctx_; }
+};
+
+// `N` bytes of stack stored inline, e.g. as member of the object owning
+// the coroutine
+template< std::size_t N >
+class fixed_stack : private noncopyable
+{
+private:
+    BOOST_STATIC_ASSERT_MSG( 0 < N && 0 == N % 16, "size must be a multiple of 16");
+
+    typename aligned_storage< N, 16 >::type     storage_;
+
+public:
+    enum { capacity = N };
+
+    fixed_stack() BOOST_NOEXCEPT :
+        storage_()
+    {}
+
+    void * data() BOOST_NOEXCEPT
+    { return storage_.address(); }
+
+    stack_context context() BOOST_NOEXCEPT
+    {
+        stack_context sctx;
+        sctx.sp = static_cast< char * >( data() ) + N;
+        sctx.size = N;
+        return sctx;
+    }
+
+    fixed_stack_allocator< N > allocator() BOOST_NOEXCEPT
+    { return fixed_stack_allocator< N >( * this); }
+};
+
+namespace detail {
+
+template< std::size_t N >
+struct stack_capacity< fixed_stack_allocator< N > >
+{ static const std::size_t value = N; };
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_FIXED_STACK_H
@@ -16,6 +16,18 @@ enum flag_unwind_t
     no_stack_unwind
 };
 
+enum flag_start_t
+{
+    start_eager = 0,
+    start_lazy
+};
+
+enum flag_fpu_t
+{
+    fpu_preserved = 0,
+    fpu_not_preserved
+};
+
 }}
 
 #endif // BOOST_COROUTINES_FLAGS_H
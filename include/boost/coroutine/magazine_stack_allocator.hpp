@@ -0,0 +1,216 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_MAGAZINE_STACK_ALLOCATOR_H
+#define BOOST_COROUTINES_MAGAZINE_STACK_ALLOCATOR_H
+
+#include <cstddef>
+#include <utility>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#if defined(BOOST_NO_CXX11_HDR_ATOMIC) || defined(BOOST_NO_CXX11_THREAD_LOCAL)
+# error "magazine_stack_allocator requires C++11 atomics and thread_local"
+#endif
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/magazine_depot.hpp>
+#include <boost/coroutine/protected_stack_allocator.hpp>
+#include <boost/coroutine/stack_context.hpp>
+#include <boost/coroutine/stack_traits.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// recycles guard-paged stacks across threads
+// each thread caches up to two magazines per size class (loaded and previous),
+// magazines are exchanged with a lock-free, process-wide depot only if both
+// are full (deallocate) or empty (allocate)
+// a size class holds stacks of a power of two pages
+template< typename traitsT >
+struct basic_magazine_stack_allocator
+{
+    typedef traitsT traits_type;
+
+private:
+    typedef basic_protected_stack_allocator< traitsT >  allocator_type;
+    typedef detail::magazine                            magazine;
+    typedef detail::magazine_depot                      depot_type;
+
+    struct thread_cache
+    {
+        magazine    *   loaded[depot_type::size_classes];
+        magazine    *   previous[depot_type::size_classes];
+
+        thread_cache() BOOST_NOEXCEPT
+        {
+            // construct the depot first, it must outlive this cache
+            depot();
+            for ( std::size_t i = 0; i < depot_type::size_classes; ++i)
+                loaded[i] = previous[i] = 0;
+        }
+
+        ~thread_cache()
+        { flush(); }
+
+        void flush() BOOST_NOEXCEPT
+        {
+            for ( std::size_t i = 0; i < depot_type::size_classes; ++i)
+            {
+                give_back( i, loaded[i]);
+                give_back( i, previous[i]);
+                loaded[i] = previous[i] = 0;
+            }
+        }
+
+        static void give_back( std::size_t size_class, magazine * m) BOOST_NOEXCEPT
+        {
+            if ( 0 == m) return;
+            if ( m->empty() ) depot().push_empty( m);
+            else depot().push_full( size_class, m);
+        }
+    };
+
+    static depot_type & depot() BOOST_NOEXCEPT
+    {
+        static depot_type instance;
+        return instance;
+    }
+
+    static thread_cache & cache() BOOST_NOEXCEPT
+    {
+        static thread_local thread_cache instance;
+        return instance;
+    }
+
+    // returns the size class of a stack of `pages` pages
+    static std::size_t size_class_( std::size_t pages) BOOST_NOEXCEPT
+    {
+        std::size_t idx = 0;
+        while ( ( static_cast< std::size_t >( 1) << idx) < pages) ++idx;
+        return idx;
+    }
+
+    static bool is_pooled_( std::size_t size) BOOST_NOEXCEPT
+    {
+        const std::size_t pages = size / traits_type::page_size();
+        return 0 == size % traits_type::page_size()
+            && 0 == ( pages & ( pages - 1) );
+    }
+
+public:
+    void allocate( stack_context & ctx, std::size_t size = traits_type::minimum_size() )
+    {
+        BOOST_ASSERT( traits_type::minimum_size() <= size);
+        BOOST_ASSERT( traits_type::is_unbounded() || ( traits_type::maximum_size() >= size) );
+
+        // round up to the size class, the guard page is part of the class
+        const std::size_t idx = size_class_(
+            ( size + traits_type::page_size() - 1) / traits_type::page_size() );
+        const std::size_t size_ =
+            ( static_cast< std::size_t >( 1) << idx) * traits_type::page_size();
+        if ( ! traits_type::is_unbounded() && traits_type::maximum_size() < size_)
+        {
+            // size class exceeds the stack limit -> not pooled
+            allocator_type().allocate( ctx, size);
+            return;
+        }
+
+        thread_cache & tc = cache();
+        if ( 0 == tc.loaded[idx] || tc.loaded[idx]->empty() )
+        {
+            if ( 0 != tc.previous[idx] && ! tc.previous[idx]->empty() )
+                std::swap( tc.loaded[idx], tc.previous[idx]);
+            else
+            {
+                magazine * m = depot().pop_full( idx);
+                if ( 0 == m)
+                {
+                    allocator_type().allocate( ctx, size_);
+                    BOOST_ASSERT( size_ == ctx.size);
+                    return;
+                }
+                // previous is empty or null
+                thread_cache::give_back( idx, tc.previous[idx]);
+                tc.previous[idx] = tc.loaded[idx];
+                tc.loaded[idx] = m;
+            }
+        }
+        ctx = tc.loaded[idx]->pop();
+    }
+
+    void deallocate( stack_context & ctx)
+    {
+        BOOST_ASSERT( ctx.sp);
+        BOOST_ASSERT( traits_type::minimum_size() <= ctx.size);
+        BOOST_ASSERT( traits_type::is_unbounded() || ( traits_type::maximum_size() >= ctx.size) );
+
+        if ( ! is_pooled_( ctx.size) )
+        {
+            allocator_type().deallocate( ctx);
+            return;
+        }
+
+        const std::size_t idx = size_class_( ctx.size / traits_type::page_size() );
+        thread_cache & tc = cache();
+        if ( 0 == tc.loaded[idx] || tc.loaded[idx]->full() )
+        {
+            if ( 0 != tc.previous[idx] && tc.previous[idx]->empty() )
+                std::swap( tc.loaded[idx], tc.previous[idx]);
+            else
+            {
+                magazine * m = depot().pop_empty();
+                if ( 0 == m)
+                {
+                    allocator_type().deallocate( ctx);
+                    return;
+                }
+                // previous is full (or partially filled) or null
+                thread_cache::give_back( idx, tc.previous[idx]);
+                tc.previous[idx] = tc.loaded[idx];
+                tc.loaded[idx] = m;
+            }
+        }
+        tc.loaded[idx]->push( ctx);
+    }
+
+    // returns the magazines of the calling thread to the depot and
+    // deallocates all stacks held by the depot
+    // stacks cached by other threads are not affected
+    static void release() BOOST_NOEXCEPT
+    {
+        cache().flush();
+        allocator_type allocator;
+        for ( std::size_t i = 0; i < depot_type::size_classes; ++i)
+        {
+            magazine * m = 0;
+            while ( 0 != ( m = depot().pop_full( i) ) )
+            {
+                while ( ! m->empty() )
+                {
+                    stack_context ctx = m->pop();
+                    allocator.deallocate( ctx);
+                }
+                depot().push_empty( m);
+            }
+        }
+    }
+};
+
+typedef basic_magazine_stack_allocator< stack_traits > magazine_stack_allocator;
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_MAGAZINE_STACK_ALLOCATOR_H
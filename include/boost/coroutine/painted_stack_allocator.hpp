@@ -0,0 +1,165 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_PAINTED_STACK_ALLOCATOR_H
+#define BOOST_COROUTINES_PAINTED_STACK_ALLOCATOR_H
+
+#include <cstddef>
+#include <ostream>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/utility.hpp>
+
+#if ! defined(BOOST_NO_CXX11_HDR_ATOMIC)
+# include <atomic>
+#endif
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/stack_painting.hpp>
+#include <boost/coroutine/stack_allocator.hpp>
+#include <boost/coroutine/stack_context.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// histogram of stack high-water marks, bucket `i` counts the stacks which
+// used [2^i, 2^(i+1)) bytes
+// the counters are atomic if C++11 atomics are available
+class stack_usage_histogram : private noncopyable
+{
+public:
+    enum { buckets = sizeof( std::size_t) * 8 };
+
+private:
+#if ! defined(BOOST_NO_CXX11_HDR_ATOMIC)
+    typedef std::atomic< std::size_t >  counter_type;
+#else
+    typedef std::size_t                 counter_type;
+#endif
+
+    counter_type    counts_[buckets];
+    counter_type    samples_;
+    counter_type    max_;
+
+    static std::size_t load_( counter_type const& c) BOOST_NOEXCEPT
+    { return c; }
+
+public:
+    stack_usage_histogram() BOOST_NOEXCEPT
+    { reset(); }
+
+    // the histogram used by painted_stack_allocator by default
+    static stack_usage_histogram & global()
+    {
+        static stack_usage_histogram instance;
+        return instance;
+    }
+
+    void record( std::size_t used) BOOST_NOEXCEPT
+    {
+        std::size_t idx = 0;
+        while ( idx + 1 < buckets && ( static_cast< std::size_t >( 2) << idx) <= used) ++idx;
+        ++counts_[idx];
+        ++samples_;
+#if ! defined(BOOST_NO_CXX11_HDR_ATOMIC)
+        std::size_t max = max_.load( std::memory_order_relaxed);
+        while ( max < used && ! max_.compare_exchange_weak( max, used, std::memory_order_relaxed) );
+#else
+        if ( max_ < used) max_ = used;
+#endif
+    }
+
+    void reset() BOOST_NOEXCEPT
+    {
+        for ( std::size_t i = 0; i < buckets; ++i) counts_[i] = 0;
+        samples_ = 0;
+        max_ = 0;
+    }
+
+    std::size_t count( std::size_t bucket) const BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( bucket < buckets);
+        return load_( counts_[bucket]);
+    }
+
+    std::size_t samples() const BOOST_NOEXCEPT
+    { return load_( samples_); }
+
+    // largest high-water mark recorded
+    std::size_t max() const BOOST_NOEXCEPT
+    { return load_( max_); }
+
+    // prints one line per non-empty bucket
+    void dump( std::ostream & os) const
+    {
+        os << "stack usage: " << samples() << " stacks, max " << max() << " bytes\n";
+        for ( std::size_t i = 0; i < buckets; ++i)
+        {
+            const std::size_t n = count( i);
+            if ( 0 == n) continue;
+            os << "  [" << ( static_cast< std::size_t >( 1) << i) << ", "
+               << ( static_cast< std::size_t >( 2) << i) << ") bytes: " << n << "\n";
+        }
+    }
+};
+
+// adaptor painting the stacks of `StackAllocator` with a pattern; the
+// high-water mark of a stack is recorded in a histogram at deallocation
+// the lowest page of a stack is not painted (guard page)
+template< typename StackAllocator = stack_allocator >
+class painted_stack_allocator
+{
+private:
+    StackAllocator              alloc_;
+    stack_usage_histogram   *   histogram_;
+
+public:
+    explicit painted_stack_allocator(
+            StackAllocator const& alloc = StackAllocator(),
+            stack_usage_histogram * histogram = & stack_usage_histogram::global() ) :
+        alloc_( alloc),
+        histogram_( histogram)
+    {}
+
+    void allocate( stack_context & ctx, std::size_t size)
+    {
+        alloc_.allocate( ctx, size);
+        detail::paint_stack( ctx);
+    }
+
+    void deallocate( stack_context & ctx)
+    {
+        if ( 0 != histogram_) histogram_->record( detail::painted_stack_usage( ctx) );
+        detail::unpaint_stack( ctx);
+        alloc_.deallocate( ctx);
+    }
+
+    StackAllocator & allocator() BOOST_NOEXCEPT
+    { return alloc_; }
+
+    stack_usage_histogram * histogram() const BOOST_NOEXCEPT
+    { return histogram_; }
+};
+
+// high-water mark of a stack allocated by painted_stack_allocator, 0 if the
+// stack was not painted
+inline
+std::size_t stack_high_water_mark( stack_context const& ctx) BOOST_NOEXCEPT
+{ return detail::painted_stack_usage( ctx); }
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_PAINTED_STACK_ALLOCATOR_H
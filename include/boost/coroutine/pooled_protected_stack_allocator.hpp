@@ -0,0 +1,229 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_POOLED_PROTECTED_STACK_ALLOCATOR_H
+#define BOOST_COROUTINES_POOLED_PROTECTED_STACK_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/protected_stack_allocator.hpp>
+#include <boost/coroutine/stack_context.hpp>
+#include <boost/coroutine/stack_traits.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// keeps released stacks (guard page included) on free-lists, one free-list
+// per size class; the size classes are 1, 2, 3 and 4 pages and grow by a
+// quarter of the next lower power of two above (5, 6, 7, 8, 10, 12, 14, 16,
+// 20, ... pages), e.g. a stack is rounded up by less than 25%
+// the pool is shared by all copies of the allocator and is not synchronized,
+// e.g. all copies must be used by one thread at a time
+template< typename traitsT >
+class basic_pooled_protected_stack_allocator
+{
+public:
+    typedef traitsT traits_type;
+
+private:
+    typedef basic_protected_stack_allocator< traitsT >  allocator_type;
+
+    // the link of a cached stack is stored at the top of the stack itself
+    struct node
+    {
+        node            *   next;
+        stack_context       sctx;
+    };
+
+    enum { size_classes = 4 * sizeof( std::size_t) * 8 };
+
+    struct storage
+    {
+        std::size_t     use_count;
+        std::size_t     max_cached;
+        std::size_t     cached;
+        std::size_t     hits;
+        std::size_t     misses;
+        node        *   free_list[size_classes];
+
+        explicit storage( std::size_t max_cached_) BOOST_NOEXCEPT :
+            use_count( 1),
+            max_cached( max_cached_),
+            cached( 0),
+            hits( 0),
+            misses( 0)
+        {
+            for ( std::size_t i = 0; i < size_classes; ++i)
+                free_list[i] = 0;
+        }
+
+        void release() BOOST_NOEXCEPT
+        {
+            allocator_type allocator;
+            for ( std::size_t i = 0; i < size_classes; ++i)
+            {
+                while ( 0 != free_list[i])
+                {
+                    node * n = free_list[i];
+                    free_list[i] = n->next;
+                    stack_context sctx( n->sctx);
+                    cached -= sctx.size;
+                    allocator.deallocate( sctx);
+                }
+            }
+            BOOST_ASSERT( 0 == cached);
+        }
+    };
+
+    storage     *   storage_;
+
+    // returns the smallest size class holding a stack of `pages` pages
+    static std::size_t size_class_( std::size_t pages) BOOST_NOEXCEPT
+    {
+        BOOST_ASSERT( 0 < pages);
+        if ( pages <= 4) return pages - 1;
+        // 4 << shift < pages <= 8 << shift
+        std::size_t shift = 0;
+        while ( ( static_cast< std::size_t >( 8) << shift) < pages) ++shift;
+        const std::size_t step = static_cast< std::size_t >( 1) << shift;
+        return 4 * shift + ( pages + step - 1) / step - 1;
+    }
+
+    // returns the number of pages of the size class `idx`
+    static std::size_t class_pages_( std::size_t idx) BOOST_NOEXCEPT
+    {
+        if ( idx < 4) return idx + 1;
+        return ( 5 + ( idx - 4) % 4) << ( ( idx - 4) / 4);
+    }
+
+    static bool is_pooled_( std::size_t size) BOOST_NOEXCEPT
+    {
+        const std::size_t pages = size / traits_type::page_size();
+        return 0 == size % traits_type::page_size() && 0 != pages
+            && pages == class_pages_( size_class_( pages) );
+    }
+
+public:
+    explicit basic_pooled_protected_stack_allocator(
+            std::size_t max_cached_bytes = 64 * traits_type::default_size() ) :
+        storage_( new storage( max_cached_bytes) )
+    {}
+
+    basic_pooled_protected_stack_allocator( basic_pooled_protected_stack_allocator const& other) BOOST_NOEXCEPT :
+        storage_( other.storage_)
+    { ++storage_->use_count; }
+
+    basic_pooled_protected_stack_allocator &
+    operator=( basic_pooled_protected_stack_allocator const& other) BOOST_NOEXCEPT
+    {
+        if ( storage_ == other.storage_) return * this;
+
+        ++other.storage_->use_count;
+        this->~basic_pooled_protected_stack_allocator();
+        storage_ = other.storage_;
+        return * this;
+    }
+
+    ~basic_pooled_protected_stack_allocator()
+    {
+        if ( 0 == --storage_->use_count)
+        {
+            storage_->release();
+            delete storage_;
+        }
+    }
+
+    void allocate( stack_context & ctx, std::size_t size = traits_type::minimum_size() )
+    {
+        BOOST_ASSERT( traits_type::minimum_size() <= size);
+        BOOST_ASSERT( traits_type::is_unbounded() || ( traits_type::maximum_size() >= size) );
+
+        // round up to the size class, the guard page is part of the class
+        const std::size_t idx = size_class_(
+            ( size + traits_type::page_size() - 1) / traits_type::page_size() );
+        const std::size_t size_ = class_pages_( idx) * traits_type::page_size();
+        if ( ! traits_type::is_unbounded() && traits_type::maximum_size() < size_)
+        {
+            // size class exceeds the stack limit -> not pooled
+            ++storage_->misses;
+            allocator_type().allocate( ctx, size);
+            return;
+        }
+
+        node * n = storage_->free_list[idx];
+        if ( 0 != n)
+        {
+            ++storage_->hits;
+            storage_->free_list[idx] = n->next;
+            ctx = n->sctx;
+            storage_->cached -= ctx.size;
+            return;
+        }
+
+        ++storage_->misses;
+        allocator_type().allocate( ctx, size_);
+        BOOST_ASSERT( size_ == ctx.size);
+    }
+
+    void deallocate( stack_context & ctx)
+    {
+        BOOST_ASSERT( ctx.sp);
+        BOOST_ASSERT( traits_type::minimum_size() <= ctx.size);
+        BOOST_ASSERT( traits_type::is_unbounded() || ( traits_type::maximum_size() >= ctx.size) );
+
+        if ( ! is_pooled_( ctx.size) ||
+             storage_->max_cached < storage_->cached + ctx.size)
+        {
+            allocator_type().deallocate( ctx);
+            return;
+        }
+
+        node * n = reinterpret_cast< node * >(
+            static_cast< char * >( ctx.sp) - sizeof( node) );
+        n->sctx = ctx;
+        const std::size_t idx = size_class_( ctx.size / traits_type::page_size() );
+        n->next = storage_->free_list[idx];
+        storage_->free_list[idx] = n;
+        storage_->cached += ctx.size;
+    }
+
+    // unmaps all cached stacks
+    void release() BOOST_NOEXCEPT
+    { storage_->release(); }
+
+    // number of allocations served from the pool
+    std::size_t hits() const BOOST_NOEXCEPT
+    { return storage_->hits; }
+
+    // number of allocations which required a new mapping
+    std::size_t misses() const BOOST_NOEXCEPT
+    { return storage_->misses; }
+
+    std::size_t cached_bytes() const BOOST_NOEXCEPT
+    { return storage_->cached; }
+
+    std::size_t max_cached_bytes() const BOOST_NOEXCEPT
+    { return storage_->max_cached; }
+};
+
+typedef basic_pooled_protected_stack_allocator< stack_traits > pooled_protected_stack_allocator;
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_POOLED_PROTECTED_STACK_ALLOCATOR_H
@@ -0,0 +1,173 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_POSIX_NUMA_STACK_ALLOCATOR_H
+#define BOOST_COROUTINES_POSIX_NUMA_STACK_ALLOCATOR_H
+
+#if defined(__linux__)
+extern "C" {
+#include <sys/syscall.h>
+#include <unistd.h>
+}
+#endif
+
+#include <cstddef>
+#include <cstdio>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/protected_stack_allocator.hpp>
+#include <boost/coroutine/stack_context.hpp>
+#include <boost/coroutine/stack_traits.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// guard-paged stacks placed on a NUMA node (mbind(2) with MPOL_PREFERRED,
+// called through syscall(2), libnuma is not required); the control block of
+// a coroutine lives at the top of its stack and is placed too
+// the node is `attributes::node` or, if -1, the node passed to the
+// constructor; -1 stands for the node of the thread allocating the stack
+// on machines with one node (and on systems other than Linux) the stacks are
+// not bound
+template< typename traitsT >
+class basic_numa_stack_allocator
+{
+public:
+    typedef traitsT traits_type;
+
+    // coroutines pass the attributes (and node) to allocate()
+    typedef void uses_attributes;
+
+private:
+    typedef basic_protected_stack_allocator< traitsT >  allocator_type;
+
+    // memory policy constants of <linux/mempolicy.h>
+    enum
+    {
+        mpol_preferred = 1,
+        mpol_f_node = 1,
+        mpol_f_addr = 2,
+        max_nodes = 1024
+    };
+
+    int     node_;
+
+    static std::size_t read_node_count_() BOOST_NOEXCEPT
+    {
+        // highest node in the list of possible nodes, e.g. "0-3"
+        std::FILE * f = std::fopen("/sys/devices/system/node/possible", "r");
+        if ( 0 == f) return 1;
+        int c = 0, n = 0, highest = 0;
+        while ( EOF != ( c = std::fgetc( f) ) )
+        {
+            if ( '0' <= c && '9' >= c) n = n * 10 + ( c - '0');
+            else
+            {
+                if ( highest < n) highest = n;
+                n = 0;
+            }
+        }
+        if ( highest < n) highest = n;
+        std::fclose( f);
+        return static_cast< std::size_t >( highest) + 1;
+    }
+
+    static void bind_( stack_context const& ctx, int node) BOOST_NOEXCEPT
+    {
+#if defined(__linux__) && defined(SYS_mbind)
+        if ( 2 > node_count() ) return;
+        if ( 0 > node) node = current_node();
+        if ( 0 > node || max_nodes <= node) return;
+        const std::size_t bits = 8 * sizeof( unsigned long);
+        unsigned long mask[max_nodes / ( 8 * sizeof( unsigned long) )] = { 0 };
+        mask[node / bits] |= 1UL << ( node % bits);
+        // the lowest page is the guard page
+        char * limit = static_cast< char * >( ctx.sp) - ctx.size + traits_type::page_size();
+        // best effort, the stack stays unbound if the call fails
+        ::syscall( SYS_mbind, limit, ctx.size - traits_type::page_size(),
+                   static_cast< int >( mpol_preferred), mask,
+                   static_cast< unsigned long >( max_nodes + 1), 0U);
+#else
+        ( void) ctx;
+        ( void) node;
+#endif
+    }
+
+public:
+    explicit basic_numa_stack_allocator( int node = -1) BOOST_NOEXCEPT :
+        node_( node)
+    {}
+
+    void allocate( stack_context & ctx, attributes const& attrs)
+    {
+        allocator_type().allocate( ctx, attrs.size);
+        bind_( ctx, -1 != attrs.node ? attrs.node : node_);
+    }
+
+    void allocate( stack_context & ctx, std::size_t size = traits_type::minimum_size() )
+    {
+        allocator_type().allocate( ctx, size);
+        bind_( ctx, node_);
+    }
+
+    void deallocate( stack_context & ctx)
+    { allocator_type().deallocate( ctx); }
+
+    int node() const BOOST_NOEXCEPT
+    { return node_; }
+
+    // number of possible NUMA nodes, 1 if unknown
+    static std::size_t node_count() BOOST_NOEXCEPT
+    {
+        static const std::size_t count = read_node_count_();
+        return count;
+    }
+
+    // NUMA node of the calling thread, 0 if unknown
+    static int current_node() BOOST_NOEXCEPT
+    {
+#if defined(__linux__) && defined(SYS_getcpu)
+        unsigned cpu = 0, node = 0;
+        if ( 0 == ::syscall( SYS_getcpu, & cpu, & node, 0) )
+            return static_cast< int >( node);
+#endif
+        return 0;
+    }
+
+    // NUMA node of the page holding `addr` (faulted in if not resident),
+    // -1 if unknown
+    static int node_of( void const* addr) BOOST_NOEXCEPT
+    {
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+        int node = -1;
+        if ( 0 == ::syscall( SYS_get_mempolicy, & node, 0, 0UL, addr,
+                             static_cast< unsigned long >( mpol_f_node | mpol_f_addr) ) )
+            return node;
+        return -1;
+#else
+        ( void) addr;
+        return -1;
+#endif
+    }
+};
+
+typedef basic_numa_stack_allocator< stack_traits > numa_stack_allocator;
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_POSIX_NUMA_STACK_ALLOCATOR_H
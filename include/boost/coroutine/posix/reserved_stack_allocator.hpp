@@ -0,0 +1,315 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_POSIX_RESERVED_STACK_ALLOCATOR_H
+#define BOOST_COROUTINES_POSIX_RESERVED_STACK_ALLOCATOR_H
+
+extern "C" {
+#include <sys/mman.h>
+#include <unistd.h>
+}
+
+#if defined(BOOST_USE_VALGRIND)
+#include <valgrind/valgrind.h>
+#endif
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/stack_context.hpp>
+#include <boost/coroutine/stack_traits.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// reserves a large address range per stack (MAP_NORESERVE) and relies on
+// demand paging, only touched pages are backed by physical memory
+// released stacks are cached; all pages below the hot window at the top of
+// the stack are handed back to the kernel (MADV_FREE or MADV_DONTNEED)
+// the bookkeeping is shared by all copies of the allocator and is not
+// synchronized, e.g. all copies must be used by one thread at a time
+template< typename traitsT >
+class basic_reserved_stack_allocator
+{
+public:
+    typedef traitsT traits_type;
+
+    enum reclaim_mode
+    {
+        // pages are reclaimed if the system runs short of memory (MADV_FREE)
+        reclaim_lazy,
+        // pages are reclaimed immediately (MADV_DONTNEED)
+        reclaim_eager
+    };
+
+private:
+    // stored at the top of the reservation, above the stack
+    struct node
+    {
+        node            *   prev;
+        node            *   next;
+        std::size_t         size;
+#if defined(BOOST_USE_VALGRIND)
+        unsigned            valgrind_stack_id;
+#endif
+    };
+
+    enum { header_size = ( ( sizeof( node) + 63) / 64) * 64 };
+
+    struct storage
+    {
+        std::size_t     use_count;
+        std::size_t     reserve_size;
+        std::size_t     hot_size;
+        std::size_t     max_cached;
+        reclaim_mode    mode;
+        node            live;
+        node            cached;
+        std::size_t     cached_count;
+
+        storage( std::size_t reserve_size_, std::size_t hot_size_,
+                 std::size_t max_cached_, reclaim_mode mode_) BOOST_NOEXCEPT :
+            use_count( 1),
+            reserve_size( reserve_size_),
+            hot_size( hot_size_),
+            max_cached( max_cached_),
+            mode( mode_),
+            live(),
+            cached(),
+            cached_count( 0)
+        {
+            live.prev = live.next = & live;
+            cached.prev = cached.next = & cached;
+        }
+    };
+
+    storage     *   storage_;
+
+    static std::size_t round_up_( std::size_t size) BOOST_NOEXCEPT
+    {
+        return ( ( size + traits_type::page_size() - 1) / traits_type::page_size() )
+            * traits_type::page_size();
+    }
+
+    static void link_( node & head, node * n) BOOST_NOEXCEPT
+    {
+        n->prev = & head;
+        n->next = head.next;
+        head.next->prev = n;
+        head.next = n;
+    }
+
+    static void unlink_( node * n) BOOST_NOEXCEPT
+    {
+        n->prev->next = n->next;
+        n->next->prev = n->prev;
+    }
+
+    static char * limit_( node * n) BOOST_NOEXCEPT
+    { return reinterpret_cast< char * >( n) + header_size - n->size; }
+
+    static void unmap_( node * n) BOOST_NOEXCEPT
+    {
+#if defined(BOOST_USE_VALGRIND)
+        VALGRIND_STACK_DEREGISTER( n->valgrind_stack_id);
+#endif
+        ::munmap( limit_( n), n->size);
+    }
+
+    // hands back the pages between the guard page and the hot window
+    void trim_( node * n) const BOOST_NOEXCEPT
+    {
+        char * first = limit_( n) + traits_type::page_size();
+        char * last = reinterpret_cast< char * >( n) + header_size - round_up_( storage_->hot_size + header_size);
+        if ( last <= first) return;
+#if defined(MADV_FREE)
+        if ( reclaim_lazy == storage_->mode &&
+             0 == ::madvise( first, last - first, MADV_FREE) )
+            return;
+#endif
+        ::madvise( first, last - first, MADV_DONTNEED);
+    }
+
+    static void release_( storage * s) BOOST_NOEXCEPT
+    {
+        while ( s->cached.next != & s->cached)
+        {
+            node * n = s->cached.next;
+            unlink_( n);
+            unmap_( n);
+        }
+        s->cached_count = 0;
+    }
+
+public:
+    explicit basic_reserved_stack_allocator(
+            std::size_t reserve_size = 1024 * 1024,
+            std::size_t hot_size = 4 * traits_type::page_size(),
+            std::size_t max_cached = 64,
+            reclaim_mode mode = reclaim_lazy) :
+        storage_( new storage( round_up_( reserve_size), hot_size, max_cached, mode) )
+    {}
+
+    basic_reserved_stack_allocator( basic_reserved_stack_allocator const& other) BOOST_NOEXCEPT :
+        storage_( other.storage_)
+    { ++storage_->use_count; }
+
+    basic_reserved_stack_allocator &
+    operator=( basic_reserved_stack_allocator const& other) BOOST_NOEXCEPT
+    {
+        if ( storage_ == other.storage_) return * this;
+
+        ++other.storage_->use_count;
+        this->~basic_reserved_stack_allocator();
+        storage_ = other.storage_;
+        return * this;
+    }
+
+    ~basic_reserved_stack_allocator()
+    {
+        if ( 0 == --storage_->use_count)
+        {
+            // each coroutine holds a copy, no stack can be in use
+            BOOST_ASSERT( storage_->live.next == & storage_->live);
+            release_( storage_);
+            delete storage_;
+        }
+    }
+
+    // the reservation is at least `reserve_size` bytes, `size` is honoured
+    // if it is larger
+    void allocate( stack_context & ctx, std::size_t size = traits_type::minimum_size() )
+    {
+        BOOST_ASSERT( traits_type::minimum_size() <= size);
+        BOOST_ASSERT( traits_type::is_unbounded() || ( traits_type::maximum_size() >= size) );
+
+        std::size_t size_ = round_up_( size + header_size);
+        if ( size_ < storage_->reserve_size) size_ = storage_->reserve_size;
+
+        node * n = 0;
+        for ( node * i = storage_->cached.next; i != & storage_->cached; i = i->next)
+        {
+            if ( size_ == i->size)
+            {
+                n = i;
+                unlink_( n);
+                --storage_->cached_count;
+                break;
+            }
+        }
+        if ( 0 == n)
+        {
+#if defined(MAP_NORESERVE)
+            const int noreserve = MAP_NORESERVE;
+#else
+            const int noreserve = 0;
+#endif
+#if defined(MAP_ANON)
+            void * limit = ::mmap( 0, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON | noreserve, -1, 0);
+#else
+            void * limit = ::mmap( 0, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | noreserve, -1, 0);
+#endif
+            if ( MAP_FAILED == limit) throw std::bad_alloc();
+
+            // page at bottom will be used as guard-page
+            BOOST_VERIFY( 0 == ::mprotect( limit, traits_type::page_size(), PROT_NONE));
+
+            n = reinterpret_cast< node * >( static_cast< char * >( limit) + size_ - header_size);
+            n->size = size_;
+#if defined(BOOST_USE_VALGRIND)
+            n->valgrind_stack_id = VALGRIND_STACK_REGISTER( n, limit);
+#endif
+        }
+        link_( storage_->live, n);
+
+        ctx.size = size_ - header_size;
+        ctx.sp = n;
+#if defined(BOOST_USE_VALGRIND)
+        ctx.valgrind_stack_id = n->valgrind_stack_id;
+#endif
+    }
+
+    void deallocate( stack_context & ctx)
+    {
+        BOOST_ASSERT( ctx.sp);
+        BOOST_ASSERT( traits_type::minimum_size() <= ctx.size);
+        BOOST_ASSERT( traits_type::is_unbounded() || ( traits_type::maximum_size() >= ctx.size) );
+
+        node * n = static_cast< node * >( ctx.sp);
+        BOOST_ASSERT( n->size == ctx.size + header_size);
+        unlink_( n);
+        if ( storage_->max_cached <= storage_->cached_count)
+        {
+            unmap_( n);
+            return;
+        }
+        trim_( n);
+        link_( storage_->cached, n);
+        ++storage_->cached_count;
+    }
+
+    // unmaps all cached stacks
+    void release() BOOST_NOEXCEPT
+    { release_( storage_); }
+
+    // address space reserved by stacks in use and cached stacks
+    std::size_t reserved_bytes() const BOOST_NOEXCEPT
+    {
+        std::size_t size = 0;
+        for ( node * n = storage_->live.next; n != & storage_->live; n = n->next)
+            size += n->size;
+        for ( node * n = storage_->cached.next; n != & storage_->cached; n = n->next)
+            size += n->size;
+        return size;
+    }
+
+    // memory resident for stacks in use and cached stacks (mincore())
+    // pages released with MADV_FREE count until the kernel reclaims them
+    std::size_t committed_bytes() const
+    {
+        std::size_t size = 0;
+#if defined(__linux__)
+        std::vector< unsigned char > vec;
+#else
+        std::vector< char > vec;
+#endif
+        node * heads[2] = { & storage_->live, & storage_->cached };
+        for ( std::size_t h = 0; h < 2; ++h)
+        {
+            for ( node * n = heads[h]->next; n != heads[h]; n = n->next)
+            {
+                const std::size_t pages = n->size / traits_type::page_size();
+                vec.resize( pages);
+                if ( 0 != ::mincore( limit_( n), n->size, & vec[0]) ) continue;
+                for ( std::size_t i = 0; i < pages; ++i)
+                    if ( vec[i] & 1) size += traits_type::page_size();
+            }
+        }
+        return size;
+    }
+
+    std::size_t cached_count() const BOOST_NOEXCEPT
+    { return storage_->cached_count; }
+};
+
+typedef basic_reserved_stack_allocator< stack_traits > reserved_stack_allocator;
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_POSIX_RESERVED_STACK_ALLOCATOR_H
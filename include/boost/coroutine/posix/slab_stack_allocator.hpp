@@ -0,0 +1,417 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_POSIX_SLAB_STACK_ALLOCATOR_H
+#define BOOST_COROUTINES_POSIX_SLAB_STACK_ALLOCATOR_H
+
+extern "C" {
+#include <sys/mman.h>
+#include <unistd.h>
+}
+
+#if defined(BOOST_USE_VALGRIND)
+#include <valgrind/valgrind.h>
+#endif
+
+#include <cstddef>
+#include <cstdio>
+#include <new>
+#include <stdexcept>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/move/move.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/protected_stack_allocator.hpp>
+#include <boost/coroutine/stack_context.hpp>
+#include <boost/coroutine/stack_traits.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// carves stacks of fixed size out of large mappings (slabs)
+// a slot consists of an optional guard page followed by the stack
+// guard pages are installed by madvise( MADV_GUARD_INSTALL) (Linux 6.13),
+// which keeps the slab one VMA, and by mprotect() otherwise
+// slabs backed by huge pages have no guard pages, guard pages between the
+// slots would split the huge pages
+// free slots are kept on a free-list, slabs are unmapped if the last copy of
+// the allocator is destroyed
+// the bookkeeping is shared by all copies of the allocator and is not
+// synchronized, e.g. all copies must be used by one thread at a time
+template< typename traitsT >
+class basic_slab_stack_allocator
+{
+public:
+    typedef traitsT traits_type;
+
+    enum page_mode
+    {
+        normal_pages,
+        // madvise( MADV_HUGEPAGE), falls back to normal pages
+        transparent_huge_pages,
+        // mmap( MAP_HUGETLB), falls back to transparent huge pages
+        huge_pages
+    };
+
+private:
+    typedef basic_protected_stack_allocator< traitsT >  allocator_type;
+
+    // stored at the top of a free slot
+    struct node
+    {
+        node    *   next;
+    };
+
+    struct slab
+    {
+        slab        *   next;
+        void        *   addr;
+        std::size_t     size;
+
+        slab( slab * next_, void * addr_, std::size_t size_) BOOST_NOEXCEPT :
+            next( next_),
+            addr( addr_),
+            size( size_)
+        {}
+    };
+
+    struct storage
+    {
+        std::size_t     use_count;
+        std::size_t     stack_size;
+        std::size_t     slot_size;
+        std::size_t     slots_per_slab;
+        bool            guard;
+        page_mode       mode;
+        page_mode       backing;
+        slab        *   slabs;
+        node        *   free_list;
+        std::size_t     free_count;
+        std::size_t     slot_count;
+        bool            guard_regions;
+
+        storage( std::size_t stack_size_, std::size_t slots_per_slab_, bool guard_, page_mode mode_) BOOST_NOEXCEPT :
+            use_count( 1),
+            stack_size( stack_size_),
+            slot_size( stack_size_ + ( guard_ ? traits_type::page_size() : 0) ),
+            slots_per_slab( slots_per_slab_),
+            guard( guard_),
+            mode( mode_),
+            backing( mode_),
+            slabs( 0),
+            free_list( 0),
+            free_count( 0),
+            slot_count( 0),
+#if defined(__linux__)
+            guard_regions( true)
+#else
+            guard_regions( false)
+#endif
+        {}
+
+        ~storage()
+        {
+            while ( 0 != slabs)
+            {
+                slab * s = slabs;
+                slabs = s->next;
+                ::munmap( s->addr, s->size);
+                delete s;
+            }
+        }
+    };
+
+    storage     *   storage_;
+
+    static std::size_t round_up_( std::size_t size, std::size_t align = traits_type::page_size() ) BOOST_NOEXCEPT
+    { return ( ( size + align - 1) / align) * align; }
+
+    static void * map_( std::size_t size, int prot, int flags) BOOST_NOEXCEPT
+    {
+#if defined(MAP_ANON)
+        return ::mmap( 0, size, prot, MAP_PRIVATE | MAP_ANON | flags, -1, 0);
+#else
+        return ::mmap( 0, size, prot, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+#endif
+    }
+
+    // a guard region does not split the mapping, kernels without support
+    // fail with EINVAL and mprotect() is used from then on
+    void install_guard_( char * addr) BOOST_NOEXCEPT
+    {
+#if defined(__linux__)
+# if defined(MADV_GUARD_INSTALL)
+        const int advice = MADV_GUARD_INSTALL;
+# else
+        const int advice = 102;
+# endif
+        if ( storage_->guard_regions)
+        {
+            if ( 0 == ::madvise( addr, traits_type::page_size(), advice) )
+                return;
+            storage_->guard_regions = false;
+        }
+#endif
+        BOOST_VERIFY( 0 == ::mprotect( addr, traits_type::page_size(), PROT_NONE) );
+    }
+
+    // maps a huge page aligned arena of `size` bytes
+    slab * map_huge_( std::size_t size)
+    {
+        const std::size_t huge = huge_page_size();
+#if defined(MAP_HUGETLB)
+        if ( huge_pages == storage_->mode)
+        {
+            // hugetlb mappings are aligned to the huge page size
+            void * vp = map_( size, PROT_READ | PROT_WRITE, MAP_HUGETLB);
+            if ( MAP_FAILED != vp)
+            {
+                storage_->backing = huge_pages;
+                return new slab( storage_->slabs, vp, size);
+            }
+        }
+#endif
+        // reserve enough address space to align the arena
+        const std::size_t total = size + huge;
+        void * vp = map_( total, PROT_NONE, 0);
+        if ( MAP_FAILED == vp) throw std::bad_alloc();
+        char * first = static_cast< char * >( vp);
+        char * arena = reinterpret_cast< char * >(
+            round_up_( reinterpret_cast< std::size_t >( first), huge) );
+        // trim the reservation to [arena, arena + size)
+        if ( first < arena) ::munmap( first, arena - first);
+        if ( arena + size < first + total) ::munmap( arena + size, ( first + total) - ( arena + size) );
+        if ( 0 != ::mprotect( arena, size, PROT_READ | PROT_WRITE) )
+        {
+            ::munmap( arena, size);
+            throw std::bad_alloc();
+        }
+        storage_->backing = normal_pages;
+#if defined(MADV_HUGEPAGE)
+        if ( 0 == ::madvise( arena, size, MADV_HUGEPAGE) )
+            storage_->backing = transparent_huge_pages;
+#endif
+        return new slab( storage_->slabs, arena, size);
+    }
+
+    // maps a slab of at least `count` slots
+    void map_slab_( std::size_t count)
+    {
+        slab * s = 0;
+        if ( normal_pages == storage_->mode)
+        {
+            const std::size_t size = count * storage_->slot_size;
+            void * vp = map_( size, PROT_READ | PROT_WRITE, 0);
+            if ( MAP_FAILED == vp) throw std::bad_alloc();
+            s = new slab( storage_->slabs, vp, size);
+        }
+        else
+        {
+            // use the whole huge pages, the stacks are packed into them
+            const std::size_t size = round_up_( count * storage_->slot_size, huge_page_size() );
+            count = size / storage_->slot_size;
+            s = map_huge_( size);
+        }
+        storage_->slabs = s;
+
+        char * first = static_cast< char * >( s->addr);
+        // push in reverse order, slots are handed out from low to high addresses
+        for ( std::size_t i = count; 0 < i; --i)
+        {
+            char * limit = first + ( i - 1) * storage_->slot_size;
+            if ( storage_->guard)
+                install_guard_( limit);
+            node * n = reinterpret_cast< node * >( limit + storage_->slot_size - sizeof( node) );
+            n->next = storage_->free_list;
+            storage_->free_list = n;
+        }
+        storage_->free_count += count;
+        storage_->slot_count += count;
+    }
+
+    static storage * make_storage_( std::size_t stack_size, std::size_t slots_per_slab,
+                                    bool guard, page_mode mode)
+    {
+        BOOST_ASSERT( 0 < slots_per_slab);
+        if ( guard && normal_pages != mode)
+            boost::throw_exception( std::invalid_argument(
+                "boost::coroutines::slab_stack_allocator: slabs backed by huge pages "
+                "have no guard pages, construct the allocator with guard = false") );
+        return new storage( round_up_( stack_size), slots_per_slab, guard, mode);
+    }
+
+public:
+    // throws std::invalid_argument if `guard` is requested for huge pages
+    explicit basic_slab_stack_allocator(
+            std::size_t stack_size = traits_type::default_size(),
+            std::size_t slots_per_slab = 64,
+            bool guard = true,
+            page_mode mode = normal_pages) :
+        storage_( make_storage_( stack_size, slots_per_slab, guard, mode) )
+    {}
+
+    basic_slab_stack_allocator( basic_slab_stack_allocator const& other) BOOST_NOEXCEPT :
+        storage_( other.storage_)
+    { ++storage_->use_count; }
+
+    basic_slab_stack_allocator &
+    operator=( basic_slab_stack_allocator const& other) BOOST_NOEXCEPT
+    {
+        if ( storage_ == other.storage_) return * this;
+
+        ++other.storage_->use_count;
+        this->~basic_slab_stack_allocator();
+        storage_ = other.storage_;
+        return * this;
+    }
+
+    ~basic_slab_stack_allocator()
+    {
+        if ( 0 == --storage_->use_count)
+        {
+            // each coroutine holds a copy, no slot can be in use
+            BOOST_ASSERT( storage_->free_count == storage_->slot_count);
+            delete storage_;
+        }
+    }
+
+    // stacks larger than the slots are allocated by protected_stack_allocator
+    void allocate( stack_context & ctx, std::size_t size = traits_type::minimum_size() )
+    {
+        BOOST_ASSERT( traits_type::minimum_size() <= size);
+        BOOST_ASSERT( traits_type::is_unbounded() || ( traits_type::maximum_size() >= size) );
+
+        if ( storage_->stack_size < size)
+        {
+            // deallocate() tells the stacks apart by their size
+            const std::size_t size_ = ( size / traits_type::page_size() ) * traits_type::page_size();
+            allocator_type().allocate(
+                ctx, storage_->slot_size == size_ ? size_ + traits_type::page_size() : size);
+            BOOST_ASSERT( storage_->slot_size != ctx.size);
+            return;
+        }
+
+        if ( 0 == storage_->free_list) map_slab_( storage_->slots_per_slab);
+        node * n = storage_->free_list;
+        storage_->free_list = n->next;
+        --storage_->free_count;
+
+        ctx.size = storage_->slot_size;
+        ctx.sp = reinterpret_cast< char * >( n) + sizeof( node);
+#if defined(BOOST_USE_VALGRIND)
+        ctx.valgrind_stack_id = VALGRIND_STACK_REGISTER( ctx.sp, static_cast< char * >( ctx.sp) - ctx.size);
+#endif
+    }
+
+    void deallocate( stack_context & ctx)
+    {
+        BOOST_ASSERT( ctx.sp);
+        BOOST_ASSERT( traits_type::minimum_size() <= ctx.size);
+        BOOST_ASSERT( traits_type::is_unbounded() || ( traits_type::maximum_size() >= ctx.size) );
+
+        if ( storage_->slot_size != ctx.size)
+        {
+            allocator_type().deallocate( ctx);
+            return;
+        }
+
+#if defined(BOOST_USE_VALGRIND)
+        VALGRIND_STACK_DEREGISTER( ctx.valgrind_stack_id);
+#endif
+        node * n = reinterpret_cast< node * >( static_cast< char * >( ctx.sp) - sizeof( node) );
+        n->next = storage_->free_list;
+        storage_->free_list = n;
+        ++storage_->free_count;
+    }
+
+    // makes sure that at least `count` slots are free, missing slots are
+    // mapped as one slab
+    void reserve( std::size_t count)
+    {
+        if ( storage_->free_count < count)
+            map_slab_( count - storage_->free_count);
+    }
+
+    // page mode of the most recently mapped slab
+    page_mode backing() const BOOST_NOEXCEPT
+    { return storage_->backing; }
+
+    // true if the guard pages between the slots are guard regions, e.g. do
+    // not split the slabs into one VMA per slot
+    bool guard_regions() const BOOST_NOEXCEPT
+    { return storage_->guard && storage_->guard_regions; }
+
+    // size of a huge page, 2 MiB if not available
+    static std::size_t huge_page_size() BOOST_NOEXCEPT
+    {
+        std::size_t kb = 2048;
+#if defined(__linux__)
+        if ( std::FILE * f = std::fopen( "/proc/meminfo", "r") )
+        {
+            char line[128];
+            while ( std::fgets( line, sizeof( line), f) )
+            {
+                unsigned long value = 0;
+                if ( 1 == std::sscanf( line, "Hugepagesize: %lu kB", & value) && 0 != value)
+                {
+                    kb = value;
+                    break;
+                }
+            }
+            std::fclose( f);
+        }
+#endif
+        return kb * 1024;
+    }
+
+    std::size_t stack_size() const BOOST_NOEXCEPT
+    { return storage_->stack_size; }
+
+    std::size_t free_count() const BOOST_NOEXCEPT
+    { return storage_->free_count; }
+
+    std::size_t slot_count() const BOOST_NOEXCEPT
+    { return storage_->slot_count; }
+};
+
+typedef basic_slab_stack_allocator< stack_traits > slab_stack_allocator;
+
+// constructs `count` coroutines of type Coroutine (pull_type, push_type or
+// call_type) and assigns them to `out`; the stacks are taken from one slab
+template< typename Coroutine, typename Fn, typename traitsT, typename OutputIterator >
+OutputIterator make_coroutines( std::size_t count, Fn fn, attributes const& attrs,
+                                basic_slab_stack_allocator< traitsT > const& stack_alloc,
+                                OutputIterator out)
+{
+    BOOST_ASSERT( attrs.size <= stack_alloc.stack_size() );
+
+    basic_slab_stack_allocator< traitsT > alloc( stack_alloc);
+    alloc.reserve( count);
+    for ( std::size_t i = 0; i < count; ++i)
+    {
+        // pass a copy as rvalue, an lvalue would be bound by reference
+        Coroutine c( Fn( fn), attrs, alloc);
+        * out = boost::move( c);
+        ++out;
+    }
+    return out;
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_POSIX_SLAB_STACK_ALLOCATOR_H
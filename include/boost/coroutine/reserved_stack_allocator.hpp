@@ -0,0 +1,11 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/config.hpp>
+
+#if ! defined(BOOST_WINDOWS)
+# include <boost/coroutine/posix/reserved_stack_allocator.hpp>
+#endif
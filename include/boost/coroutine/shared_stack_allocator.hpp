@@ -0,0 +1,205 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_SHARED_STACK_ALLOCATOR_H
+#define BOOST_COROUTINES_SHARED_STACK_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+
+#if defined(BOOST_USE_SEGMENTED_STACKS)
+# error "shared_stack_allocator does not support segmented stacks"
+#endif
+
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/detail/preallocated.hpp>
+#include <boost/coroutine/detail/shared_stack.hpp>
+#include <boost/coroutine/protected_stack_allocator.hpp>
+#include <boost/coroutine/stack_context.hpp>
+#include <boost/coroutine/stack_traits.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// all coroutines created with copies of the allocator run on one shared
+// stack; on a switch, the live part of the stack of the leaving coroutine
+// (stack pointer to top of the stack) is copied to a heap buffer and the
+// stack of the resumed coroutine is copied back
+// each coroutine owns `control_size` bytes for its control block and the
+// buffer, the stack size requested by the attributes is ignored
+// coroutines sharing a stack must be used by one thread at a time
+// values passed by context switches are accessed at the copy of the stack
+// of a suspended coroutine (trivially copyable types only), other addresses
+// of objects on the stack of a suspended coroutine must not be used by other
+// coroutines of the same shared stack
+// the coroutines recognise the shared stack by the type of the allocator,
+// it can not be wrapped by a stack allocator adaptor
+template< typename traitsT >
+class basic_shared_stack_allocator
+{
+public:
+    typedef traitsT traits_type;
+
+private:
+    friend struct detail::shared_stack_of< basic_shared_stack_allocator >;
+
+    typedef basic_protected_stack_allocator< traitsT >  allocator_type;
+    typedef detail::shared_stack_record                 record_type;
+
+    enum { record_size = ( ( sizeof( record_type) + 15) / 16) * 16 };
+
+    struct storage : public detail::shared_stack
+    {
+        std::size_t     use_count;
+        std::size_t     control_size;
+        std::size_t     count;
+
+        storage( std::size_t size, std::size_t control_size_) :
+            detail::shared_stack(),
+            use_count( 1),
+            control_size( control_size_),
+            count( 0)
+        {
+            allocator_type allocator;
+            allocator.allocate( sctx, size);
+            try
+            {
+                // the switcher only copies stacks
+                const std::size_t page = traits_type::page_size();
+                allocator.allocate( switcher_sctx,
+                    ( ( traits_type::minimum_size() + page - 1) / page) * page);
+            }
+            catch (...)
+            {
+                allocator.deallocate( sctx);
+                throw;
+            }
+            switcher = detail::coroutine_context(
+                & detail::shared_stack_switch,
+                detail::preallocated( switcher_sctx.sp, switcher_sctx.size, switcher_sctx) );
+        }
+
+        ~storage()
+        {
+            if ( detail::running_stack() == this) detail::running_stack() = 0;
+            allocator_type allocator;
+            allocator.deallocate( switcher_sctx);
+            allocator.deallocate( sctx);
+        }
+    };
+
+    storage     *   storage_;
+
+    // the record is placed at the begin of the memory of the control block
+    static record_type * record_( stack_context const& ctx) BOOST_NOEXCEPT
+    {
+        return reinterpret_cast< record_type * >(
+            static_cast< char * >( ctx.sp) - ctx.size - record_size);
+    }
+
+public:
+    explicit basic_shared_stack_allocator(
+            std::size_t size = traits_type::default_size(),
+            std::size_t control_size = 1024) :
+        storage_( new storage( size, control_size) )
+    { BOOST_ASSERT( record_size < control_size); }
+
+    basic_shared_stack_allocator( basic_shared_stack_allocator const& other) BOOST_NOEXCEPT :
+        storage_( other.storage_)
+    { ++storage_->use_count; }
+
+    basic_shared_stack_allocator &
+    operator=( basic_shared_stack_allocator const& other) BOOST_NOEXCEPT
+    {
+        if ( storage_ == other.storage_) return * this;
+
+        ++other.storage_->use_count;
+        this->~basic_shared_stack_allocator();
+        storage_ = other.storage_;
+        return * this;
+    }
+
+    ~basic_shared_stack_allocator()
+    {
+        if ( 0 == --storage_->use_count)
+        {
+            // each coroutine holds a copy, no coroutine can be alive
+            BOOST_ASSERT( 0 == storage_->count);
+            delete storage_;
+        }
+    }
+
+    // `ctx` describes the memory for the control block of the coroutine
+    void allocate( stack_context & ctx, std::size_t = traits_type::minimum_size() )
+    {
+        char * block = static_cast< char * >( ::operator new( storage_->control_size) );
+        new ( block) record_type( storage_);
+        ctx.sp = block + storage_->control_size;
+        ctx.size = storage_->control_size - record_size;
+        ++storage_->count;
+    }
+
+    void deallocate( stack_context & ctx)
+    {
+        BOOST_ASSERT( ctx.sp);
+
+        record_type * r = record_( ctx);
+        if ( storage_->owner == r) storage_->owner = 0;
+        if ( storage_->sender == r) storage_->sender = 0;
+        storage_->buffer_bytes -= r->capacity;
+        std::free( r->buffer);
+        r->~record_type();
+        ::operator delete( r);
+        --storage_->count;
+    }
+
+    // size of the shared stack
+    std::size_t stack_size() const BOOST_NOEXCEPT
+    { return storage_->sctx.size; }
+
+    // number of coroutines on the shared stack
+    std::size_t count() const BOOST_NOEXCEPT
+    { return storage_->count; }
+
+    // bytes allocated to hold the stacks of suspended coroutines
+    std::size_t buffer_bytes() const BOOST_NOEXCEPT
+    { return storage_->buffer_bytes; }
+
+    // bytes copied from and to the shared stack
+    std::size_t copied_bytes() const BOOST_NOEXCEPT
+    { return storage_->copied_bytes; }
+};
+
+typedef basic_shared_stack_allocator< stack_traits > shared_stack_allocator;
+
+namespace detail {
+
+template< typename traitsT >
+struct shared_stack_of< basic_shared_stack_allocator< traitsT > >
+{
+    static const bool value = true;
+
+    static shared_stack_record * record( stack_context const& ctx) BOOST_NOEXCEPT
+    { return basic_shared_stack_allocator< traitsT >::record_( ctx); }
+};
+
+}
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_SHARED_STACK_ALLOCATOR_H
@@ -0,0 +1,277 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_COROUTINES_STACK_RESOURCE_H
+#define BOOST_COROUTINES_STACK_RESOURCE_H
+
+#include <cstddef>
+
+#include <boost/assert.hpp>
+#include <boost/config.hpp>
+#include <boost/utility.hpp>
+
+#if ! defined(BOOST_NO_CXX11_HDR_ATOMIC)
+# include <atomic>
+#endif
+
+#include <boost/coroutine/attributes.hpp>
+#include <boost/coroutine/detail/allocate_stack.hpp>
+#include <boost/coroutine/detail/config.hpp>
+#include <boost/coroutine/pooled_protected_stack_allocator.hpp>
+#include <boost/coroutine/stack_allocator.hpp>
+#include <boost/coroutine/stack_context.hpp>
+#include <boost/coroutine/stack_traits.hpp>
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_PREFIX
+#endif
+
+namespace boost {
+namespace coroutines {
+
+// interface of a stack allocation strategy selected at runtime
+class stack_resource : private noncopyable
+{
+public:
+    virtual ~stack_resource() {}
+
+    void allocate( stack_context & ctx, attributes const& attrs)
+    { do_allocate( ctx, attrs); }
+
+    void deallocate( stack_context & ctx)
+    { do_deallocate( ctx); }
+
+protected:
+    virtual void do_allocate( stack_context &, attributes const&) = 0;
+
+    virtual void do_deallocate( stack_context &) = 0;
+};
+
+// stack_resource allocating from a `StackAllocator`
+template< typename StackAllocator >
+class stack_resource_adaptor : public stack_resource
+{
+private:
+    StackAllocator      alloc_;
+
+protected:
+    void do_allocate( stack_context & ctx, attributes const& attrs)
+    { detail::forward_allocate( alloc_, ctx, attrs); }
+
+    void do_deallocate( stack_context & ctx)
+    { alloc_.deallocate( ctx); }
+
+public:
+    explicit stack_resource_adaptor( StackAllocator const& alloc = StackAllocator() ) :
+        alloc_( alloc)
+    {}
+
+    StackAllocator & allocator() BOOST_NOEXCEPT
+    { return alloc_; }
+};
+
+typedef stack_resource_adaptor< pooled_protected_stack_allocator >  pooled_stack_resource;
+
+namespace detail {
+
+#if ! defined(BOOST_NO_CXX11_HDR_ATOMIC)
+typedef std::atomic< stack_resource * >     stack_resource_ptr;
+#else
+typedef stack_resource *                    stack_resource_ptr;
+#endif
+
+inline
+stack_resource * default_stack_resource_()
+{
+    static stack_resource_adaptor< stack_allocator > resource;
+    return & resource;
+}
+
+inline
+stack_resource_ptr & current_stack_resource_()
+{
+    static stack_resource_ptr resource( default_stack_resource_() );
+    return resource;
+}
+
+}
+
+// resource used by polymorphic_stack_allocator if none is given, initially
+// a resource allocating from stack_allocator
+inline
+stack_resource * get_default_stack_resource()
+{ return detail::current_stack_resource_(); }
+
+// sets the default resource (the initial one if `r` is null) and returns
+// the previous one; atomic if C++11 atomics are available
+inline
+stack_resource * set_default_stack_resource( stack_resource * r)
+{
+    if ( 0 == r) r = detail::default_stack_resource_();
+#if ! defined(BOOST_NO_CXX11_HDR_ATOMIC)
+    return detail::current_stack_resource_().exchange( r);
+#else
+    stack_resource * previous = detail::current_stack_resource_();
+    detail::current_stack_resource_() = r;
+    return previous;
+#endif
+}
+
+// stack allocator holding only a pointer to a stack_resource; the
+// coroutine type does not depend on the allocation strategy and its control
+// block grows by one pointer only
+// the resource must outlive all coroutines allocated from it
+class polymorphic_stack_allocator
+{
+private:
+    stack_resource  *   resource_;
+
+public:
+    // coroutines pass the attributes to allocate()
+    typedef void uses_attributes;
+
+    polymorphic_stack_allocator( stack_resource * resource = get_default_stack_resource() ) BOOST_NOEXCEPT :
+        resource_( resource)
+    { BOOST_ASSERT( 0 != resource_); }
+
+    void allocate( stack_context & ctx, attributes const& attrs)
+    { resource_->allocate( ctx, attrs); }
+
+    void allocate( stack_context & ctx, std::size_t size = stack_traits::minimum_size() )
+    { resource_->allocate( ctx, attributes( size) ); }
+
+    void deallocate( stack_context & ctx)
+    { resource_->deallocate( ctx); }
+
+    stack_resource * resource() const BOOST_NOEXCEPT
+    { return resource_; }
+};
+
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+// carves stacks from chunks of memory (a buffer of the caller or chunks
+// allocated from an upstream resource) without ever releasing them one by
+// one; all memory is handed back by release() or the destructor
+// stacks within a chunk are not separated by guard pages
+// not synchronized, e.g. the resource must be used by one thread at a time
+class monotonic_stack_resource : public stack_resource
+{
+private:
+    // stored at the top of a chunk allocated from the upstream resource
+    struct chunk
+    {
+        chunk           *   next;
+        stack_context       sctx;
+    };
+
+    enum { header_size = ( ( sizeof( chunk) + 15) / 16) * 16 };
+
+    stack_resource  *   upstream_;
+    std::size_t         chunk_size_;
+    chunk           *   chunks_;
+    char            *   buffer_top_;
+    char            *   buffer_limit_;
+    char            *   top_;
+    char            *   limit_;
+
+    static std::size_t round_up_( std::size_t size) BOOST_NOEXCEPT
+    { return ( ( size + 15) / 16) * 16; }
+
+    void new_chunk_( std::size_t size)
+    {
+        std::size_t size_ = size + header_size;
+        if ( size_ < chunk_size_) size_ = chunk_size_;
+        stack_context sctx;
+        upstream_->allocate( sctx, attributes( size_) );
+        chunk * c = reinterpret_cast< chunk * >(
+            static_cast< char * >( sctx.sp) - header_size);
+        c->next = chunks_;
+        c->sctx = sctx;
+        chunks_ = c;
+        top_ = reinterpret_cast< char * >( c);
+        limit_ = static_cast< char * >( sctx.sp) - sctx.size;
+    }
+
+protected:
+    void do_allocate( stack_context & ctx, attributes const& attrs)
+    {
+        const std::size_t size = round_up_( attrs.size);
+        if ( static_cast< std::size_t >( top_ - limit_) < size)
+            new_chunk_( size);
+        ctx.sp = top_;
+        ctx.size = size;
+        top_ -= size;
+    }
+
+    void do_deallocate( stack_context & ctx)
+    {
+        BOOST_ASSERT( ctx.sp);
+        ctx.sp = 0;
+    }
+
+public:
+    explicit monotonic_stack_resource(
+            std::size_t chunk_size = 16 * stack_traits::default_size(),
+            stack_resource * upstream = get_default_stack_resource() ) BOOST_NOEXCEPT :
+        upstream_( upstream),
+        chunk_size_( chunk_size),
+        chunks_( 0),
+        buffer_top_( 0),
+        buffer_limit_( 0),
+        top_( 0),
+        limit_( 0)
+    { BOOST_ASSERT( 0 != upstream_); }
+
+    // stacks are carved from `size` bytes at `buffer` first
+    monotonic_stack_resource(
+            void * buffer, std::size_t size,
+            std::size_t chunk_size = 16 * stack_traits::default_size(),
+            stack_resource * upstream = get_default_stack_resource() ) BOOST_NOEXCEPT :
+        upstream_( upstream),
+        chunk_size_( chunk_size),
+        chunks_( 0),
+        buffer_top_( 0),
+        buffer_limit_( static_cast< char * >( buffer) ),
+        top_( 0),
+        limit_( 0)
+    {
+        BOOST_ASSERT( 0 != buffer);
+        BOOST_ASSERT( 0 != upstream_);
+        std::size_t top = reinterpret_cast< std::size_t >( buffer) + size;
+        buffer_top_ = reinterpret_cast< char * >( top & ~static_cast< std::size_t >( 15) );
+        top_ = buffer_top_;
+        limit_ = buffer_limit_;
+    }
+
+    ~monotonic_stack_resource()
+    { release(); }
+
+    // hands back the chunks to the upstream resource, the buffer of the
+    // caller is reused; no stack allocated from this resource may be in use
+    void release()
+    {
+        while ( 0 != chunks_)
+        {
+            chunk * c = chunks_;
+            chunks_ = c->next;
+            stack_context sctx( c->sctx);
+            upstream_->deallocate( sctx);
+        }
+        top_ = buffer_top_;
+        limit_ = buffer_limit_;
+    }
+
+    stack_resource * upstream_resource() const BOOST_NOEXCEPT
+    { return upstream_; }
+};
+#endif
+
+}}
+
+#ifdef BOOST_HAS_ABI_HEADERS
+#  include BOOST_ABI_SUFFIX
+#endif
+
+#endif // BOOST_COROUTINES_STACK_RESOURCE_H
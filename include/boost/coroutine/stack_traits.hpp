@@ -39,4 +39,12 @@ struct BOOST_COROUTINES_DECL stack_traits
 #  include BOOST_ABI_SUFFIX
 #endif
 
+#if defined(BOOST_COROUTINES_HEADER_ONLY)
+# if defined(BOOST_WINDOWS)
+#  include <boost/coroutine/detail/impl/stack_traits_windows.ipp>
+# else
+#  include <boost/coroutine/detail/impl/stack_traits_posix.ipp>
+# endif
+#endif
+
 #endif // BOOST_COROUTINES_STACK_TRAITS_H
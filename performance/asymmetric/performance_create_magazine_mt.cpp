@@ -0,0 +1,117 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+
+#include "../clock.hpp"
+#include "../page_faults.hpp"
+
+typedef boost::coroutines::asymmetric_coroutine< void >     coro_type;
+
+boost::coroutines::flag_unwind_t unwind_stack = boost::coroutines::stack_unwind;
+boost::uint64_t jobs = 1000;
+
+void fn( coro_type::push_type & c)
+{ while ( true) c(); }
+
+// each thread creates and destroys `jobs` coroutines; every second coroutine
+// is destroyed by the next thread (stacks migrate between the threads)
+template< typename StackAllocator >
+void worker( std::vector< coro_type::pull_type > * handoff, std::size_t idx)
+{
+    StackAllocator stack_alloc;
+    for ( std::size_t i = 0; i < jobs; ++i) {
+        coro_type::pull_type c( fn,
+            boost::coroutines::attributes( unwind_stack), stack_alloc);
+        if ( 0 == i % 2) handoff[idx].push_back( boost::move( c) );
+    }
+}
+
+void drain( std::vector< coro_type::pull_type > * handoff, std::size_t idx)
+{ handoff[idx].clear(); }
+
+template< typename StackAllocator >
+duration_type measure_time( std::size_t threads)
+{
+    std::vector< std::vector< coro_type::pull_type > > handoff( threads);
+    for ( std::size_t i = 0; i < threads; ++i) handoff[i].reserve( jobs);
+
+    time_point_type start( clock_type::now() );
+    std::vector< std::thread > workers;
+    for ( std::size_t i = 0; i < threads; ++i)
+        workers.push_back( std::thread( worker< StackAllocator >, & handoff[0], i) );
+    for ( std::size_t i = 0; i < threads; ++i)
+        workers[i].join();
+    workers.clear();
+    for ( std::size_t i = 0; i < threads; ++i)
+        workers.push_back( std::thread( drain, & handoff[0], ( i + 1) % threads) );
+    for ( std::size_t i = 0; i < threads; ++i)
+        workers[i].join();
+    duration_type total = clock_type::now() - start;
+    total /= jobs;  // loops per thread
+
+    return total;
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool unwind = true, protect = false;
+        std::size_t threads = std::thread::hardware_concurrency();
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("protected,p", boost::program_options::value< bool >( & protect), "use protected_stack_allocator (baseline)")
+            ("threads,t", boost::program_options::value< std::size_t >( & threads), "maximum number of threads")
+            ("unwind,u", boost::program_options::value< bool >( & unwind), "unwind coroutine-stack")
+            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "jobs to run per thread");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( ! unwind) unwind_stack = boost::coroutines::no_stack_unwind;
+        if ( 0 == threads) threads = 1;
+
+        for ( std::size_t n = 1; n <= threads; n *= 2) {
+            boost::uint64_t faults = minor_page_faults();
+            duration_type d = protect
+                ? measure_time< boost::coroutines::protected_stack_allocator >( n)
+                : measure_time< boost::coroutines::magazine_stack_allocator >( n);
+            faults = minor_page_faults() - faults;
+            std::cout << n << " threads: average of " << d.count() << " nano seconds per coroutine and thread, "
+                      << ( n * 1000000000.0) / d.count() << " coroutines per second, "
+                      << double( faults) / ( n * jobs) << " minor page faults per coroutine" << std::endl;
+        }
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,133 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+
+#include "../clock.hpp"
+#include "../page_faults.hpp"
+
+typedef boost::coroutines::asymmetric_coroutine< void >     coro_type;
+
+boost::coroutines::flag_unwind_t unwind_stack = boost::coroutines::stack_unwind;
+boost::uint64_t jobs = 1000;
+std::size_t prefault = 0; // KiB
+
+boost::coroutines::attributes make_attributes()
+{
+    boost::coroutines::attributes attrs( unwind_stack);
+    attrs.prefault = prefault * 1024;
+    return attrs;
+}
+
+void fn( coro_type::push_type & c)
+{ while ( true) c(); }
+
+// number of memory mappings (VMAs) of this process
+std::size_t count_vmas()
+{
+    std::ifstream maps( "/proc/self/maps");
+    std::size_t count = 0;
+    std::string line;
+    while ( std::getline( maps, line) ) ++count;
+    return count;
+}
+
+void report( char const* what, duration_type total, std::size_t vmas, boost::uint64_t faults)
+{
+    faults = minor_page_faults() - faults;
+    std::cout << what << ": average of " << ( total / jobs).count() << " nano seconds, "
+              << double( faults) / jobs << " minor page faults per coroutine, "
+              << count_vmas() - vmas << " additional VMAs for " << jobs << " coroutines" << std::endl;
+}
+
+template< typename StackAllocator >
+void measure( char const* what, StackAllocator stack_alloc)
+{
+    std::vector< coro_type::pull_type > coros;
+    coros.reserve( jobs);
+    std::size_t vmas = count_vmas();
+    boost::uint64_t faults = minor_page_faults();
+    time_point_type start( clock_type::now() );
+    for ( std::size_t i = 0; i < jobs; ++i)
+        coros.push_back(
+            coro_type::pull_type( fn, make_attributes(), stack_alloc) );
+    report( what, clock_type::now() - start, vmas, faults);
+}
+
+void measure_bulk( char const* what, boost::coroutines::slab_stack_allocator stack_alloc)
+{
+    std::vector< coro_type::pull_type > coros;
+    coros.reserve( jobs);
+    std::size_t vmas = count_vmas();
+    boost::uint64_t faults = minor_page_faults();
+    time_point_type start( clock_type::now() );
+    boost::coroutines::make_coroutines< coro_type::pull_type >(
+        jobs, fn, make_attributes(), stack_alloc,
+        std::back_inserter( coros) );
+    report( what, clock_type::now() - start, vmas, faults);
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool unwind = true;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("unwind,u", boost::program_options::value< bool >( & unwind), "unwind coroutine-stack")
+            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "coroutines to create")
+            ("prefault,p", boost::program_options::value< std::size_t >( & prefault), "KiB of stack pre-faulted per coroutine");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( ! unwind) unwind_stack = boost::coroutines::no_stack_unwind;
+
+        measure( "protected_stack_allocator", boost::coroutines::protected_stack_allocator() );
+        measure( "standard_stack_allocator", boost::coroutines::standard_stack_allocator() );
+        boost::coroutines::slab_stack_allocator guarded;
+        measure( "slab_stack_allocator (guard pages)", guarded);
+        // guard regions keep a slab one VMA, mprotect() splits it per slot
+        std::cout << "guard pages installed by "
+                  << ( guarded.guard_regions() ? "madvise( MADV_GUARD_INSTALL)" : "mprotect()")
+                  << std::endl;
+        measure( "slab_stack_allocator (no guard pages)",
+            boost::coroutines::slab_stack_allocator( boost::coroutines::stack_traits::default_size(), 64, false) );
+        measure_bulk( "make_coroutines (guard pages)", boost::coroutines::slab_stack_allocator() );
+        measure_bulk( "make_coroutines (no guard pages)",
+            boost::coroutines::slab_stack_allocator( boost::coroutines::stack_traits::default_size(), 64, false) );
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -16,13 +16,23 @@
 #include "../bind_processor.hpp"
 #include "../clock.hpp"
 #include "../cycle.hpp"
+#include "../page_faults.hpp"
 
 typedef boost::coroutines::standard_stack_allocator         stack_allocator;
 typedef boost::coroutines::asymmetric_coroutine< void >     coro_type;
 
-boost::coroutines::flag_fpu_t preserve_fpu = boost::coroutines::fpu_not_preserved;
 boost::coroutines::flag_unwind_t unwind_stack = boost::coroutines::stack_unwind;
 boost::uint64_t jobs = 1000;
+std::size_t prefault = 0; // KiB
+bool lazy = false;
+
+boost::coroutines::attributes make_attributes()
+{
+    boost::coroutines::attributes attrs( unwind_stack);
+    attrs.prefault = prefault * 1024;
+    if ( lazy) attrs.start = boost::coroutines::start_lazy;
+    return attrs;
+}
 
 void fn( coro_type::push_type & c)
 { while ( true) c(); }
@@ -34,7 +44,7 @@ duration_type measure_time( duration_type overhead)
     time_point_type start( clock_type::now() );
     for ( std::size_t i = 0; i < jobs; ++i) {
         coro_type::pull_type c( fn,
-            boost::coroutines::attributes( unwind_stack, preserve_fpu), stack_alloc);
+            make_attributes(), stack_alloc);
     }
     duration_type total = clock_type::now() - start;
     total -= overhead_clock(); // overhead of measurement
@@ -51,7 +61,7 @@ cycle_type measure_cycles( cycle_type overhead)
     cycle_type start( cycles() );
     for ( std::size_t i = 0; i < jobs; ++i) {
         coro_type::pull_type c( fn,
-            boost::coroutines::attributes( unwind_stack, preserve_fpu), stack_alloc);
+            make_attributes(), stack_alloc);
     }
     cycle_type total = cycles() - start;
     total -= overhead; // overhead of measurement
@@ -65,14 +75,15 @@ int main( int argc, char * argv[])
 {
     try
     {
-        bool preserve = false, unwind = true, bind = false;
+        bool unwind = true, bind = false;
         boost::program_options::options_description desc("allowed options");
         desc.add_options()
             ("help", "help message")
             ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
-            ("fpu,f", boost::program_options::value< bool >( & preserve), "preserve FPU registers")
             ("unwind,u", boost::program_options::value< bool >( & unwind), "unwind coroutine-stack")
-            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "jobs to run");
+            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "jobs to run")
+            ("prefault,p", boost::program_options::value< std::size_t >( & prefault), "KiB of stack pre-faulted per coroutine")
+            ("lazy,l", boost::program_options::value< bool >( & lazy), "defer stack allocation to first use");
 
         boost::program_options::variables_map vm;
         boost::program_options::store(
@@ -88,14 +99,16 @@ int main( int argc, char * argv[])
             return EXIT_SUCCESS;
         }
 
-        if ( preserve) preserve_fpu = boost::coroutines::fpu_preserved;
         if ( ! unwind) unwind_stack = boost::coroutines::no_stack_unwind;
         if ( bind) bind_to_processor( 0);
 
         duration_type overhead_c = overhead_clock();
         std::cout << "overhead " << overhead_c.count() << " nano seconds" << std::endl;
+        boost::uint64_t faults = minor_page_faults();
         boost::uint64_t res = measure_time( overhead_c).count();
+        faults = minor_page_faults() - faults;
         std::cout << "average of " << res << " nano seconds" << std::endl;
+        std::cout << "minor page faults per coroutine " << double( faults) / jobs << std::endl;
 #ifdef BOOST_CONTEXT_CYCLE
         cycle_type overhead_y = overhead_cycle();
         std::cout << "overhead " << overhead_y << " cpu cycles" << std::endl;
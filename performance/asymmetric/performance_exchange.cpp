@@ -0,0 +1,172 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+
+#include "../bind_processor.hpp"
+#include "../clock.hpp"
+#include "../cycle.hpp"
+
+typedef boost::coroutines::asymmetric_coroutine< int >          asym_type;
+typedef boost::coroutines::bidirectional_coroutine< int, int >  bidi_type;
+
+boost::uint64_t jobs = 1000000;
+
+// the protocol: the response is the running sum of the requests
+
+// request and response are passed by the context switches of one round trip
+void server_bidi( bidi_type::yield_type & yield)
+{
+    int sum = 0;
+    while ( true)
+    {
+        sum += yield.get();
+        yield( sum);
+    }
+}
+
+// the response is written to an out-parameter
+void server_push( asym_type::pull_type & source, int * response)
+{
+    int sum = 0;
+    while ( source)
+    {
+        sum += source.get();
+        * response = sum;
+        source();
+    }
+}
+
+// requests are passed to one coroutine, responses are produced by a second
+void server_requests( asym_type::pull_type & source, int * pending)
+{
+    while ( source)
+    {
+        * pending += source.get();
+        source();
+    }
+}
+
+void server_responses( asym_type::push_type & sink, int const* pending)
+{ while ( true) sink( * pending); }
+
+template< typename Exchange >
+void measure( char const* what, Exchange exchange)
+{
+    boost::uint64_t sum = 0;
+    time_point_type start( clock_type::now() );
+#ifdef BOOST_CONTEXT_CYCLE
+    cycle_type start_c( cycles() );
+#endif
+    for ( boost::uint64_t i = 0; i < jobs; ++i)
+        sum += exchange( static_cast< int >( i & 0xff) );
+#ifdef BOOST_CONTEXT_CYCLE
+    cycle_type total_c = cycles() - start_c;
+#endif
+    duration_type total = clock_type::now() - start;
+
+    std::cout << what << ": average of " << ( total / jobs).count() << " nano seconds";
+#ifdef BOOST_CONTEXT_CYCLE
+    std::cout << ", " << total_c / jobs << " cpu cycles";
+#endif
+    std::cout << " per exchange (" << sum << ")" << std::endl;
+}
+
+struct exchange_bidi
+{
+    bidi_type::call_type  *   server;
+
+    int operator()( int request)
+    { return ( * server)( request).get(); }
+};
+
+struct exchange_push
+{
+    asym_type::push_type  *   server;
+    int                   *   response;
+
+    int operator()( int request)
+    {
+        ( * server)( request);
+        return * response;
+    }
+};
+
+struct exchange_pair
+{
+    asym_type::push_type  *   requests;
+    asym_type::pull_type  *   responses;
+
+    int operator()( int request)
+    {
+        ( * requests)( request);
+        ( * responses)();
+        return responses->get();
+    }
+};
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool bind = false;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
+            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "request/response exchanges");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( bind) bind_to_processor( 0);
+
+        {
+            bidi_type::call_type server( server_bidi);
+            exchange_bidi ex = { & server };
+            measure( "bidirectional_coroutine", ex);
+        }
+        {
+            int response = 0;
+            asym_type::push_type server( boost::bind( server_push, _1, & response) );
+            exchange_push ex = { & server, & response };
+            measure( "push_type, out-parameter", ex);
+        }
+        {
+            int pending = 0;
+            asym_type::push_type requests( boost::bind( server_requests, _1, & pending) );
+            asym_type::pull_type responses( boost::bind( server_responses, _1, & pending) );
+            exchange_pair ex = { & requests, & responses };
+            measure( "push_type and pull_type", ex);
+        }
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,132 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+
+#include "../clock.hpp"
+
+typedef boost::coroutines::asymmetric_coroutine< void >     coro_type;
+
+std::size_t peak = 32; // KiB of stack touched once by each coroutine
+std::size_t depth = 1; // KiB of stack live while a coroutine is suspended
+std::size_t rounds = 10;
+volatile bool running = true;
+
+std::size_t touch( std::size_t n)
+{
+    volatile char buffer[1024];
+    for ( std::size_t i = 0; i < sizeof( buffer); i += 64) buffer[i] = 0;
+    return 1 < n ? touch( n - 1) + buffer[0] : buffer[0];
+}
+
+void idle( std::size_t n, coro_type::push_type & c)
+{
+    volatile char buffer[1024];
+    for ( std::size_t i = 0; i < sizeof( buffer); i += 64) buffer[i] = 0;
+    if ( 1 < n) idle( n - 1, c);
+    else while ( running) c();
+    // no tail call, the frame stays live
+    buffer[1] = buffer[0];
+}
+
+// a connection: deep while parsing a request, shallow while idle
+void fn( coro_type::push_type & c)
+{
+    touch( peak);
+    idle( depth, c);
+}
+
+// resident set size in KiB
+std::size_t resident()
+{
+    std::size_t size = 0, pages = 0;
+    std::FILE * f = std::fopen("/proc/self/statm", "r");
+    if ( 0 == f) return 0;
+    if ( 2 != std::fscanf( f, "%lu %lu", & size, & pages) ) pages = 0;
+    std::fclose( f);
+    return pages * boost::coroutines::stack_traits::page_size() / 1024;
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        std::size_t count = 10000;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("count,c", boost::program_options::value< std::size_t >( & count), "number of coroutines")
+            ("peak,p", boost::program_options::value< std::size_t >( & peak), "KiB of stack touched once per coroutine")
+            ("depth,d", boost::program_options::value< std::size_t >( & depth), "KiB of stack live per suspended coroutine")
+            ("rounds,r", boost::program_options::value< std::size_t >( & rounds), "resumes per coroutine");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        boost::coroutines::protected_stack_allocator stack_alloc;
+        const std::size_t before = resident();
+        std::vector< coro_type::pull_type > coros;
+        coros.reserve( count);
+        for ( std::size_t i = 0; i < count; ++i)
+            coros.push_back(
+                coro_type::pull_type( fn, boost::coroutines::attributes(), stack_alloc) );
+        const std::size_t awake = resident();
+
+        for ( std::size_t i = 0; i < count; ++i)
+            coros[i].hibernate();
+        const std::size_t hibernated = resident();
+
+        std::cout << count << " coroutines: " << ( awake - before) << " KiB resident, "
+                  << ( hibernated - before) << " KiB hibernated" << std::endl;
+
+        time_point_type start( clock_type::now() );
+        for ( std::size_t r = 0; r < rounds; ++r)
+            for ( std::size_t i = 0; i < count; ++i)
+                coros[i]();
+        duration_type total = clock_type::now() - start;
+        total /= rounds * count;
+        std::cout << "resume: " << total.count() << " ns" << std::endl;
+
+        start = clock_type::now();
+        for ( std::size_t r = 0; r < rounds; ++r)
+            for ( std::size_t i = 0; i < count; ++i)
+            {
+                coros[i].hibernate();
+                coros[i]();
+            }
+        total = clock_type::now() - start;
+        total /= rounds * count;
+        std::cout << "hibernate + wake + resume: " << total.count() << " ns" << std::endl;
+
+        running = false;
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
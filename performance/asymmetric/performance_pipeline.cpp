@@ -0,0 +1,129 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+
+#include "../bind_processor.hpp"
+#include "../clock.hpp"
+#include "../cycle.hpp"
+
+typedef boost::coroutines::asymmetric_coroutine< int >      coro_type;
+
+boost::uint64_t jobs = 1000000;
+
+// generates the values, `batch` values are yielded with one context switch
+void source( coro_type::push_type & sink, std::size_t batch)
+{
+    std::vector< int > buffer( batch);
+    for ( boost::uint64_t i = 0; i < jobs; i += batch)
+    {
+        std::size_t n = static_cast< std::size_t >( ( std::min)( jobs - i, boost::uint64_t( batch) ) );
+        for ( std::size_t j = 0; j < n; ++j)
+            buffer[j] = static_cast< int >( i + j);
+        sink.yield_batch( & buffer[0], & buffer[0] + n);
+    }
+}
+
+// transforms the values pulled from `source`
+void transform( coro_type::pull_type & source, coro_type::push_type & sink, std::size_t batch)
+{
+    std::vector< int > buffer( batch);
+    while ( std::size_t n = source.pull_n( buffer.begin(), batch) )
+    {
+        for ( std::size_t j = 0; j < n; ++j)
+            buffer[j] = 3 * buffer[j] + 1;
+        sink.yield_batch( & buffer[0], & buffer[0] + n);
+    }
+}
+
+// chain of coroutines like example/asymmetric/chaining.cpp: source ->
+// transform -> transform -> sink (range-for)
+void measure( std::size_t batch)
+{
+    coro_type::pull_type stage1( boost::bind( source, _1, batch) );
+    coro_type::pull_type stage2( boost::bind( transform, boost::ref( stage1), _1, batch) );
+    coro_type::pull_type stage3( boost::bind( transform, boost::ref( stage2), _1, batch) );
+
+    boost::uint64_t sum = 0;
+    time_point_type start( clock_type::now() );
+#ifdef BOOST_CONTEXT_CYCLE
+    cycle_type start_c( cycles() );
+#endif
+    for ( coro_type::pull_type::iterator i( boost::begin( stage3) ); i != boost::end( stage3); ++i)
+        sum += * i;
+#ifdef BOOST_CONTEXT_CYCLE
+    cycle_type total_c = cycles() - start_c;
+#endif
+    duration_type total = clock_type::now() - start;
+
+    std::cout << "batch " << batch << ": average of "
+              << ( total / jobs).count() << " nano seconds";
+#ifdef BOOST_CONTEXT_CYCLE
+    std::cout << ", " << total_c / jobs << " cpu cycles";
+#endif
+    std::cout << " per value (" << sum << ")" << std::endl;
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool bind = false;
+        std::size_t batch = 0;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
+            ("batch,n", boost::program_options::value< std::size_t >( & batch), "values per context switch (default: 1, 4, 16, 64, 256)")
+            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "values passed through the pipeline");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( bind) bind_to_processor( 0);
+
+        std::vector< std::size_t > batches;
+        if ( 0 != batch) batches.push_back( batch);
+        else {
+            batches.push_back( 1);
+            batches.push_back( 4);
+            batches.push_back( 16);
+            batches.push_back( 64);
+            batches.push_back( 256);
+        }
+
+        for ( std::size_t i = 0; i < batches.size(); ++i)
+            measure( batches[i]);
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,97 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+
+typedef boost::coroutines::adaptive_stack_allocator         stack_allocator;
+typedef boost::coroutines::asymmetric_coroutine< void >     coro_type;
+
+std::size_t depth = 16; // KiB of stack touched by each coroutine
+
+std::size_t touch( std::size_t n)
+{
+    volatile char buffer[1024];
+    for ( std::size_t i = 0; i < sizeof( buffer); i += 64) buffer[i] = 0;
+    return 1 < n ? touch( n - 1) + buffer[0] : buffer[0];
+}
+
+void fn( coro_type::push_type & c)
+{
+    touch( depth);
+    while ( true) c();
+}
+
+// all stacks end up in the pool, the cached bytes are the footprint of
+// the population
+template< typename StackAllocator, typename Pool >
+std::size_t population( std::size_t count, StackAllocator & stack_alloc, Pool & pool)
+{
+    {
+        std::vector< coro_type::pull_type > coros;
+        coros.reserve( count);
+        for ( std::size_t i = 0; i < count; ++i)
+            coros.push_back(
+                coro_type::pull_type( fn, boost::coroutines::attributes(), stack_alloc) );
+    }
+    std::size_t size = pool.cached_bytes();
+    pool.release();
+    return size;
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        std::size_t count = 1000;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("count,c", boost::program_options::value< std::size_t >( & count), "number of coroutines")
+            ("depth,d", boost::program_options::value< std::size_t >( & depth), "KiB of stack touched per coroutine");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        const std::size_t max_cached = ~static_cast< std::size_t >( 0);
+        boost::coroutines::pooled_protected_stack_allocator pool( max_cached);
+        std::cout << "default: " << population( count, pool, pool) / 1024 << " KiB" << std::endl;
+
+        stack_allocator stack_alloc( 16, 64, 2 * boost::coroutines::stack_traits::page_size(),
+            boost::coroutines::pooled_protected_stack_allocator( max_cached) );
+        // learning phase
+        population( 16, stack_alloc, stack_alloc.allocator() );
+        const std::size_t kind = boost::coroutines::detail::kind_of( fn);
+        std::cout << "peak " << stack_alloc.peak( kind) / 1024 << " KiB, stack size "
+                  << stack_alloc.stack_size( kind) / 1024 << " KiB" << std::endl;
+        std::cout << "adaptive: " << population( count, stack_alloc, stack_alloc.allocator() ) / 1024
+                  << " KiB" << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,123 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+
+namespace coro = boost::coroutines;
+
+typedef coro::shared_stack_allocator                stack_allocator;
+typedef coro::asymmetric_coroutine< void >          coro_type;
+typedef void ( * coroutine_fn)( coro_type::push_type &);
+
+// control blocks of the coroutine types created with a function pointer
+typedef coro::detail::pull_coroutine_object<
+    coro::push_coroutine< void >, void, coroutine_fn, stack_allocator
+>                                                   pull_void_t;
+typedef coro::detail::pull_coroutine_object<
+    coro::push_coroutine< int >, int, void ( *)( coro::push_coroutine< int > &), stack_allocator
+>                                                   pull_int_t;
+typedef coro::detail::push_coroutine_object<
+    coro::pull_coroutine< void >, void, void ( *)( coro::pull_coroutine< void > &), stack_allocator
+>                                                   push_void_t;
+typedef coro::detail::push_coroutine_object<
+    coro::pull_coroutine< int >, int, void ( *)( coro::pull_coroutine< int > &), stack_allocator
+>                                                   push_int_t;
+typedef coro::detail::symmetric_coroutine_object<
+    void, void ( *)( coro::symmetric_coroutine< void >::yield_type &), stack_allocator
+>                                                   call_void_t;
+typedef coro::detail::symmetric_coroutine_object<
+    int, void ( *)( coro::symmetric_coroutine< int >::yield_type &), stack_allocator
+>                                                   call_int_t;
+
+void fn( coro_type::push_type & c)
+{ while ( true) c(); }
+
+// resident set size in KiB
+std::size_t resident()
+{
+    std::size_t size = 0, pages = 0;
+    std::FILE * f = std::fopen("/proc/self/statm", "r");
+    if ( 0 == f) return 0;
+    if ( 2 != std::fscanf( f, "%lu %lu", & size, & pages) ) pages = 0;
+    std::fclose( f);
+    return pages * coro::stack_traits::page_size() / 1024;
+}
+
+void report()
+{
+    std::cout << "execution-context of caller: " << sizeof( coro::detail::coroutine_context) << " bytes\n"
+              << "execution-context of coroutine: " << sizeof( coro::detail::coroutine_stack_context) << " bytes\n"
+              << "stack_context: " << sizeof( coro::stack_context) << " bytes\n"
+              << "control block of pull_type< void >: " << sizeof( pull_void_t) << " bytes\n"
+              << "control block of pull_type< int >: " << sizeof( pull_int_t) << " bytes\n"
+              << "control block of push_type< void >: " << sizeof( push_void_t) << " bytes\n"
+              << "control block of push_type< int >: " << sizeof( push_int_t) << " bytes\n"
+              << "control block of call_type< void >: " << sizeof( call_void_t) << " bytes\n"
+              << "control block of call_type< int >: " << sizeof( call_int_t) << " bytes" << std::endl;
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        std::size_t count = 100000, control = 0;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("count,c", boost::program_options::value< std::size_t >( & count), "number of coroutines")
+            ("control,s", boost::program_options::value< std::size_t >( & control), "bytes per coroutine for the control block (0: smallest)");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        report();
+
+        // the suspended coroutines run on one shared stack, the memory of a
+        // coroutine is its control block and the buffer holding its live stack
+        if ( 0 == control)
+            control = ( ( sizeof( coro::detail::shared_stack_record) + 15) / 16) * 16
+                    + ( ( sizeof( pull_void_t) + 15) / 16) * 16 + 16;
+        stack_allocator stack_alloc( coro::stack_traits::default_size(), control);
+        const std::size_t before = resident();
+        {
+            std::vector< coro_type::pull_type > coros;
+            coros.reserve( count);
+            for ( std::size_t i = 0; i < count; ++i)
+                coros.push_back(
+                    coro_type::pull_type( fn, coro::attributes(), stack_alloc) );
+            const std::size_t after = resident();
+            std::cout << count << " coroutines: control " << control << " bytes, buffers "
+                      << stack_alloc.buffer_bytes() / count << " bytes, resident "
+                      << ( after - before) * 1024 / count << " bytes per coroutine" << std::endl;
+        }
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,88 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+
+typedef boost::coroutines::reserved_stack_allocator         stack_allocator;
+typedef boost::coroutines::asymmetric_coroutine< void >     coro_type;
+
+std::size_t depth = 16; // KiB of stack touched by each coroutine
+
+std::size_t touch( std::size_t n)
+{
+    volatile char buffer[1024];
+    for ( std::size_t i = 0; i < sizeof( buffer); i += 64) buffer[i] = 0;
+    return 1 < n ? touch( n - 1) + buffer[0] : buffer[0];
+}
+
+void fn( coro_type::push_type & c)
+{
+    touch( depth);
+    while ( true) c();
+}
+
+void report( char const* what, stack_allocator const& stack_alloc)
+{
+    std::cout << what << ": reserved " << stack_alloc.reserved_bytes() / 1024
+              << " KiB, committed " << stack_alloc.committed_bytes() / 1024 << " KiB" << std::endl;
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        std::size_t count = 10000, reserve = 1024, hot = 16;
+        bool eager = false;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("count,c", boost::program_options::value< std::size_t >( & count), "number of coroutines")
+            ("depth,d", boost::program_options::value< std::size_t >( & depth), "KiB of stack touched per coroutine")
+            ("reserve,r", boost::program_options::value< std::size_t >( & reserve), "KiB reserved per stack")
+            ("hot,w", boost::program_options::value< std::size_t >( & hot), "KiB kept at the stack top on release")
+            ("eager,e", boost::program_options::value< bool >( & eager), "MADV_DONTNEED instead of MADV_FREE");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        stack_allocator stack_alloc( reserve * 1024, hot * 1024, count,
+            eager ? stack_allocator::reclaim_eager : stack_allocator::reclaim_lazy);
+        {
+            std::vector< coro_type::pull_type > coros;
+            coros.reserve( count);
+            for ( std::size_t i = 0; i < count; ++i)
+                coros.push_back(
+                    coro_type::pull_type( fn, boost::coroutines::attributes(), stack_alloc) );
+            report( "running", stack_alloc);
+        }
+        report( "released", stack_alloc);
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,121 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+
+#include "../bind_processor.hpp"
+#include "../clock.hpp"
+#include "../cycle.hpp"
+
+typedef boost::coroutines::asymmetric_coroutine< void >     coro_type;
+typedef boost::coroutines::slab_stack_allocator             slab_allocator;
+
+boost::uint64_t jobs = 20;
+std::size_t stack_size = 16 * 1024;
+
+void fn( coro_type::push_type & c)
+{ while ( true) c(); }
+
+// resumes `count` coroutines round-robin (a ring), each switch touches the
+// control block and the top frames of the coroutine's stack
+template< typename StackAllocator >
+void measure( char const* what, std::size_t count, StackAllocator stack_alloc)
+{
+    std::vector< coro_type::pull_type > coros;
+    coros.reserve( count);
+    for ( std::size_t i = 0; i < count; ++i)
+        coros.push_back( coro_type::pull_type( fn, boost::coroutines::attributes( stack_size), stack_alloc) );
+    // warm up
+    for ( std::size_t i = 0; i < count; ++i)
+        coros[i]();
+
+    const boost::uint64_t switches = jobs * count * 2; // 2x jump_fcontext
+    time_point_type start( clock_type::now() );
+#ifdef BOOST_CONTEXT_CYCLE
+    cycle_type start_c( cycles() );
+#endif
+    for ( std::size_t j = 0; j < jobs; ++j)
+        for ( std::size_t i = 0; i < count; ++i)
+            coros[i]();
+#ifdef BOOST_CONTEXT_CYCLE
+    cycle_type total_c = cycles() - start_c;
+#endif
+    duration_type total = clock_type::now() - start;
+
+    std::cout << count << " coroutines, " << what << ": average of "
+              << ( total / switches).count() << " nano seconds";
+#ifdef BOOST_CONTEXT_CYCLE
+    std::cout << ", " << total_c / switches << " cpu cycles";
+#endif
+    std::cout << " per switch" << std::endl;
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool bind = false;
+        std::size_t count = 0, colours = 32, stride = 64;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
+            ("count,c", boost::program_options::value< std::size_t >( & count), "number of coroutines (default: 1k, 10k, 100k)")
+            ("colours,k", boost::program_options::value< std::size_t >( & colours), "colours")
+            ("stride,t", boost::program_options::value< std::size_t >( & stride), "bytes between the colours (multiple of 16)")
+            ("stack,s", boost::program_options::value< std::size_t >( & stack_size), "stack size in bytes")
+            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "rounds over all coroutines");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( bind) bind_to_processor( 0);
+
+        std::vector< std::size_t > counts;
+        if ( 0 != count) counts.push_back( count);
+        else {
+            counts.push_back( 1000);
+            counts.push_back( 10000);
+            counts.push_back( 100000);
+        }
+
+        // stacks without guard pages, 100k coroutines exceed the limit of
+        // memory mappings otherwise
+        for ( std::size_t i = 0; i < counts.size(); ++i) {
+            measure( "page aligned", counts[i],
+                     slab_allocator( stack_size, 64, false) );
+            measure( "coloured", counts[i],
+                     boost::coroutines::coloured_stack_allocator< slab_allocator >(
+                        colours, stride, slab_allocator( stack_size, 64, false) ) );
+        }
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
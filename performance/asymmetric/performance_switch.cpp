@@ -18,8 +18,8 @@
 #include "../clock.hpp"
 #include "../cycle.hpp"
 
-boost::coroutines::flag_fpu_t preserve_fpu = boost::coroutines::fpu_not_preserved;
 boost::uint64_t jobs = 1000;
+boost::coroutines::attributes attrs;
 
 struct X
 {
@@ -38,6 +38,12 @@ void fn_void( boost::coroutines::asymmetric_coroutine< void >::push_type & c)
 void fn_int( boost::coroutines::asymmetric_coroutine< int >::push_type & c)
 { while ( true) c( 7); }
 
+void fn_double( boost::coroutines::asymmetric_coroutine< double >::push_type & c)
+{ while ( true) c( 7.5); }
+
+void fn_ptr( boost::coroutines::asymmetric_coroutine< X const* >::push_type & c)
+{ while ( true) c( & x); }
+
 void fn_x( boost::coroutines::asymmetric_coroutine< X >::push_type & c)
 {
     while ( true) c( x);
@@ -46,7 +52,7 @@ void fn_x( boost::coroutines::asymmetric_coroutine< X >::push_type & c)
 duration_type measure_time_void( duration_type overhead)
 {
     boost::coroutines::asymmetric_coroutine< void >::pull_type c( fn_void,
-            boost::coroutines::attributes( preserve_fpu) );
+            attrs);
         
     time_point_type start( clock_type::now() );
     for ( std::size_t i = 0; i < jobs; ++i) {
@@ -63,7 +69,41 @@ duration_type measure_time_void( duration_type overhead)
 duration_type measure_time_int( duration_type overhead)
 {
     boost::coroutines::asymmetric_coroutine< int >::pull_type c( fn_int,
-            boost::coroutines::attributes( preserve_fpu) );
+            attrs);
+        
+    time_point_type start( clock_type::now() );
+    for ( std::size_t i = 0; i < jobs; ++i) {
+        c();
+    }
+    duration_type total = clock_type::now() - start;
+    total -= overhead_clock(); // overhead of measurement
+    total /= jobs;  // loops
+    total /= 2;  // 2x jump_fcontext
+
+    return total;
+}
+
+duration_type measure_time_double( duration_type overhead)
+{
+    boost::coroutines::asymmetric_coroutine< double >::pull_type c( fn_double,
+            attrs);
+        
+    time_point_type start( clock_type::now() );
+    for ( std::size_t i = 0; i < jobs; ++i) {
+        c();
+    }
+    duration_type total = clock_type::now() - start;
+    total -= overhead_clock(); // overhead of measurement
+    total /= jobs;  // loops
+    total /= 2;  // 2x jump_fcontext
+
+    return total;
+}
+
+duration_type measure_time_ptr( duration_type overhead)
+{
+    boost::coroutines::asymmetric_coroutine< X const* >::pull_type c( fn_ptr,
+            attrs);
         
     time_point_type start( clock_type::now() );
     for ( std::size_t i = 0; i < jobs; ++i) {
@@ -80,7 +120,7 @@ duration_type measure_time_int( duration_type overhead)
 duration_type measure_time_x( duration_type overhead)
 {
     boost::coroutines::asymmetric_coroutine< X >::pull_type c( fn_x,
-            boost::coroutines::attributes( preserve_fpu) );
+            attrs);
         
     time_point_type start( clock_type::now() );
     for ( std::size_t i = 0; i < jobs; ++i) {
@@ -98,7 +138,7 @@ duration_type measure_time_x( duration_type overhead)
 cycle_type measure_cycles_void( cycle_type overhead)
 {
     boost::coroutines::asymmetric_coroutine< void >::pull_type c( fn_void,
-            boost::coroutines::attributes( preserve_fpu) );
+            attrs);
         
     cycle_type start( cycles() );
     for ( std::size_t i = 0; i < jobs; ++i) {
@@ -115,7 +155,41 @@ cycle_type measure_cycles_void( cycle_type overhead)
 cycle_type measure_cycles_int( cycle_type overhead)
 {
     boost::coroutines::asymmetric_coroutine< int >::pull_type c( fn_int,
-            boost::coroutines::attributes( preserve_fpu) );
+            attrs);
+        
+    cycle_type start( cycles() );
+    for ( std::size_t i = 0; i < jobs; ++i) {
+        c();
+    }
+    cycle_type total = cycles() - start;
+    total -= overhead; // overhead of measurement
+    total /= jobs;  // loops
+    total /= 2;  // 2x jump_fcontext
+
+    return total;
+}
+
+cycle_type measure_cycles_double( cycle_type overhead)
+{
+    boost::coroutines::asymmetric_coroutine< double >::pull_type c( fn_double,
+            attrs);
+        
+    cycle_type start( cycles() );
+    for ( std::size_t i = 0; i < jobs; ++i) {
+        c();
+    }
+    cycle_type total = cycles() - start;
+    total -= overhead; // overhead of measurement
+    total /= jobs;  // loops
+    total /= 2;  // 2x jump_fcontext
+
+    return total;
+}
+
+cycle_type measure_cycles_ptr( cycle_type overhead)
+{
+    boost::coroutines::asymmetric_coroutine< X const* >::pull_type c( fn_ptr,
+            attrs);
         
     cycle_type start( cycles() );
     for ( std::size_t i = 0; i < jobs; ++i) {
@@ -132,7 +206,7 @@ cycle_type measure_cycles_int( cycle_type overhead)
 cycle_type measure_cycles_x( cycle_type overhead)
 {
     boost::coroutines::asymmetric_coroutine< X >::pull_type c( fn_x,
-            boost::coroutines::attributes( preserve_fpu) );
+            attrs);
         
     cycle_type start( cycles() );
     for ( std::size_t i = 0; i < jobs; ++i) {
@@ -151,12 +225,12 @@ int main( int argc, char * argv[])
 {
     try
     {
-        bool preserve = false, bind = false;
+        bool bind = false, fpu = true;
         boost::program_options::options_description desc("allowed options");
         desc.add_options()
             ("help", "help message")
             ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
-            ("fpu,f", boost::program_options::value< bool >( & preserve), "preserve FPU registers")
+            ("fpu,f", boost::program_options::value< bool >( & fpu), "preserve FPU registers")
             ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "jobs to run");
 
         boost::program_options::variables_map vm;
@@ -173,15 +247,29 @@ int main( int argc, char * argv[])
             return EXIT_SUCCESS;
         }
 
-        if ( preserve) preserve_fpu = boost::coroutines::fpu_preserved;
         if ( bind) bind_to_processor( 0);
+        if ( ! fpu) attrs.preserve_fpu = boost::coroutines::fpu_not_preserved;
 
+#if defined(BOOST_COROUTINES_HEADER_ONLY)
+        std::cout << "context switch path: header-only" << std::endl;
+#else
+        std::cout << "context switch path: library" << std::endl;
+#endif
+#if defined(BOOST_COROUTINES_HAS_FCONTEXT_NOFPU)
+        std::cout << "FPU registers " << ( fpu ? "preserved" : "not preserved") << std::endl;
+#else
+        std::cout << "FPU registers preserved" << std::endl;
+#endif
         duration_type overhead_c = overhead_clock();
         std::cout << "overhead " << overhead_c.count() << " nano seconds" << std::endl;
         boost::uint64_t res = measure_time_void( overhead_c).count();
         std::cout << "void: average of " << res << " nano seconds" << std::endl;
         res = measure_time_int( overhead_c).count();
         std::cout << "int: average of " << res << " nano seconds" << std::endl;
+        res = measure_time_double( overhead_c).count();
+        std::cout << "double: average of " << res << " nano seconds" << std::endl;
+        res = measure_time_ptr( overhead_c).count();
+        std::cout << "pointer: average of " << res << " nano seconds" << std::endl;
         res = measure_time_x( overhead_c).count();
         std::cout << "X: average of " << res << " nano seconds" << std::endl;
 #ifdef BOOST_CONTEXT_CYCLE
@@ -191,6 +279,10 @@ int main( int argc, char * argv[])
         std::cout << "void: average of " << res << " cpu cycles" << std::endl;
         res = measure_cycles_int( overhead_y);
         std::cout << "int: average of " << res << " cpu cycles" << std::endl;
+        res = measure_cycles_double( overhead_y);
+        std::cout << "double: average of " << res << " cpu cycles" << std::endl;
+        res = measure_cycles_ptr( overhead_y);
+        std::cout << "pointer: average of " << res << " cpu cycles" << std::endl;
         res = measure_cycles_x( overhead_y);
         std::cout << "X: average of " << res << " cpu cycles" << std::endl;
 #endif
@@ -0,0 +1,106 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include "../bind_processor.hpp"
+#include "../clock.hpp"
+#include "../cycle.hpp"
+#include "../perf_counter.hpp"
+
+typedef boost::coroutines::asymmetric_coroutine< void >     coro_type;
+
+boost::uint64_t jobs = 100;
+std::size_t count = 4096;
+std::size_t evict = 4; // MiB of memory read between the rounds
+
+void fn( coro_type::push_type & c)
+{ while ( true) c(); }
+
+// resumes `count` coroutines round-robin, the cache is flushed by reading
+// `evict` MiB between the rounds so that each resume finds the control
+// block of the coroutine in memory
+void measure( char const* what, perf_counter * ( * event)() )
+{
+    std::vector< coro_type::pull_type > coros;
+    coros.reserve( count);
+    for ( std::size_t i = 0; i < count; ++i)
+        coros.push_back( coro_type::pull_type( fn, boost::coroutines::attributes( boost::coroutines::stack_traits::minimum_size() ) ) );
+
+    std::vector< char > buffer( evict * 1024 * 1024, 0);
+    volatile char sink = 0;
+    boost::scoped_ptr< perf_counter > counter( event() );
+    boost::uint64_t misses = 0;
+    cycle_type total = 0;
+    for ( std::size_t j = 0; j < jobs; ++j) {
+        for ( std::size_t k = 0; k < buffer.size(); k += 64) sink += buffer[k];
+        counter->start();
+        cycle_type start( cycles() );
+        for ( std::size_t i = 0; i < count; ++i)
+            coros[i]();
+        total += cycles() - start;
+        misses += counter->stop();
+    }
+
+    const boost::uint64_t switches = jobs * count * 2; // 2x jump_fcontext
+    std::cout << "average of " << total / switches << " cycles per switch, ";
+    if ( counter->valid() )
+        std::cout << static_cast< double >( misses) / switches << " " << what << " per switch";
+    else
+        std::cout << what << " not available";
+    std::cout << std::endl;
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool bind = false;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
+            ("count,c", boost::program_options::value< std::size_t >( & count), "number of coroutines")
+            ("evict,e", boost::program_options::value< std::size_t >( & evict), "MiB read between the rounds")
+            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "rounds over all coroutines");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( bind) bind_to_processor( 0);
+
+        std::cout << "cache line: " << BOOST_COROUTINES_CACHELINE_SIZE << " bytes" << std::endl;
+        measure( "L1d load misses", perf_counter::l1d_load_misses);
+        measure( "cache misses", perf_counter::cache_misses);
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
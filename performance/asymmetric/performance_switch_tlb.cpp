@@ -0,0 +1,134 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include "../bind_processor.hpp"
+#include "../clock.hpp"
+#include "../perf_counter.hpp"
+
+typedef boost::coroutines::asymmetric_coroutine< void >     coro_type;
+typedef boost::coroutines::slab_stack_allocator             slab_allocator;
+
+boost::uint64_t jobs = 100;
+std::size_t count = 2000;
+std::size_t depth = 8; // KiB of stack touched on each resume
+
+std::size_t touch( std::size_t n)
+{
+    volatile char buffer[1024];
+    for ( std::size_t i = 0; i < sizeof( buffer); i += 64) buffer[i] = 0;
+    return 1 < n ? touch( n - 1) + buffer[0] : buffer[0];
+}
+
+void fn( coro_type::push_type & c)
+{
+    while ( true) {
+        touch( depth);
+        c();
+    }
+}
+
+// resumes `count` coroutines round-robin, each resume touches `depth` KiB
+// of the coroutine's stack
+template< typename StackAllocator >
+void measure( char const* what, StackAllocator stack_alloc)
+{
+    std::vector< coro_type::pull_type > coros;
+    coros.reserve( count);
+    for ( std::size_t i = 0; i < count; ++i)
+        coros.push_back( coro_type::pull_type( fn, boost::coroutines::attributes(), stack_alloc) );
+
+    boost::scoped_ptr< perf_counter > dtlb( perf_counter::dtlb_load_misses() );
+    dtlb->start();
+    time_point_type start( clock_type::now() );
+    for ( std::size_t j = 0; j < jobs; ++j)
+        for ( std::size_t i = 0; i < count; ++i)
+            coros[i]();
+    duration_type total = clock_type::now() - start;
+    boost::uint64_t misses = dtlb->stop();
+
+    const boost::uint64_t switches = jobs * count * 2; // 2x jump_fcontext
+    std::cout << what << ": average of " << ( total / switches).count() << " nano seconds per switch, ";
+    if ( dtlb->valid() )
+        std::cout << static_cast< double >( misses) / switches << " dTLB load misses per switch";
+    else
+        std::cout << "dTLB load misses not available";
+    std::cout << std::endl;
+}
+
+char const* backing( slab_allocator const& alloc)
+{
+    switch ( alloc.backing() ) {
+    case slab_allocator::huge_pages: return "hugetlb";
+    case slab_allocator::transparent_huge_pages: return "transparent huge pages";
+    default: return "normal pages";
+    }
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool bind = false;
+        std::size_t stack_kb = 64;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
+            ("count,c", boost::program_options::value< std::size_t >( & count), "number of coroutines")
+            ("depth,d", boost::program_options::value< std::size_t >( & depth), "KiB of stack touched per resume")
+            ("stack,s", boost::program_options::value< std::size_t >( & stack_kb), "stack size in KiB")
+            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "rounds over all coroutines");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( bind) bind_to_processor( 0);
+
+        const std::size_t stack_size = stack_kb * 1024;
+        measure( "protected_stack_allocator", boost::coroutines::protected_stack_allocator() );
+
+        slab_allocator normal( stack_size, 64, true, slab_allocator::normal_pages);
+        measure( "slab_stack_allocator (normal pages)", normal);
+
+        slab_allocator thp( stack_size, 64, false, slab_allocator::transparent_huge_pages);
+        thp.reserve( count);
+        measure( ( std::string( "slab_stack_allocator (") + backing( thp) + ")").c_str(), thp);
+
+        slab_allocator huge( stack_size, 64, false, slab_allocator::huge_pages);
+        huge.reserve( count);
+        measure( ( std::string( "slab_stack_allocator (") + backing( huge) + ")").c_str(), huge);
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
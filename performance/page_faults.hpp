@@ -0,0 +1,31 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PAGE_FAULTS_H
+#define PAGE_FAULTS_H
+
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+
+#if ! defined(BOOST_WINDOWS)
+extern "C" {
+#include <sys/resource.h>
+}
+#endif
+
+// minor page faults of the process so far (getrusage(2)), always 0 on Windows
+inline
+boost::uint64_t minor_page_faults()
+{
+#if ! defined(BOOST_WINDOWS)
+    rusage usage;
+    if ( 0 == ::getrusage( RUSAGE_SELF, & usage) )
+        return static_cast< boost::uint64_t >( usage.ru_minflt);
+#endif
+    return 0;
+}
+
+#endif // PAGE_FAULTS_H
@@ -0,0 +1,120 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef PERF_COUNTER_H
+#define PERF_COUNTER_H
+
+#include <cstring>
+
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+
+#if defined(__linux__)
+extern "C" {
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+}
+#endif
+
+// hardware event counter of the calling thread (perf_event_open(2), Linux only)
+// valid() returns false if the event is not supported or not permitted
+// (see /proc/sys/kernel/perf_event_paranoid)
+class perf_counter : private boost::noncopyable
+{
+private:
+    int     fd_;
+
+#if defined(__linux__)
+    perf_counter( boost::uint32_t type, boost::uint64_t config) :
+        fd_( -1)
+    {
+        perf_event_attr attr;
+        std::memset( & attr, 0, sizeof( attr) );
+        attr.size = sizeof( attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast< int >( ::syscall( __NR_perf_event_open, & attr, 0, -1, -1, 0) );
+    }
+
+    static boost::uint64_t cache_event( boost::uint64_t cache, boost::uint64_t op, boost::uint64_t result)
+    { return cache | ( op << 8) | ( result << 16); }
+#endif
+
+public:
+    // data TLB misses of loads
+    static perf_counter * dtlb_load_misses()
+    {
+#if defined(__linux__)
+        return new perf_counter( PERF_TYPE_HW_CACHE,
+            cache_event( PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) );
+#else
+        return new perf_counter();
+#endif
+    }
+
+    // L1 data cache misses of loads
+    static perf_counter * l1d_load_misses()
+    {
+#if defined(__linux__)
+        return new perf_counter( PERF_TYPE_HW_CACHE,
+            cache_event( PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) );
+#else
+        return new perf_counter();
+#endif
+    }
+
+    // last level cache misses
+    static perf_counter * cache_misses()
+    {
+#if defined(__linux__)
+        return new perf_counter( PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#else
+        return new perf_counter();
+#endif
+    }
+
+    perf_counter() :
+        fd_( -1)
+    {}
+
+    ~perf_counter()
+    {
+#if defined(__linux__)
+        if ( valid() ) ::close( fd_);
+#endif
+    }
+
+    bool valid() const
+    { return 0 <= fd_; }
+
+    void start()
+    {
+#if defined(__linux__)
+        if ( ! valid() ) return;
+        ::ioctl( fd_, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl( fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    boost::uint64_t stop()
+    {
+        boost::uint64_t value = 0;
+#if defined(__linux__)
+        if ( ! valid() ) return 0;
+        ::ioctl( fd_, PERF_EVENT_IOC_DISABLE, 0);
+        if ( sizeof( value) != ::read( fd_, & value, sizeof( value) ) ) value = 0;
+#endif
+        return value;
+    }
+};
+
+#endif // PERF_COUNTER_H
@@ -0,0 +1,122 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/coroutine/all.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/program_options.hpp>
+
+#include "../bind_processor.hpp"
+#include "../clock.hpp"
+#include "../cycle.hpp"
+
+boost::uint64_t jobs = 1000000;
+boost::uint64_t hops = 0;
+std::size_t count = 8;
+
+struct payload
+{
+    unsigned char data[256];
+
+    payload()
+    { std::memset( data, 0, sizeof( data) ); }
+};
+
+// receives the payload and passes it to the next coroutine of the ring
+// (move semantics, no intermediate copy), the last hop returns to main()
+template< typename T >
+void fn( typename boost::coroutines::symmetric_coroutine< T >::yield_type & yield,
+         std::vector< typename boost::coroutines::symmetric_coroutine< T >::call_type * > * ring,
+         std::size_t next)
+{
+    while ( true)
+    {
+        if ( 0 == --hops) yield();
+        else yield( * ( * ring)[next], yield.take() );
+    }
+}
+
+template< typename T >
+void measure( char const* what)
+{
+    typedef typename boost::coroutines::symmetric_coroutine< T >::call_type call_type;
+
+    std::vector< call_type * > ring;
+    for ( std::size_t i = 0; i < count; ++i)
+        ring.push_back(
+            new call_type( boost::bind( fn< T >, _1, & ring, ( i + 1) % count) ) );
+
+    hops = jobs;
+    time_point_type start( clock_type::now() );
+#ifdef BOOST_CONTEXT_CYCLE
+    cycle_type start_c( cycles() );
+#endif
+    ( * ring[0])( T() );
+#ifdef BOOST_CONTEXT_CYCLE
+    cycle_type total_c = cycles() - start_c;
+#endif
+    duration_type total = clock_type::now() - start;
+
+    std::cout << what << ": average of " << ( total / jobs).count() << " nano seconds";
+#ifdef BOOST_CONTEXT_CYCLE
+    std::cout << ", " << total_c / jobs << " cpu cycles";
+#endif
+    std::cout << " per hop" << std::endl;
+
+    for ( std::size_t i = 0; i < count; ++i)
+        delete ring[i];
+}
+
+int main( int argc, char * argv[])
+{
+    try
+    {
+        bool bind = false;
+        boost::program_options::options_description desc("allowed options");
+        desc.add_options()
+            ("help", "help message")
+            ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
+            ("count,c", boost::program_options::value< std::size_t >( & count), "coroutines of the ring")
+            ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "hops of the payload");
+
+        boost::program_options::variables_map vm;
+        boost::program_options::store(
+                boost::program_options::parse_command_line(
+                    argc,
+                    argv,
+                    desc),
+                vm);
+        boost::program_options::notify( vm);
+
+        if ( vm.count("help") ) {
+            std::cout << desc << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        if ( bind) bind_to_processor( 0);
+
+        measure< int >( "int");
+        measure< payload >( "256 byte payload");
+#if ! defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && ! defined(BOOST_NO_CXX11_SMART_PTR)
+        measure< std::unique_ptr< payload > >( "unique_ptr< payload >");
+#endif
+
+        return EXIT_SUCCESS;
+    }
+    catch ( std::exception const& e)
+    { std::cerr << "exception: " << e.what() << std::endl; }
+    catch (...)
+    { std::cerr << "unhandled exception" << std::endl; }
+    return EXIT_FAILURE;
+}
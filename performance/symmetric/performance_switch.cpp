@@ -18,8 +18,8 @@
 #include "../clock.hpp"
 #include "../cycle.hpp"
 
-boost::coroutines::flag_fpu_t preserve_fpu = boost::coroutines::fpu_not_preserved;
 boost::uint64_t jobs = 1000;
+boost::coroutines::attributes attrs;
 time_point_type end;
 
 struct X
@@ -45,7 +45,7 @@ void fn_x( boost::coroutines::symmetric_coroutine< X >::yield_type & yield)
 duration_type measure_time_void( duration_type overhead)
 {
     boost::coroutines::symmetric_coroutine< void >::call_type c( fn_void,
-            boost::coroutines::attributes( preserve_fpu) );
+            attrs);
     c();
 
     time_point_type start( clock_type::now() );
@@ -63,7 +63,7 @@ duration_type measure_time_void( duration_type overhead)
 duration_type measure_time_int( duration_type overhead)
 {
     boost::coroutines::symmetric_coroutine< int >::call_type c( fn_int,
-            boost::coroutines::attributes( preserve_fpu) );
+            attrs);
 
     time_point_type start( clock_type::now() );
     for ( std::size_t i = 0; i < jobs; ++i) {
@@ -80,7 +80,7 @@ duration_type measure_time_int( duration_type overhead)
 duration_type measure_time_x( duration_type overhead)
 {
     boost::coroutines::symmetric_coroutine< X >::call_type c( fn_x,
-            boost::coroutines::attributes( preserve_fpu) );
+            attrs);
 
     X x("abc");
     time_point_type start( clock_type::now() );
@@ -99,7 +99,7 @@ duration_type measure_time_x( duration_type overhead)
 cycle_type measure_cycles_void( cycle_type overhead)
 {
     boost::coroutines::symmetric_coroutine< void >::call_type c( fn_void,
-        boost::coroutines::attributes( preserve_fpu) );
+        attrs);
 
     cycle_type start( cycles() );
     for ( std::size_t i = 0; i < jobs; ++i) {
@@ -116,7 +116,7 @@ cycle_type measure_cycles_void( cycle_type overhead)
 cycle_type measure_cycles_int( cycle_type overhead)
 {
     boost::coroutines::symmetric_coroutine< int >::call_type c( fn_int,
-        boost::coroutines::attributes( preserve_fpu) );
+        attrs);
 
     cycle_type start( cycles() );
     for ( std::size_t i = 0; i < jobs; ++i) {
@@ -133,7 +133,7 @@ cycle_type measure_cycles_int( cycle_type overhead)
 cycle_type measure_cycles_x( cycle_type overhead)
 {
     boost::coroutines::symmetric_coroutine< X >::call_type c( fn_x,
-        boost::coroutines::attributes( preserve_fpu) );
+        attrs);
 
     X x("abc");
     cycle_type start( cycles() );
@@ -153,12 +153,12 @@ int main( int argc, char * argv[])
 {
     try
     {
-        bool preserve = false, bind = false;
+        bool bind = false, fpu = true;
         boost::program_options::options_description desc("allowed options");
         desc.add_options()
             ("help", "help message")
             ("bind,b", boost::program_options::value< bool >( & bind), "bind thread to CPU")
-            ("fpu,f", boost::program_options::value< bool >( & preserve), "preserve FPU registers")
+            ("fpu,f", boost::program_options::value< bool >( & fpu), "preserve FPU registers")
             ("jobs,j", boost::program_options::value< boost::uint64_t >( & jobs), "jobs to run");
 
         boost::program_options::variables_map vm;
@@ -175,8 +175,14 @@ int main( int argc, char * argv[])
             return EXIT_SUCCESS;
         }
 
-        if ( preserve) preserve_fpu = boost::coroutines::fpu_preserved;
         if ( bind) bind_to_processor( 0);
+        if ( ! fpu) attrs.preserve_fpu = boost::coroutines::fpu_not_preserved;
+
+#if defined(BOOST_COROUTINES_HAS_FCONTEXT_NOFPU)
+        std::cout << "FPU registers " << ( fpu ? "preserved" : "not preserved") << std::endl;
+#else
+        std::cout << "FPU registers preserved" << std::endl;
+#endif
 
         duration_type overhead_c = overhead_clock();
         std::cout << "overhead " << overhead_c.count() << " nano seconds" << std::endl;
@@ -5,9 +5,15 @@
 //          http://www.boost.org/LICENSE_1_0.txt)
 
 #include <boost/coroutine/asymmetric_coroutine.hpp>
+#include <boost/coroutine/protected_stack_allocator.hpp>
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+# include <boost/coroutine/shared_stack_allocator.hpp>
+#endif
 
 #include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -174,6 +180,46 @@ template< typename E >
 void f14( coro::asymmetric_coroutine< void >::pull_type &, E const& e)
 { throw e; }
 
+void f_hibernate( coro::asymmetric_coroutine< int >::push_type & c)
+{
+    volatile char buffer[32 * 1024];
+    for ( int i = 0; i < 8; ++i)
+    {
+        buffer[i * 4096] = static_cast< char >( i);
+        c( i + buffer[i * 4096]);
+    }
+}
+
+void f_frame( coro::asymmetric_coroutine< void * >::push_type & c)
+{
+    char local = 0;
+    c( & local);
+}
+
+// touches the pages of its frame from the top, hits the guard page of a
+// stack smaller than the buffer
+void f_deep( coro::asymmetric_coroutine< void * >::push_type & c)
+{
+    volatile char buffer[512 * 1024];
+    for ( std::size_t i = sizeof( buffer); i > 0; i -= 4096)
+        buffer[i - 1] = 1;
+    c( const_cast< char * >( & buffer[0]) );
+}
+
+void f_lazy( coro::asymmetric_coroutine< int >::push_type & c)
+{
+    ++value9;
+    c( 1);
+    c( 2);
+}
+
+void f_footprint( coro::asymmetric_coroutine< void >::push_type & c)
+{
+    // the coroutine passed to the coroutine-function has no stack of its own
+    value1 = static_cast< int >( c.stack_high_water_mark() );
+    value3 = c.hibernate();
+}
+
 void f16( coro::asymmetric_coroutine< int >::push_type & c)
 {
     c( 1);
@@ -317,6 +363,253 @@ void test_arg_string()
     BOOST_CHECK_EQUAL( std::string("abc"), value2);
 }
 
+struct point
+{
+    short x, y;
+};
+
+void f_double( coro::asymmetric_coroutine< double >::push_type & c)
+{
+    c( 1.5);
+    c( -0.25);
+}
+
+void f_pointer( coro::asymmetric_coroutine< int * >::push_type & c)
+{
+    int a = 3;
+    c( & a);
+    c( 0);
+}
+
+void f_point( coro::asymmetric_coroutine< point >::push_type & c)
+{
+    for ( short i = 0; i < 3; ++i)
+    {
+        point p = { i, static_cast< short >( -i) };
+        c( p);
+    }
+}
+
+void test_pass_by_value()
+{
+    BOOST_CHECK( coro::detail::pass_by_value< int >::value);
+    BOOST_CHECK( coro::detail::pass_by_value< double >::value);
+    BOOST_CHECK( coro::detail::pass_by_value< int * >::value);
+    BOOST_CHECK( ! coro::detail::pass_by_value< std::string >::value);
+
+    coro::asymmetric_coroutine< double >::pull_type coro1( f_double);
+    BOOST_CHECK_EQUAL( 1.5, coro1.get() );
+    coro1();
+    BOOST_CHECK( coro1);
+    BOOST_CHECK_EQUAL( -0.25, coro1.get() );
+    coro1();
+    BOOST_CHECK( ! coro1);
+    BOOST_CHECK_THROW( coro1.get(), coro::invalid_result);
+
+    // the pointer refers to the stack of the coroutine
+    coro::asymmetric_coroutine< int * >::pull_type coro2( f_pointer);
+    BOOST_CHECK_EQUAL( 3, * coro2.get() );
+    coro2();
+    BOOST_CHECK( coro2);
+    BOOST_CHECK( 0 == coro2.get() );
+
+    int sum = 0;
+    coro::asymmetric_coroutine< point >::pull_type coro3( f_point);
+    BOOST_FOREACH( point const& p, coro3)
+    { sum += 10 * p.x - p.y; }
+    BOOST_CHECK_EQUAL( 33, sum);
+
+    // the value is kept by the control block of a hibernated coroutine
+    coro::asymmetric_coroutine< double >::pull_type coro4( f_double);
+    coro4.hibernate();
+    BOOST_CHECK_EQUAL( 1.5, coro4.get() );
+    coro4();
+    BOOST_CHECK_EQUAL( -0.25, coro4.get() );
+}
+
+void f_batch_int( coro::asymmetric_coroutine< int >::push_type & c)
+{
+    int a[] = { 1, 2, 3, 4 };
+    c.yield_batch( a, a + 4);
+    ++value8;
+    c( 5);
+    c.yield_batch( a, a + 1);
+    c.yield_batch( a, a);
+    ++value8;
+}
+
+void f_batch_string( coro::asymmetric_coroutine< std::string >::push_type & c)
+{
+    std::string a[] = { "abc", "de", "f" };
+    c.yield_batch( a, a + 3);
+    c( "gh");
+    c.yield_batch( a + 1, a + 3);
+}
+
+void f_batch_sink( coro::asymmetric_coroutine< int >::pull_type & c)
+{
+    BOOST_FOREACH( int i, c)
+    { value9 = 10 * value9 + i; }
+}
+
+void test_batch()
+{
+    value8 = 0;
+
+    // the values following the first one of a batch are pulled without
+    // resuming the coroutine
+    coro::asymmetric_coroutine< int >::pull_type coro1( f_batch_int);
+    BOOST_CHECK_EQUAL( 1, coro1.get() );
+    coro1();
+    BOOST_CHECK_EQUAL( 2, coro1.get() );
+    BOOST_CHECK( ! coro1.hibernate() );
+    coro1();
+    coro1();
+    BOOST_CHECK_EQUAL( 4, coro1.get() );
+    BOOST_CHECK_EQUAL( 0, value8);
+    coro1();
+    BOOST_CHECK_EQUAL( 5, coro1.get() );
+    BOOST_CHECK_EQUAL( 1, value8);
+    coro1();
+    BOOST_CHECK_EQUAL( 1, coro1.get() );
+    coro1();
+    BOOST_CHECK( ! coro1);
+    BOOST_CHECK_EQUAL( 2, value8);
+
+    std::vector< std::string > v;
+    coro::asymmetric_coroutine< std::string >::pull_type coro2( f_batch_string);
+    BOOST_CHECK_EQUAL( std::size_t( 2), coro2.pull_n( std::back_inserter( v), 2) );
+    BOOST_CHECK_EQUAL( "f", coro2.get() );
+    BOOST_CHECK_EQUAL( std::size_t( 4), coro2.pull_n( std::back_inserter( v), 10) );
+    BOOST_CHECK( ! coro2);
+    BOOST_CHECK_EQUAL( std::size_t( 6), v.size() );
+    BOOST_CHECK_EQUAL( "abc", v[0]);
+    BOOST_CHECK_EQUAL( "f", v[2]);
+    BOOST_CHECK_EQUAL( "gh", v[3]);
+    BOOST_CHECK_EQUAL( "f", v[5]);
+    BOOST_CHECK_EQUAL( std::size_t( 0), coro2.pull_n( std::back_inserter( v), 10) );
+
+    value9 = 0;
+
+    // the first value starts the coroutine
+    int a[] = { 1, 2, 3 };
+    coro::asymmetric_coroutine< int >::push_type coro3( f_batch_sink);
+    coro3.yield_batch( a, a + 3);
+    BOOST_CHECK_EQUAL( 123, value9);
+    coro3.yield_batch( a + 1, a + 3);
+    BOOST_CHECK( coro3);
+    BOOST_CHECK_EQUAL( 12323, value9);
+}
+
+// counts the copies of the values passed to the consumer
+struct message
+{
+    static int copies;
+
+    std::string payload;
+
+    explicit message( std::string const& payload_) :
+        payload( payload_)
+    {}
+
+    message( message const& other) :
+        payload( other.payload)
+    { ++copies; }
+
+    message & operator=( message const& other)
+    {
+        payload = other.payload;
+        ++copies;
+        return * this;
+    }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    message( message && other) :
+        payload( boost::move( other.payload) )
+    {}
+
+    message & operator=( message && other)
+    {
+        payload = boost::move( other.payload);
+        return * this;
+    }
+#endif
+};
+
+int message::copies = 0;
+
+void f_take( coro::asymmetric_coroutine< message >::push_type & c)
+{
+    message m( "abc");
+    c( boost::move( m) );
+#if ! defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && ! defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES)
+    c.emplace( "de");
+#else
+    c( message( "de") );
+#endif
+}
+
+void f_take_sink( coro::asymmetric_coroutine< std::string >::pull_type & c)
+{
+    while ( c)
+    {
+        value2 += c.take();
+        c();
+    }
+}
+
+void test_take()
+{
+    message::copies = 0;
+
+    coro::asymmetric_coroutine< message >::pull_type coro1( f_take);
+    message m( coro1.take() );
+    BOOST_CHECK_EQUAL( "abc", m.payload);
+    coro1();
+    m = coro1.take();
+    BOOST_CHECK_EQUAL( "de", m.payload);
+    coro1();
+    BOOST_CHECK( ! coro1);
+    BOOST_CHECK_THROW( coro1.take(), coro::invalid_result);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    BOOST_CHECK_EQUAL( 0, message::copies);
+#endif
+
+    value2 = "";
+
+    // values pushed by the caller
+    std::string a[] = { "f", "gh" };
+    coro::asymmetric_coroutine< std::string >::push_type coro2( f_take_sink);
+    coro2( std::string( "abc") );
+    coro2.yield_batch( a, a + 2);
+    BOOST_CHECK_EQUAL( "abcfgh", value2);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    // moved out of the batch
+    BOOST_CHECK( a[1].empty() );
+#endif
+}
+
+#if ! defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && ! defined(BOOST_NO_CXX11_SMART_PTR)
+void f_unique_ptr( coro::asymmetric_coroutine< std::unique_ptr< int > >::push_type & c)
+{
+    c( std::unique_ptr< int >( new int( 3) ) );
+    c.emplace( new int( 5) );
+}
+
+void test_move_only()
+{
+    int sum = 0;
+    coro::asymmetric_coroutine< std::unique_ptr< int > >::pull_type coro( f_unique_ptr);
+    while ( coro)
+    {
+        std::unique_ptr< int > p( coro.take() );
+        sum += * p;
+        coro();
+    }
+    BOOST_CHECK_EQUAL( 8, sum);
+}
+#endif
+
 void test_fp()
 {
     value4 = 0;
@@ -434,6 +727,281 @@ void test_no_unwind()
     BOOST_CHECK_EQUAL( ( int) 7, value1);
 }
 
+void test_hibernate()
+{
+    coro::asymmetric_coroutine< int >::pull_type coro(
+        f_hibernate,
+        coro::attributes( 128 * 1024) );
+    BOOST_CHECK( ! coro.is_hibernated() );
+    for ( int i = 0; i < 8; ++i)
+    {
+        BOOST_CHECK( coro);
+        BOOST_CHECK( coro.hibernate() );
+        BOOST_CHECK( coro.is_hibernated() );
+        // hibernating twice is a no-op
+        BOOST_CHECK( coro.hibernate() );
+        BOOST_CHECK_EQUAL( ( int) 2 * i, coro.get() );
+        coro();
+        BOOST_CHECK( ! coro.is_hibernated() );
+    }
+    BOOST_CHECK( ! coro);
+    BOOST_CHECK( ! coro.hibernate() );
+}
+
+void test_hibernate_unwind()
+{
+    value1 = 0;
+    {
+        coro::asymmetric_coroutine< void >::push_type coro( f12);
+        coro();
+        BOOST_CHECK_EQUAL( ( int) 7, value1);
+        BOOST_CHECK( coro.hibernate() );
+    }
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+
+    value1 = 0;
+    {
+        coro::asymmetric_coroutine< void >::push_type coro(
+            f12,
+            coro::attributes(
+                coro::stack_allocator::traits_type::default_size(),
+                coro::no_stack_unwind) );
+        coro();
+        BOOST_CHECK_EQUAL( ( int) 7, value1);
+        BOOST_CHECK( coro.hibernate() );
+    }
+    BOOST_CHECK_EQUAL( ( int) 7, value1);
+}
+
+void test_reset()
+{
+    coro::asymmetric_coroutine< void * >::pull_type coro;
+    coro.reset( f_frame);
+    BOOST_CHECK( coro);
+    void * frame = coro.get();
+    coro();
+    BOOST_CHECK( ! coro);
+    // the stack is reused
+    coro.reset( f_frame);
+    BOOST_CHECK( coro);
+    BOOST_CHECK_EQUAL( frame, coro.get() );
+    // a stack of another allocator type is not
+    coro.reset( f_frame, coro::attributes(), coro::protected_stack_allocator() );
+    BOOST_CHECK( coro);
+    BOOST_CHECK( frame != coro.get() );
+
+    // a stack smaller than requested is replaced
+    coro.reset( f_deep,
+                coro::attributes( coro::stack_allocator::traits_type::default_size() + 1024 * 1024),
+                coro::protected_stack_allocator() );
+    BOOST_CHECK( coro);
+    BOOST_CHECK( 0 != coro.get() );
+    coro.reset( f_frame, coro::attributes(), coro::protected_stack_allocator() );
+    frame = coro.get();
+    // a larger stack is kept
+    coro.reset( f_frame, coro::attributes(), coro::protected_stack_allocator() );
+    BOOST_CHECK_EQUAL( frame, coro.get() );
+
+    // a suspended coroutine is unwound
+    value1 = 0;
+    coro::asymmetric_coroutine< void >::push_type push( f12);
+    push();
+    BOOST_CHECK_EQUAL( ( int) 7, value1);
+    push.reset( f12);
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+    BOOST_CHECK( push);
+    push();
+    BOOST_CHECK_EQUAL( ( int) 7, value1);
+
+    // function-objects
+    value3 = false;
+    coro::asymmetric_coroutine< int >::pull_type pull( copyable( 1) );
+    BOOST_CHECK( value3);
+    value3 = false;
+    pull.reset( copyable( 1) );
+    BOOST_CHECK( value3);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    value3 = false;
+    pull.reset( moveable( 1) );
+    BOOST_CHECK( value3);
+#endif
+}
+
+void test_lazy_start()
+{
+    coro::attributes attrs;
+    attrs.start = coro::start_lazy;
+
+    // an unused coroutine never runs
+    value9 = 0;
+    {
+        coro::asymmetric_coroutine< int >::pull_type coro( f_lazy, attrs);
+        BOOST_CHECK_EQUAL( ( int) 0, value9);
+        BOOST_CHECK( ! coro.is_hibernated() );
+    }
+    BOOST_CHECK_EQUAL( ( int) 0, value9);
+
+    // the first use starts the coroutine as if it was started eagerly
+    coro::asymmetric_coroutine< int >::pull_type coro1( f_lazy, attrs);
+    BOOST_CHECK_EQUAL( 1, coro1.get() );
+    BOOST_CHECK_EQUAL( ( int) 1, value9);
+    coro1();
+    BOOST_CHECK( coro1);
+    BOOST_CHECK_EQUAL( 2, coro1.get() );
+    coro1();
+    BOOST_CHECK( ! coro1);
+    BOOST_CHECK_EQUAL( ( int) 1, value9);
+
+    // the first operator() only starts the coroutine
+    value9 = 0;
+    coro::asymmetric_coroutine< int >::pull_type coro2( f_lazy, attrs);
+    coro2();
+    BOOST_CHECK_EQUAL( ( int) 1, value9);
+    BOOST_CHECK_EQUAL( 1, coro2.get() );
+    coro2();
+    BOOST_CHECK_EQUAL( 2, coro2.get() );
+
+    // moving does not start the coroutine
+    value9 = 0;
+    coro::asymmetric_coroutine< int >::pull_type coro3( f_lazy, attrs);
+    coro::asymmetric_coroutine< int >::pull_type coro4( boost::move( coro3) );
+    BOOST_CHECK_EQUAL( ( int) 0, value9);
+    int sum = 0;
+    for ( coro::asymmetric_coroutine< int >::pull_type::iterator i = boost::begin( coro4);
+          i != boost::end( coro4); ++i)
+        sum += * i;
+    BOOST_CHECK_EQUAL( 3, sum);
+    BOOST_CHECK_EQUAL( ( int) 1, value9);
+
+    // stack allocator and function-object
+    value3 = false;
+    coro::asymmetric_coroutine< int >::pull_type coro5(
+        copyable( 1), attrs, coro::protected_stack_allocator() );
+    BOOST_CHECK( ! value3);
+    // testing for completion does not start the coroutine
+    BOOST_CHECK( coro5);
+    BOOST_CHECK( ! value3);
+    BOOST_CHECK_THROW( coro5.get(), coro::invalid_result);
+    BOOST_CHECK( value3);
+    BOOST_CHECK( ! coro5);
+
+    // a coroutine without values
+    value1 = 0;
+    coro::asymmetric_coroutine< void >::pull_type coro6( f2, attrs);
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+    BOOST_CHECK( coro6);
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+    // completes while started
+    coro6();
+    BOOST_CHECK_EQUAL( ( int) 1, value1);
+    BOOST_CHECK( ! coro6);
+
+    // reset() defers the start, too
+    value9 = 0;
+    coro::asymmetric_coroutine< int >::pull_type coro7( f_lazy);
+    BOOST_CHECK_EQUAL( ( int) 1, value9);
+    coro7.reset( f_lazy, attrs);
+    BOOST_CHECK_EQUAL( ( int) 1, value9);
+    BOOST_CHECK( coro7);
+    BOOST_CHECK( ! coro7.is_hibernated() );
+    BOOST_CHECK_EQUAL( 0u, coro7.stack_high_water_mark() );
+    coro7();
+    BOOST_CHECK_EQUAL( ( int) 2, value9);
+    BOOST_CHECK_EQUAL( 1, coro7.get() );
+    coro7();
+    BOOST_CHECK_EQUAL( 2, coro7.get() );
+    coro7.reset( f_lazy, attrs, coro::protected_stack_allocator() );
+    BOOST_CHECK_EQUAL( ( int) 2, value9);
+    BOOST_CHECK_EQUAL( 1, coro7.get() );
+    BOOST_CHECK_EQUAL( ( int) 3, value9);
+    // resetting an unused coroutine does not start it
+    coro7.reset( f_lazy, attrs);
+    coro7.reset( f_lazy);
+    BOOST_CHECK_EQUAL( ( int) 4, value9);
+    BOOST_CHECK_EQUAL( 1, coro7.get() );
+}
+
+void f_nofpu( coro::asymmetric_coroutine< int >::push_type & c)
+{
+    for ( int i = 1; i <= 3; ++i) c( i);
+}
+
+// resumes a coroutine preserving the FPU from a coroutine which does not
+void f_nofpu_nested( coro::asymmetric_coroutine< int >::push_type & c)
+{
+    coro::asymmetric_coroutine< int >::pull_type inner( f_nofpu);
+    for ( ; inner; inner()) c( 10 * inner.get() );
+    value1 = 1;
+}
+
+void f_nofpu_unwind( coro::asymmetric_coroutine< int >::push_type & c)
+{
+    X x;
+    for (;;) c( 7);
+}
+
+void test_fpu_not_preserved()
+{
+    coro::attributes attrs;
+    attrs.preserve_fpu = coro::fpu_not_preserved;
+
+    std::vector< int > vec;
+    coro::asymmetric_coroutine< int >::pull_type coro1( f_nofpu, attrs);
+    for ( ; coro1; coro1()) vec.push_back( coro1.get() );
+    BOOST_CHECK_EQUAL( ( std::size_t) 3, vec.size() );
+    BOOST_CHECK_EQUAL( 3, vec.back() );
+
+    // contexts switched by different functions
+    value1 = 0;
+    vec.clear();
+    coro::asymmetric_coroutine< int >::pull_type coro2( f_nofpu_nested, attrs);
+    for ( ; coro2; coro2()) vec.push_back( coro2.get() );
+    BOOST_CHECK_EQUAL( ( std::size_t) 3, vec.size() );
+    BOOST_CHECK_EQUAL( 30, vec.back() );
+    BOOST_CHECK_EQUAL( ( int) 1, value1);
+
+    // the stack is unwound
+    value1 = 0;
+    {
+        coro::asymmetric_coroutine< int >::pull_type coro3( f_nofpu_unwind, attrs);
+        BOOST_CHECK_EQUAL( 7, coro3.get() );
+        BOOST_CHECK_EQUAL( ( int) 7, value1);
+    }
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+    // coroutines on a shared stack ignore the attribute
+    coro::shared_stack_allocator shared_alloc;
+    vec.clear();
+    coro::asymmetric_coroutine< int >::pull_type coro4( f_nofpu, attrs, shared_alloc);
+    coro::asymmetric_coroutine< int >::pull_type coro5( f_nofpu_nested, attrs);
+    for ( ; coro4 && coro5; coro4(), coro5())
+        vec.push_back( coro4.get() + coro5.get() );
+    BOOST_CHECK_EQUAL( ( std::size_t) 3, vec.size() );
+    BOOST_CHECK_EQUAL( 33, vec.back() );
+#endif
+
+    // floating-point arithmetic of the caller
+    value4 = 0.5;
+    coro::asymmetric_coroutine< int >::pull_type coro6( f_nofpu, attrs);
+    for ( ; coro6; coro6()) value4 *= coro6.get();
+    BOOST_CHECK_EQUAL( 3., value4);
+}
+
+void test_footprint()
+{
+#if ! defined(BOOST_USE_SEGMENTED_STACKS)
+    // the context of the caller is the suspended execution-context only
+    BOOST_CHECK_EQUAL( sizeof( boost::context::detail::fcontext_t) + sizeof( void *),
+                       sizeof( coro::detail::coroutine_context) );
+#endif
+    value1 = -1;
+    value3 = true;
+    coro::asymmetric_coroutine< void >::pull_type coro( f_footprint);
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+    BOOST_CHECK( ! value3);
+}
+
 void test_exceptions()
 {
     bool thrown = false;
@@ -610,6 +1178,12 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
     test->add( BOOST_TEST_CASE( & test_arg_int) );
     test->add( BOOST_TEST_CASE( & test_arg_string) );
     test->add( BOOST_TEST_CASE( & test_fp) );
+    test->add( BOOST_TEST_CASE( & test_pass_by_value) );
+    test->add( BOOST_TEST_CASE( & test_batch) );
+    test->add( BOOST_TEST_CASE( & test_take) );
+#if ! defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && ! defined(BOOST_NO_CXX11_SMART_PTR)
+    test->add( BOOST_TEST_CASE( & test_move_only) );
+#endif
     test->add( BOOST_TEST_CASE( & test_ptr) );
     test->add( BOOST_TEST_CASE( & test_const_ptr) );
     test->add( BOOST_TEST_CASE( & test_invalid_result) );
@@ -618,6 +1192,12 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
     test->add( BOOST_TEST_CASE( & test_tuple) );
     test->add( BOOST_TEST_CASE( & test_unwind) );
     test->add( BOOST_TEST_CASE( & test_no_unwind) );
+    test->add( BOOST_TEST_CASE( & test_hibernate) );
+    test->add( BOOST_TEST_CASE( & test_hibernate_unwind) );
+    test->add( BOOST_TEST_CASE( & test_reset) );
+    test->add( BOOST_TEST_CASE( & test_lazy_start) );
+    test->add( BOOST_TEST_CASE( & test_fpu_not_preserved) );
+    test->add( BOOST_TEST_CASE( & test_footprint) );
     test->add( BOOST_TEST_CASE( & test_exceptions) );
     test->add( BOOST_TEST_CASE( & test_input_iterator) );
     test->add( BOOST_TEST_CASE( & test_output_iterator) );
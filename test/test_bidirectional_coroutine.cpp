@@ -0,0 +1,324 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/coroutine/bidirectional_coroutine.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <boost/assert.hpp>
+#include <boost/bind.hpp>
+#include <boost/move/move.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace coro = boost::coroutines;
+
+typedef coro::bidirectional_coroutine< int, int >                   coro_int;
+typedef coro::bidirectional_coroutine< std::string, std::string >   coro_string;
+
+int value1 = 0;
+int value2 = 0;
+int copies = 0;
+
+struct Y
+{
+    Y()
+    { value2 = 7; }
+
+    ~Y()
+    { value2 = 0; }
+};
+
+struct message
+{
+    std::string data;
+
+    message() :
+        data()
+    {}
+
+    message( std::string const& data_) :
+        data( data_)
+    {}
+
+    message( message const& other) :
+        data( other.data)
+    { ++copies; }
+
+    message & operator=( message const& other)
+    {
+        data = other.data;
+        ++copies;
+        return * this;
+    }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    message( message && other) :
+        data( boost::move( other.data) )
+    {}
+
+    message & operator=( message && other)
+    {
+        data = boost::move( other.data);
+        return * this;
+    }
+#endif
+};
+
+typedef coro::bidirectional_coroutine< message, message >           coro_message;
+
+// running sum of the requests
+void f1( coro_int::yield_type & yield)
+{
+    int sum = 0;
+    while ( true)
+    {
+        sum += yield.get();
+        yield( sum);
+    }
+}
+
+// answers two requests
+void f2( coro_int::yield_type & yield)
+{
+    ++value1;
+    yield( 2 * yield.get() );
+    ++value1;
+    yield( 2 * yield.get() );
+    ++value1;
+}
+
+void f3( coro_int::yield_type & yield)
+{
+    if ( 0 > yield.get() ) throw std::runtime_error("negative");
+    yield( yield.get() );
+    throw std::runtime_error("abc");
+}
+
+void f4( coro_int::yield_type & yield)
+{
+    Y y;
+    yield( yield.get() );
+    yield( yield.get() );
+}
+
+void f5( coro_string::yield_type & yield)
+{
+    while ( true)
+        yield( "echo: " + yield.get() );
+}
+
+void f6( coro_message::yield_type & yield)
+{
+    while ( true)
+    {
+        message m( yield.take() );
+        m.data += "!";
+        yield( boost::move( m) );
+    }
+}
+
+void f7( coro_int::yield_type & yield, int factor)
+{
+    while ( true)
+        yield( factor * yield.get() );
+}
+
+#if ! defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && ! defined(BOOST_NO_CXX11_SMART_PTR)
+typedef coro::bidirectional_coroutine< std::unique_ptr< int >, std::unique_ptr< int > >    coro_ptr;
+
+void f8( coro_ptr::yield_type & yield)
+{
+    while ( true)
+    {
+        std::unique_ptr< int > p( yield.take() );
+        * p += 1;
+        yield( std::move( p) );
+    }
+}
+#endif
+
+void test_move()
+{
+    coro_int::call_type coro1;
+    BOOST_CHECK( ! coro1);
+    coro_int::call_type coro2( f1);
+    BOOST_CHECK( coro2);
+    coro1 = boost::move( coro2);
+    BOOST_CHECK( coro1);
+    BOOST_CHECK( ! coro2);
+    BOOST_CHECK_EQUAL( ( int) 3, coro1( 3).get() );
+}
+
+void test_exchange()
+{
+    coro_int::call_type coro( f1);
+    BOOST_CHECK( ! coro.has_result() );
+    BOOST_CHECK_EQUAL( ( int) 1, coro( 1).get() );
+    BOOST_CHECK_EQUAL( ( int) 3, coro( 2).get() );
+    BOOST_CHECK_EQUAL( ( int) 6, coro( 3).get() );
+    BOOST_CHECK( coro);
+
+    coro_string::call_type echo( f5);
+    BOOST_CHECK_EQUAL( std::string("echo: abc"), echo( "abc").get() );
+    BOOST_CHECK_EQUAL( std::string("echo: xyz"), echo( std::string("xyz") ).get() );
+
+    coro_int::call_type triple( boost::bind( f7, _1, 3) );
+    BOOST_CHECK_EQUAL( ( int) 21, triple( 7).get() );
+}
+
+void test_complete()
+{
+    value1 = 0;
+
+    coro_int::call_type coro( f2);
+    BOOST_CHECK_EQUAL( ( int) 0, value1);
+    BOOST_CHECK_EQUAL( ( int) 2, coro( 1).get() );
+    BOOST_CHECK_EQUAL( ( int) 1, value1);
+    BOOST_CHECK( coro);
+    BOOST_CHECK_EQUAL( ( int) 4, coro( 2).get() );
+    BOOST_CHECK_EQUAL( ( int) 2, value1);
+    BOOST_CHECK( coro);
+    // the coroutine completes without a response
+    coro( 3);
+    BOOST_CHECK_EQUAL( ( int) 3, value1);
+    BOOST_CHECK( ! coro);
+    BOOST_CHECK( ! coro.has_result() );
+    BOOST_CHECK_THROW( coro.get(), coro::invalid_result);
+}
+
+void test_exceptions()
+{
+    std::string msg;
+    coro_int::call_type coro( f3);
+    BOOST_CHECK_EQUAL( ( int) 5, coro( 5).get() );
+    try
+    { coro( 6); }
+    catch ( std::runtime_error const& ex)
+    { msg = ex.what(); }
+    BOOST_CHECK( ! coro);
+    BOOST_CHECK_EQUAL( std::string("abc"), msg);
+
+    msg.clear();
+    coro_int::call_type coro_neg( f3);
+    try
+    { coro_neg( -1); }
+    catch ( std::runtime_error const& ex)
+    { msg = ex.what(); }
+    BOOST_CHECK( ! coro_neg);
+    BOOST_CHECK_EQUAL( std::string("negative"), msg);
+}
+
+void test_unwind()
+{
+    value2 = 0;
+    {
+        coro_int::call_type coro( f4);
+        BOOST_CHECK_EQUAL( ( int) 0, value2);
+        BOOST_CHECK_EQUAL( ( int) 1, coro( 1).get() );
+        BOOST_CHECK( coro);
+        BOOST_CHECK_EQUAL( ( int) 7, value2);
+    }
+    BOOST_CHECK_EQUAL( ( int) 0, value2);
+}
+
+void test_no_unwind()
+{
+    value2 = 0;
+    {
+        coro_int::call_type coro(
+            f4,
+            coro::attributes(
+                coro::stack_allocator::traits_type::default_size(),
+                coro::no_stack_unwind) );
+        BOOST_CHECK_EQUAL( ( int) 0, value2);
+        coro( 1);
+        BOOST_CHECK_EQUAL( ( int) 7, value2);
+    }
+    BOOST_CHECK_EQUAL( ( int) 7, value2);
+}
+
+void test_fpu_not_preserved()
+{
+    coro::attributes attrs;
+    attrs.preserve_fpu = coro::fpu_not_preserved;
+    coro_int::call_type coro( f1, attrs);
+    BOOST_CHECK_EQUAL( ( int) 4, coro( 4).get() );
+    BOOST_CHECK_EQUAL( ( int) 9, coro( 5).get() );
+}
+
+void test_hibernate()
+{
+    coro_int::call_type coro(
+        f1,
+        coro::attributes( 128 * 1024) );
+    // not started yet
+    BOOST_CHECK( coro.hibernate() );
+    int sum = 0;
+    for ( int i = 0; i < 8; ++i)
+    {
+        sum += i;
+        coro( i);
+        BOOST_CHECK( coro.hibernate() );
+        BOOST_CHECK( coro.is_hibernated() );
+        // the response is kept while the stack is hibernated
+        BOOST_CHECK_EQUAL( sum, coro.get() );
+    }
+    BOOST_CHECK( coro);
+}
+
+void test_take()
+{
+    coro_message::call_type coro( f6);
+    message m( "abc");
+    copies = 0;
+    // request and response are passed without a copy
+    BOOST_CHECK_EQUAL( std::string("abc!"), coro( boost::move( m) ).take().data);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    BOOST_CHECK_EQUAL( ( int) 0, copies);
+#endif
+    message m2( "xyz");
+    copies = 0;
+    // the request is copied
+    BOOST_CHECK_EQUAL( std::string("xyz!"), coro( m2).take().data);
+    BOOST_CHECK_EQUAL( std::string("xyz"), m2.data);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    BOOST_CHECK_EQUAL( ( int) 1, copies);
+#endif
+}
+
+#if ! defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && ! defined(BOOST_NO_CXX11_SMART_PTR)
+void test_move_only()
+{
+    coro_ptr::call_type coro( f8);
+    std::unique_ptr< int > p( coro( std::unique_ptr< int >( new int( 3) ) ).take() );
+    BOOST_CHECK_EQUAL( 4, * p);
+    p = coro( std::move( p) ).take();
+    BOOST_CHECK_EQUAL( 5, * p);
+}
+#endif
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: bidirectional coroutine test suite");
+
+    test->add( BOOST_TEST_CASE( & test_move) );
+    test->add( BOOST_TEST_CASE( & test_exchange) );
+    test->add( BOOST_TEST_CASE( & test_complete) );
+    test->add( BOOST_TEST_CASE( & test_exceptions) );
+    test->add( BOOST_TEST_CASE( & test_unwind) );
+    test->add( BOOST_TEST_CASE( & test_no_unwind) );
+    test->add( BOOST_TEST_CASE( & test_fpu_not_preserved) );
+    test->add( BOOST_TEST_CASE( & test_hibernate) );
+    test->add( BOOST_TEST_CASE( & test_take) );
+#if ! defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && ! defined(BOOST_NO_CXX11_SMART_PTR)
+    test->add( BOOST_TEST_CASE( & test_move_only) );
+#endif
+
+    return test;
+}
@@ -0,0 +1,1103 @@
+
+//          Copyright Oliver Kowalke 2009.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <boost/coroutine/all.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/assert.hpp>
+#include <boost/test/unit_test.hpp>
+
+#if ! defined(BOOST_NO_CXX11_HDR_ATOMIC) && ! defined(BOOST_NO_CXX11_THREAD_LOCAL) && ! defined(BOOST_NO_CXX11_HDR_THREAD)
+# include <thread>
+# define BOOST_COROUTINES_TEST_MAGAZINE
+#endif
+
+namespace coro = boost::coroutines;
+
+int value1 = 0;
+
+void f1( coro::asymmetric_coroutine< int >::push_type & c)
+{
+    c( 1);
+    c( 2);
+}
+
+void f2( coro::symmetric_coroutine< int >::yield_type & yield)
+{ value1 = yield.get(); }
+
+std::size_t touch( std::size_t n)
+{
+    volatile char buffer[1024];
+    for ( std::size_t i = 0; i < sizeof( buffer); ++i) buffer[i] = 0;
+    return 1 < n ? touch( n - 1) + buffer[0] : buffer[0];
+}
+
+void f3( coro::asymmetric_coroutine< void >::push_type & c)
+{
+    touch( 16);
+    c();
+}
+
+void f4( coro::symmetric_coroutine< void >::yield_type & yield)
+{
+    touch( 16);
+    yield();
+}
+
+void f5( coro::asymmetric_coroutine< void >::pull_type & c)
+{
+    touch( 16);
+    c();
+}
+
+void test_painted()
+{
+    coro::stack_usage_histogram histogram;
+    coro::painted_stack_allocator<> alloc( coro::stack_allocator(), & histogram);
+    {
+        coro::asymmetric_coroutine< void >::pull_type c( f3, coro::attributes(), alloc);
+        std::size_t used = c.stack_high_water_mark();
+        BOOST_CHECK( 16 * 1024 <= used);
+        BOOST_CHECK( coro::attributes().size > used);
+        c();
+        BOOST_CHECK( ! c);
+        BOOST_CHECK_EQUAL( used, c.stack_high_water_mark() );
+    }
+    BOOST_CHECK_EQUAL( std::size_t( 1), histogram.samples() );
+    BOOST_CHECK( 16 * 1024 <= histogram.max() );
+    {
+        coro::symmetric_coroutine< void >::call_type c( f4, coro::attributes(), alloc);
+        BOOST_CHECK( 1024 > c.stack_high_water_mark() );
+        c();
+        BOOST_CHECK( 16 * 1024 <= c.stack_high_water_mark() );
+    }
+    BOOST_CHECK_EQUAL( std::size_t( 2), histogram.samples() );
+    {
+        // no marker, the stack was not painted
+        coro::asymmetric_coroutine< void >::pull_type c( f3);
+        BOOST_CHECK_EQUAL( std::size_t( 0), c.stack_high_water_mark() );
+    }
+
+    std::ostringstream os;
+    histogram.dump( os);
+    BOOST_CHECK( std::string::npos != os.str().find( "2 stacks") );
+    histogram.reset();
+    BOOST_CHECK_EQUAL( std::size_t( 0), histogram.samples() );
+}
+
+void test_prefault()
+{
+    coro::stack_usage_histogram histogram;
+    coro::painted_stack_allocator<> alloc( coro::stack_allocator(), & histogram);
+    coro::attributes attrs;
+    attrs.prefault = 32 * 1024;
+    {
+        // the content of the stack is preserved
+        coro::symmetric_coroutine< void >::call_type c( f4, attrs, alloc);
+        BOOST_CHECK( 1024 > c.stack_high_water_mark() );
+    }
+    // larger than the stack, the lowest page is not touched
+    attrs.prefault = 2 * attrs.size;
+    coro::asymmetric_coroutine< void >::pull_type c( f3, attrs, coro::protected_stack_allocator() );
+    c();
+    BOOST_CHECK( ! c);
+}
+
+void f6( coro::asymmetric_coroutine< char * >::push_type & c)
+{
+    char local = 0;
+    c( & local);
+}
+
+struct request
+{
+    coro::fixed_stack< 64 * 1024 >                      stack;
+    coro::asymmetric_coroutine< char * >::pull_type     source;
+
+    request() :
+        stack(),
+        source( f6, coro::attributes(), stack.allocator() )
+    {}
+};
+
+void test_fixed_stack()
+{
+    {
+        request r;
+        // the coroutine runs on the stack embedded in the request
+        char * first = static_cast< char * >( r.stack.data() );
+        BOOST_CHECK( first < r.source.get() );
+        BOOST_CHECK( first + 64 * 1024 > r.source.get() );
+    }
+
+    // stacks carved from an arena
+    std::vector< char > arena( 64 * 1024);
+    coro::fixed_stack_allocator<> alloc1( & arena[0], 32 * 1024);
+    coro::fixed_stack_allocator< 32 * 1024 > alloc2( & arena[32 * 1024], 32 * 1024);
+    BOOST_CHECK( & arena[32 * 1024] == alloc1.context().sp);
+    value1 = 0;
+    {
+        coro::symmetric_coroutine< int >::call_type c( f2, coro::attributes(), alloc1);
+        c( 3);
+    }
+    BOOST_CHECK_EQUAL( 3, value1);
+    {
+        coro::asymmetric_coroutine< void >::push_type c( f5, coro::attributes(), alloc2);
+        c();
+        c();
+        BOOST_CHECK( ! c);
+    }
+    // the memory is reused by the next coroutine
+    coro::fixed_stack_allocator<> alloc3( alloc1.context() );
+    coro::asymmetric_coroutine< void >::pull_type c( f3, coro::attributes(), alloc3);
+    c();
+    BOOST_CHECK( ! c);
+}
+
+class counting_stack_resource : public coro::stack_resource
+{
+private:
+    coro::stack_resource    *   upstream_;
+
+protected:
+    void do_allocate( coro::stack_context & ctx, coro::attributes const& attrs)
+    {
+        upstream_->allocate( ctx, attrs);
+        ++allocated;
+    }
+
+    void do_deallocate( coro::stack_context & ctx)
+    {
+        upstream_->deallocate( ctx);
+        ++deallocated;
+    }
+
+public:
+    int     allocated;
+    int     deallocated;
+
+    counting_stack_resource() :
+        upstream_( coro::get_default_stack_resource() ),
+        allocated( 0), deallocated( 0)
+    {}
+};
+
+void test_stack_resource()
+{
+    BOOST_CHECK_EQUAL( sizeof( void *), sizeof( coro::polymorphic_stack_allocator) );
+
+    // the default resource is used by all coroutine types
+    counting_stack_resource counting;
+    coro::stack_resource * previous = coro::set_default_stack_resource( & counting);
+    {
+        coro::asymmetric_coroutine< int >::pull_type c1( f1, coro::attributes(), coro::polymorphic_stack_allocator() );
+        coro::asymmetric_coroutine< void >::push_type c2( f5, coro::attributes(), coro::polymorphic_stack_allocator() );
+        coro::symmetric_coroutine< int >::call_type c3( f2, coro::attributes(), coro::polymorphic_stack_allocator() );
+        BOOST_CHECK_EQUAL( 3, counting.allocated);
+    }
+    BOOST_CHECK_EQUAL( 3, counting.deallocated);
+    BOOST_CHECK( & counting == coro::set_default_stack_resource( 0) );
+    BOOST_CHECK( previous == coro::get_default_stack_resource() );
+
+    // stacks are reused by the pool
+    coro::pooled_stack_resource pooled;
+    for ( int i = 0; i < 2; ++i)
+    {
+        coro::asymmetric_coroutine< void >::pull_type c( f3, coro::attributes(), coro::polymorphic_stack_allocator( & pooled) );
+        c();
+        BOOST_CHECK( ! c);
+    }
+    BOOST_CHECK_EQUAL( std::size_t( 1), pooled.allocator().hits() );
+}
+
+void test_monotonic_stack_resource()
+{
+    // stacks carved one below the other from the buffer
+    std::vector< char > buffer( 64 * 1024);
+    coro::monotonic_stack_resource from_buffer( & buffer[0], buffer.size() );
+    {
+        coro::attributes attrs( 16 * 1024);
+        coro::asymmetric_coroutine< char * >::pull_type c1( f6, attrs, coro::polymorphic_stack_allocator( & from_buffer) );
+        coro::asymmetric_coroutine< char * >::pull_type c2( f6, attrs, coro::polymorphic_stack_allocator( & from_buffer) );
+        BOOST_CHECK( & buffer[48 * 1024] < c1.get() );
+        BOOST_CHECK( & buffer[32 * 1024] < c2.get() );
+        BOOST_CHECK( & buffer[48 * 1024] > c2.get() );
+    }
+
+    // chunks of the upstream resource (two stacks per chunk), handed back by
+    // release()
+    counting_stack_resource counting;
+    coro::monotonic_stack_resource from_upstream( 80 * 1024, & counting);
+    {
+        coro::attributes attrs( 32 * 1024);
+        coro::asymmetric_coroutine< void >::pull_type c1( f3, attrs, coro::polymorphic_stack_allocator( & from_upstream) );
+        coro::asymmetric_coroutine< void >::pull_type c2( f3, attrs, coro::polymorphic_stack_allocator( & from_upstream) );
+        coro::asymmetric_coroutine< void >::pull_type c3( f3, attrs, coro::polymorphic_stack_allocator( & from_upstream) );
+        BOOST_CHECK_EQUAL( 2, counting.allocated);
+    }
+    BOOST_CHECK_EQUAL( 0, counting.deallocated);
+    from_upstream.release();
+    BOOST_CHECK_EQUAL( 2, counting.deallocated);
+}
+
+void test_coloured()
+{
+    typedef coro::coloured_stack_allocator< coro::protected_stack_allocator > allocator_type;
+    allocator_type alloc( 4, 64);
+    coro::stack_context sctx[8];
+    for ( std::size_t i = 0; i < 8; ++i)
+        alloc.allocate( sctx[i], coro::stack_traits::default_size() );
+    for ( std::size_t i = 0; i < 4; ++i)
+    {
+        const std::size_t offset = reinterpret_cast< std::size_t >( sctx[i].sp) % 4096;
+        // consecutive stacks get different offsets, the colours repeat
+        BOOST_CHECK( offset != reinterpret_cast< std::size_t >( sctx[( i + 1) % 4].sp) % 4096);
+        BOOST_CHECK_EQUAL( offset, reinterpret_cast< std::size_t >( sctx[i + 4].sp) % 4096);
+        BOOST_CHECK_EQUAL( std::size_t( 0), reinterpret_cast< std::size_t >( sctx[i].sp) % 16);
+    }
+    for ( std::size_t i = 0; i < 8; ++i)
+        alloc.deallocate( sctx[i]);
+
+    for ( int i = 0; i < 8; ++i)
+    {
+        coro::asymmetric_coroutine< int >::pull_type c( f1, coro::attributes(), alloc);
+        BOOST_CHECK_EQUAL( 1, c.get() );
+    }
+
+    // all instantiations take the colours from one counter
+    allocator_type alloc2( 2, 64);
+    coro::coloured_stack_allocator< coro::pooled_protected_stack_allocator > other( 2, 64);
+    alloc2.allocate( sctx[0], coro::stack_traits::default_size() );
+    other.allocate( sctx[1], coro::stack_traits::default_size() );
+    alloc2.allocate( sctx[2], coro::stack_traits::default_size() );
+    BOOST_CHECK_EQUAL( reinterpret_cast< std::size_t >( sctx[0].sp) % 4096,
+                       reinterpret_cast< std::size_t >( sctx[2].sp) % 4096);
+    alloc2.deallocate( sctx[2]);
+    other.deallocate( sctx[1]);
+    alloc2.deallocate( sctx[0]);
+
+    // the attributes are forwarded
+    coro::coloured_stack_allocator< coro::adaptive_stack_allocator > adaptive( 2, 64);
+    coro::attributes attrs;
+    attrs.kind = 42;
+    {
+        coro::asymmetric_coroutine< int >::pull_type c( f1, attrs, adaptive);
+        BOOST_CHECK_EQUAL( 1, c.get() );
+    }
+    BOOST_CHECK_EQUAL( std::size_t( 1), adaptive.allocator().samples( 42) );
+}
+
+void test_pooled_reuse()
+{
+    coro::pooled_protected_stack_allocator alloc;
+    coro::stack_context sctx1;
+    alloc.allocate( sctx1, coro::stack_traits::default_size() );
+    BOOST_CHECK( 0 != sctx1.sp);
+    BOOST_CHECK( coro::stack_traits::default_size() <= sctx1.size);
+    BOOST_CHECK_EQUAL( std::size_t( 0), alloc.hits() );
+    BOOST_CHECK_EQUAL( std::size_t( 1), alloc.misses() );
+    std::memset( static_cast< char * >( sctx1.sp) - sctx1.size + coro::stack_traits::page_size(),
+                 0, sctx1.size - coro::stack_traits::page_size() );
+
+    void * sp = sctx1.sp;
+    std::size_t size = sctx1.size;
+    alloc.deallocate( sctx1);
+    BOOST_CHECK_EQUAL( size, alloc.cached_bytes() );
+
+    coro::stack_context sctx2;
+    alloc.allocate( sctx2, coro::stack_traits::default_size() );
+    BOOST_CHECK_EQUAL( sp, sctx2.sp);
+    BOOST_CHECK_EQUAL( size, sctx2.size);
+    BOOST_CHECK_EQUAL( std::size_t( 1), alloc.hits() );
+    BOOST_CHECK_EQUAL( std::size_t( 0), alloc.cached_bytes() );
+    alloc.deallocate( sctx2);
+
+    alloc.release();
+    BOOST_CHECK_EQUAL( std::size_t( 0), alloc.cached_bytes() );
+}
+
+// smallest size class which can hold a stack of minimum size
+std::size_t min_class_size()
+{
+    const std::size_t page_size = coro::stack_traits::page_size();
+    std::size_t size = page_size;
+    while ( size < coro::stack_traits::minimum_size() ) size *= 2;
+    return size;
+}
+
+void test_pooled_size_class()
+{
+    const std::size_t page_size = coro::stack_traits::page_size();
+    // a power of two pages (a size class), the classes up to the next power
+    // of two are a quarter of it apart
+    const std::size_t size = 8 * min_class_size();
+    const std::size_t quarter = size / 4;
+    coro::pooled_protected_stack_allocator alloc;
+    coro::stack_context sctx1, sctx2;
+    alloc.allocate( sctx1, size + page_size);
+    BOOST_CHECK_EQUAL( size + quarter, sctx1.size);
+    alloc.allocate( sctx2, 2 * size);
+    BOOST_CHECK_EQUAL( 2 * size, sctx2.size);
+    alloc.deallocate( sctx1);
+    alloc.deallocate( sctx2);
+
+    // served from the class of size + quarter, not of 2 * size
+    coro::stack_context sctx3;
+    alloc.allocate( sctx3, size + quarter / 2);
+    BOOST_CHECK_EQUAL( size + quarter, sctx3.size);
+    BOOST_CHECK_EQUAL( std::size_t( 1), alloc.hits() );
+    BOOST_CHECK_EQUAL( 2 * size, alloc.cached_bytes() );
+
+    // the next class is not served by a smaller stack
+    coro::stack_context sctx4;
+    alloc.allocate( sctx4, size + quarter + page_size);
+    BOOST_CHECK_EQUAL( size + 2 * quarter, sctx4.size);
+    BOOST_CHECK_EQUAL( std::size_t( 1), alloc.hits() );
+    alloc.deallocate( sctx4);
+    alloc.deallocate( sctx3);
+}
+
+void test_pooled_cap()
+{
+    const std::size_t size = min_class_size();
+    coro::pooled_protected_stack_allocator alloc( size);
+    coro::stack_context sctx1, sctx2;
+    alloc.allocate( sctx1, size);
+    alloc.allocate( sctx2, size);
+    alloc.deallocate( sctx1);
+    alloc.deallocate( sctx2);
+    // the second stack did not fit into the cache
+    BOOST_CHECK_EQUAL( size, alloc.cached_bytes() );
+}
+
+void test_pooled_copy()
+{
+    coro::pooled_protected_stack_allocator alloc1;
+    coro::pooled_protected_stack_allocator alloc2( alloc1);
+    coro::stack_context sctx;
+    alloc1.allocate( sctx, coro::stack_traits::default_size() );
+    alloc2.deallocate( sctx);
+    BOOST_CHECK_EQUAL( alloc1.cached_bytes(), alloc2.cached_bytes() );
+    BOOST_CHECK( 0 != alloc1.cached_bytes() );
+}
+
+void test_pooled_coroutine()
+{
+    coro::pooled_protected_stack_allocator alloc;
+    for ( int i = 0; i < 10; ++i)
+    {
+        coro::asymmetric_coroutine< int >::pull_type c( f1, coro::attributes(), alloc);
+        BOOST_CHECK( c);
+        BOOST_CHECK_EQUAL( 1, c.get() );
+        c();
+        BOOST_CHECK_EQUAL( 2, c.get() );
+        c();
+        BOOST_CHECK( ! c);
+    }
+    for ( int i = 0; i < 10; ++i)
+    {
+        value1 = 0;
+        coro::symmetric_coroutine< int >::call_type c( f2, coro::attributes(), alloc);
+        c( i + 1);
+        BOOST_CHECK_EQUAL( i + 1, value1);
+    }
+    BOOST_CHECK_EQUAL( std::size_t( 1), alloc.misses() );
+    BOOST_CHECK_EQUAL( std::size_t( 19), alloc.hits() );
+}
+
+struct X
+{
+    void operator()( coro::symmetric_coroutine< void >::yield_type &)
+    {}
+};
+
+void test_adaptive_kind()
+{
+    coro::adaptive_stack_allocator alloc( 1, 1000);
+    coro::attributes attrs;
+    attrs.kind = 42;
+    coro::stack_context sctx;
+    alloc.allocate( sctx, attrs);
+    std::memset( static_cast< char * >( sctx.sp) - 8192, 0, 8192);
+    alloc.deallocate( sctx);
+    BOOST_CHECK_EQUAL( std::size_t( 1), alloc.samples( 42) );
+    BOOST_CHECK_EQUAL( std::size_t( 8192), alloc.peak( 42) );
+    BOOST_CHECK_EQUAL( std::size_t( 0), alloc.peak( 43) );
+
+    // learned kind gets a smaller stack
+    BOOST_CHECK( attrs.size > alloc.stack_size( 42, attrs.size) );
+    alloc.allocate( sctx, attrs);
+    BOOST_CHECK( 8192 < sctx.size);
+    BOOST_CHECK( attrs.size > sctx.size);
+    // rounded up to a size class
+    BOOST_CHECK( 2 * alloc.stack_size( 42, attrs.size) > sctx.size);
+    alloc.deallocate( sctx);
+    BOOST_CHECK_EQUAL( std::size_t( 1), alloc.samples( 42) );
+
+    // stacks allocated by size are not measured
+    alloc.allocate( sctx, attrs.size);
+    alloc.deallocate( sctx);
+    BOOST_CHECK_EQUAL( std::size_t( 0), alloc.samples( 0) );
+
+    alloc.reset();
+    BOOST_CHECK_EQUAL( attrs.size, alloc.stack_size( 42, attrs.size) );
+}
+
+void test_adaptive_coroutine()
+{
+    coro::adaptive_stack_allocator alloc( 4, 2);
+    const std::size_t kind = coro::detail::kind_of( f3);
+    for ( int i = 0; i < 4; ++i)
+    {
+        coro::asymmetric_coroutine< void >::pull_type c( f3, coro::attributes(), alloc);
+        BOOST_CHECK( c);
+    }
+    BOOST_CHECK_EQUAL( std::size_t( 4), alloc.samples( kind) );
+    BOOST_CHECK( 16 * 1024 <= alloc.peak( kind) );
+    BOOST_CHECK( coro::attributes().size > alloc.stack_size( kind) );
+    for ( int i = 0; i < 4; ++i)
+    {
+        coro::asymmetric_coroutine< void >::pull_type c( f3, coro::attributes(), alloc);
+        c();
+        BOOST_CHECK( ! c);
+    }
+    // every 2nd stack is measured
+    BOOST_CHECK_EQUAL( std::size_t( 6), alloc.samples( kind) );
+    BOOST_CHECK_EQUAL( std::size_t( 0), alloc.samples( coro::detail::kind_of( f1) ) );
+
+    {
+        coro::symmetric_coroutine< void >::call_type c( X(), coro::attributes(), alloc);
+        c();
+    }
+    BOOST_CHECK_EQUAL( std::size_t( 1), alloc.samples( coro::detail::kind_of( X() ) ) );
+
+    // user-supplied kind
+    coro::attributes attrs;
+    attrs.kind = 7;
+    {
+        coro::symmetric_coroutine< void >::call_type c( f4, attrs, alloc);
+        c();
+    }
+    BOOST_CHECK_EQUAL( std::size_t( 1), alloc.samples( 7) );
+    BOOST_CHECK( 16 * 1024 <= alloc.peak( 7) );
+
+    // push_type passes the attributes too
+    {
+        coro::asymmetric_coroutine< void >::push_type c( f5, attrs, alloc);
+        c();
+    }
+    BOOST_CHECK_EQUAL( std::size_t( 2), alloc.samples( 7) );
+}
+
+struct generator
+{
+    int     id;
+
+    explicit generator( int id_) :
+        id( id_)
+    {}
+
+    void operator()( coro::asymmetric_coroutine< int >::push_type & c)
+    {
+        // the stack holds the sequence
+        volatile int local[64];
+        for ( int i = 0; i < 64; ++i) local[i] = id * 1000 + i;
+        for ( int i = 0; i < 64; ++i) c( local[i]);
+    }
+};
+
+// too large to be passed in the data word of a context switch, the value
+// is read from the stack of the coroutine passing it
+struct sample
+{
+    int     id;
+    int     value;
+    int     padding[2];
+};
+
+struct sequence
+{
+    int     id;
+
+    explicit sequence( int id_) :
+        id( id_)
+    {}
+
+    void operator()( coro::asymmetric_coroutine< sample >::push_type & c)
+    {
+        // the stack holds the sequence
+        volatile int local[64];
+        for ( int i = 0; i < 64; ++i) local[i] = id * 1000 + i;
+        for ( int i = 0; i < 64; ++i)
+        {
+            sample s = { id, local[i], { 0, 0 } };
+            c( s);
+        }
+    }
+};
+
+struct nested
+{
+    coro::shared_stack_allocator    alloc;
+
+    explicit nested( coro::shared_stack_allocator const& alloc_) :
+        alloc( alloc_)
+    {}
+
+    void operator()( coro::asymmetric_coroutine< int >::push_type & c)
+    {
+        volatile int offset = 1;
+        coro::asymmetric_coroutine< sample >::pull_type inner( sequence( 7), coro::attributes(), alloc);
+        while ( inner)
+        {
+            c( inner.get().value + offset);
+            inner();
+        }
+    }
+};
+
+// passes the values of a coroutine with a stack of its own
+void relay( coro::asymmetric_coroutine< int >::push_type & c)
+{
+    coro::asymmetric_coroutine< sample >::pull_type source( sequence( 5) );
+    for ( ; source; source() )
+        c( source.get().value);
+}
+
+std::vector< int > trace;
+coro::symmetric_coroutine< int >::call_type * peer_a = 0;
+coro::symmetric_coroutine< int >::call_type * peer_b = 0;
+
+void shared_a( coro::symmetric_coroutine< int >::yield_type & yield)
+{
+    volatile int local = yield.get();
+    trace.push_back( local + 0);
+    yield( * peer_b, local + 10);
+    trace.push_back( yield.get() );
+    yield( * peer_b, yield.get() + 10);
+    trace.push_back( -1);
+}
+
+void shared_b( coro::symmetric_coroutine< int >::yield_type & yield)
+{
+    volatile int local = yield.get();
+    trace.push_back( local + 0);
+    yield( * peer_a, local + 100);
+    trace.push_back( yield.get() );
+}
+
+int unwound = 0;
+
+struct unwinder
+{
+    ~unwinder()
+    { ++unwound; }
+};
+
+void shared_unwind( coro::asymmetric_coroutine< void >::push_type & c)
+{
+    unwinder u;
+    c();
+}
+
+void shared_throw( coro::asymmetric_coroutine< void >::push_type & c)
+{
+    c();
+    throw std::runtime_error("shared");
+}
+
+coro::asymmetric_coroutine< int >::pull_type * displaced = 0;
+
+// runs on a stack of its own and resumes a coroutine of the shared stack
+void resume_shared( coro::asymmetric_coroutine< void >::push_type & c)
+{
+    c();
+    ( * displaced)();
+}
+
+// runs on the shared stack and resumes a coroutine with a stack of its own
+void resume_private( coro::asymmetric_coroutine< void >::push_type & c)
+{
+    coro::asymmetric_coroutine< void >::pull_type p( resume_shared);
+    c();
+    p();
+    c();
+}
+
+void test_shared_interleaved()
+{
+    coro::shared_stack_allocator alloc;
+    coro::asymmetric_coroutine< sample >::pull_type c1( sequence( 1), coro::attributes(), alloc);
+    coro::asymmetric_coroutine< sample >::pull_type c2( sequence( 2), coro::attributes(), alloc);
+    coro::asymmetric_coroutine< sample >::pull_type c3( sequence( 3), coro::attributes(), alloc);
+    BOOST_CHECK_EQUAL( std::size_t( 3), alloc.count() );
+    // the values of c1 and c2 are read while c3 occupies the shared stack
+    BOOST_CHECK_EQUAL( 1000, c1.get().value);
+    BOOST_CHECK_EQUAL( 2000, c2.get().value);
+    BOOST_CHECK_EQUAL( 3000, c3.get().value);
+    for ( int i = 1; i < 64; ++i)
+    {
+        c3();
+        c1();
+        c2();
+        BOOST_CHECK_EQUAL( 3000 + i, c3.get().value);
+        BOOST_CHECK_EQUAL( 1, c1.get().id);
+        BOOST_CHECK_EQUAL( 1000 + i, c1.get().value);
+        BOOST_CHECK_EQUAL( 2000 + i, c2.get().value);
+    }
+    c1(); c2(); c3();
+    BOOST_CHECK( ! c1);
+    BOOST_CHECK( ! c2);
+    BOOST_CHECK( ! c3);
+    BOOST_CHECK( 0 < alloc.buffer_bytes() );
+    BOOST_CHECK( 0 < alloc.copied_bytes() );
+    // the live part of a stack is copied, not the whole stack
+    BOOST_CHECK( 3 * alloc.stack_size() > alloc.buffer_bytes() );
+}
+
+void test_shared_nested()
+{
+    coro::shared_stack_allocator alloc;
+    coro::asymmetric_coroutine< int >::pull_type c( nested( alloc), coro::attributes(), alloc);
+    for ( int i = 0; i < 64; ++i)
+    {
+        BOOST_CHECK( c);
+        BOOST_CHECK_EQUAL( 7001 + i, c.get() );
+        c();
+    }
+    BOOST_CHECK( ! c);
+}
+
+void test_shared_private()
+{
+    coro::shared_stack_allocator alloc;
+    coro::asymmetric_coroutine< int >::pull_type c1( relay, coro::attributes(), alloc);
+    coro::asymmetric_coroutine< sample >::pull_type c2( sequence( 6), coro::attributes(), alloc);
+    for ( int i = 0; i < 64; ++i)
+    {
+        BOOST_CHECK_EQUAL( 5000 + i, c1.get() );
+        BOOST_CHECK_EQUAL( 6000 + i, c2.get().value);
+        c1();
+        c2();
+    }
+    BOOST_CHECK( ! c1);
+    BOOST_CHECK( ! c2);
+}
+
+void test_shared_displaced()
+{
+    coro::shared_stack_allocator alloc;
+    coro::asymmetric_coroutine< int >::pull_type b( generator( 8), coro::attributes(), alloc);
+    coro::asymmetric_coroutine< void >::pull_type a( resume_private, coro::attributes(), alloc);
+    displaced = & b;
+    // `a` resumes a coroutine with a stack of its own which resumes `b`
+    bool thrown = false;
+    try
+    { a(); }
+    catch ( coro::coroutine_error const& e)
+    {
+        thrown = boost::system::make_error_code(
+            coro::coroutine_errc::shared_stack_occupied) == e.code();
+    }
+    BOOST_CHECK( thrown);
+    BOOST_CHECK( ! a);
+    // `b` is left unchanged
+    for ( int i = 0; i < 64; ++i)
+    {
+        BOOST_CHECK( b);
+        BOOST_CHECK_EQUAL( 8000 + i, b.get() );
+        b();
+    }
+    BOOST_CHECK( ! b);
+}
+
+void test_shared_symmetric()
+{
+    coro::shared_stack_allocator alloc;
+    trace.clear();
+    coro::symmetric_coroutine< int >::call_type a( shared_a, coro::attributes(), alloc);
+    coro::symmetric_coroutine< int >::call_type b( shared_b, coro::attributes(), alloc);
+    peer_a = & a;
+    peer_b = & b;
+    // the values are passed between the coroutines of the shared stack
+    a( 1);
+    BOOST_CHECK( a);
+    BOOST_CHECK( ! b);
+    BOOST_REQUIRE_EQUAL( std::size_t( 4), trace.size() );
+    BOOST_CHECK_EQUAL( 1, trace[0]);
+    BOOST_CHECK_EQUAL( 11, trace[1]);
+    BOOST_CHECK_EQUAL( 111, trace[2]);
+    BOOST_CHECK_EQUAL( 121, trace[3]);
+}
+
+void test_shared_unwind()
+{
+    coro::shared_stack_allocator alloc;
+    unwound = 0;
+    {
+        coro::asymmetric_coroutine< void >::pull_type c1( shared_unwind, coro::attributes(), alloc);
+        coro::asymmetric_coroutine< void >::pull_type c2( shared_unwind, coro::attributes(), alloc);
+        // a stack shared with other coroutines is not hibernated
+        BOOST_CHECK( ! c1.hibernate() );
+        BOOST_CHECK( ! c1.is_hibernated() );
+    }
+    BOOST_CHECK_EQUAL( 2, unwound);
+    BOOST_CHECK_EQUAL( std::size_t( 0), alloc.count() );
+
+    coro::asymmetric_coroutine< void >::pull_type c( shared_throw, coro::attributes(), alloc);
+    BOOST_CHECK_THROW( c(), std::runtime_error);
+}
+
+void test_hibernate_protected()
+{
+    coro::protected_stack_allocator alloc;
+    coro::asymmetric_coroutine< int >::pull_type c( generator( 4), coro::attributes( 64 * 1024), alloc);
+    for ( int i = 0; i < 64; ++i)
+    {
+        BOOST_CHECK( c.hibernate() );
+        BOOST_CHECK( c.is_hibernated() );
+        BOOST_CHECK_EQUAL( 4000 + i, c.get() );
+        c();
+    }
+    BOOST_CHECK( ! c);
+}
+
+#if defined(BOOST_COROUTINES_TEST_MAGAZINE)
+void test_magazine_reuse()
+{
+    coro::magazine_stack_allocator::release();
+    coro::magazine_stack_allocator alloc;
+    coro::stack_context sctx1;
+    alloc.allocate( sctx1, coro::stack_traits::default_size() );
+    BOOST_CHECK( 0 != sctx1.sp);
+    BOOST_CHECK( coro::stack_traits::default_size() <= sctx1.size);
+    void * sp = sctx1.sp;
+    alloc.deallocate( sctx1);
+
+    // a copy shares the same cache
+    coro::magazine_stack_allocator other;
+    coro::stack_context sctx2;
+    other.allocate( sctx2, coro::stack_traits::default_size() );
+    BOOST_CHECK_EQUAL( sp, sctx2.sp);
+    other.deallocate( sctx2);
+    coro::magazine_stack_allocator::release();
+}
+
+void deallocate_all( std::vector< coro::stack_context > * stacks)
+{
+    coro::magazine_stack_allocator alloc;
+    for ( std::size_t i = 0; i < stacks->size(); ++i)
+        alloc.deallocate( ( * stacks)[i]);
+}
+
+void test_magazine_cross_thread()
+{
+    coro::magazine_stack_allocator::release();
+    coro::magazine_stack_allocator alloc;
+    std::vector< coro::stack_context > stacks( 3 * coro::detail::magazine::capacity);
+    std::vector< void * > sps;
+    for ( std::size_t i = 0; i < stacks.size(); ++i)
+    {
+        alloc.allocate( stacks[i], coro::stack_traits::default_size() );
+        sps.push_back( stacks[i].sp);
+    }
+
+    // released by another thread, the magazines reach the depot at thread exit
+    std::thread t( deallocate_all, & stacks);
+    t.join();
+
+    std::size_t reused = 0;
+    for ( std::size_t i = 0; i < stacks.size(); ++i)
+    {
+        alloc.allocate( stacks[i], coro::stack_traits::default_size() );
+        if ( sps.end() != std::find( sps.begin(), sps.end(), stacks[i].sp) ) ++reused;
+    }
+    BOOST_CHECK_EQUAL( stacks.size(), reused);
+    deallocate_all( & stacks);
+    coro::magazine_stack_allocator::release();
+}
+
+void create_coroutines( int * result)
+{
+    for ( int i = 0; i < 1000; ++i)
+    {
+        coro::asymmetric_coroutine< int >::pull_type c(
+            f1, coro::attributes(), coro::magazine_stack_allocator() );
+        * result += c.get();
+    }
+}
+
+void test_magazine_coroutine()
+{
+    int results[4] = { 0, 0, 0, 0 };
+    std::vector< std::thread > threads;
+    for ( int i = 0; i < 4; ++i)
+        threads.push_back( std::thread( create_coroutines, & results[i]) );
+    for ( std::size_t i = 0; i < threads.size(); ++i)
+    {
+        threads[i].join();
+        BOOST_CHECK_EQUAL( 1000, results[i]);
+    }
+    coro::magazine_stack_allocator::release();
+}
+#endif
+
+#if ! defined(BOOST_WINDOWS)
+#if defined(__linux__)
+// true if [first, last) lies in one memory mapping (VMA)
+bool one_mapping( void const* first, void const* last)
+{
+    std::ifstream maps( "/proc/self/maps");
+    std::string line;
+    while ( std::getline( maps, line) )
+    {
+        unsigned long start = 0, end = 0;
+        if ( 2 == std::sscanf( line.c_str(), "%lx-%lx", & start, & end)
+             && start <= reinterpret_cast< unsigned long >( first)
+             && reinterpret_cast< unsigned long >( last) <= end)
+            return true;
+    }
+    return false;
+}
+#endif
+
+void test_slab_reuse()
+{
+    const std::size_t size = coro::stack_traits::default_size();
+    coro::slab_stack_allocator alloc( size, 4);
+    std::vector< coro::stack_context > stacks( 5);
+    for ( std::size_t i = 0; i < stacks.size(); ++i)
+    {
+        alloc.allocate( stacks[i], size);
+        BOOST_CHECK( size <= stacks[i].size);
+    }
+    BOOST_CHECK_EQUAL( std::size_t( 8), alloc.slot_count() );
+    BOOST_CHECK_EQUAL( std::size_t( 3), alloc.free_count() );
+    // slots of one slab are adjacent
+    BOOST_CHECK_EQUAL( static_cast< char * >( stacks[0].sp) + stacks[0].size, stacks[1].sp);
+#if defined(__linux__)
+    // guard regions do not split the slab
+    if ( alloc.guard_regions() )
+        BOOST_CHECK( one_mapping( static_cast< char * >( stacks[0].sp) - stacks[0].size, stacks[3].sp) );
+#endif
+
+    void * sp = stacks[2].sp;
+    alloc.deallocate( stacks[2]);
+    alloc.allocate( stacks[2], size);
+    BOOST_CHECK_EQUAL( sp, stacks[2].sp);
+
+    // larger stacks are not taken from a slab
+    coro::stack_context sctx;
+    alloc.allocate( sctx, 2 * size);
+    BOOST_CHECK( size < sctx.size);
+    BOOST_CHECK_EQUAL( std::size_t( 3), alloc.free_count() );
+    alloc.deallocate( sctx);
+
+    for ( std::size_t i = 0; i < stacks.size(); ++i)
+        alloc.deallocate( stacks[i]);
+    BOOST_CHECK_EQUAL( alloc.slot_count(), alloc.free_count() );
+}
+
+void test_slab_bulk()
+{
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    // std::vector requires rvalue references for move-only coroutines
+    coro::slab_stack_allocator alloc;
+    std::vector< coro::asymmetric_coroutine< int >::pull_type > pulls;
+    coro::make_coroutines< coro::asymmetric_coroutine< int >::pull_type >(
+        100, f1, coro::attributes(), alloc, std::back_inserter( pulls) );
+    BOOST_CHECK_EQUAL( std::size_t( 100), pulls.size() );
+    BOOST_CHECK_EQUAL( std::size_t( 100), alloc.slot_count() );
+    for ( std::size_t i = 0; i < pulls.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL( 1, pulls[i].get() );
+        pulls[i]();
+        BOOST_CHECK_EQUAL( 2, pulls[i].get() );
+    }
+
+    std::vector< coro::symmetric_coroutine< int >::call_type > calls;
+    coro::make_coroutines< coro::symmetric_coroutine< int >::call_type >(
+        10, f2, coro::attributes(), alloc, std::back_inserter( calls) );
+    BOOST_CHECK_EQUAL( std::size_t( 110), alloc.slot_count() );
+    for ( int i = 0; i < 10; ++i)
+    {
+        calls[i]( i);
+        BOOST_CHECK_EQUAL( i, value1);
+    }
+    pulls.clear();
+    calls.clear();
+    BOOST_CHECK_EQUAL( alloc.slot_count(), alloc.free_count() );
+#endif
+}
+
+void test_slab_huge_pages()
+{
+    const std::size_t size = coro::stack_traits::default_size();
+    const std::size_t huge = coro::slab_stack_allocator::huge_page_size();
+    coro::slab_stack_allocator::page_mode modes[2] = {
+        coro::slab_stack_allocator::transparent_huge_pages,
+        coro::slab_stack_allocator::huge_pages };
+    for ( std::size_t m = 0; m < 2; ++m)
+    {
+        // huge pages can not be combined with guard pages
+        BOOST_CHECK_THROW( coro::slab_stack_allocator( size, 4, true, modes[m]), std::invalid_argument);
+        // falls back to normal pages if huge pages are not available
+        coro::slab_stack_allocator alloc( size, 4, false, modes[m]);
+        coro::stack_context sctx1, sctx2;
+        alloc.allocate( sctx1, size);
+        alloc.allocate( sctx2, size);
+        BOOST_CHECK( modes[m] >= alloc.backing() );
+        // the slab fills whole huge pages, no guard pages between the slots
+        BOOST_CHECK( huge / size <= alloc.slot_count() );
+        BOOST_CHECK_EQUAL( alloc.stack_size(), sctx1.size);
+        BOOST_CHECK_EQUAL( static_cast< char * >( sctx1.sp) + sctx1.size, sctx2.sp);
+        std::memset( static_cast< char * >( sctx1.sp) - sctx1.size, 0, sctx1.size);
+        alloc.deallocate( sctx1);
+        alloc.deallocate( sctx2);
+
+        coro::asymmetric_coroutine< int >::pull_type c( f1, coro::attributes(), alloc);
+        BOOST_CHECK_EQUAL( 1, c.get() );
+    }
+}
+
+void test_reserved_commit()
+{
+    const std::size_t page_size = coro::stack_traits::page_size();
+    coro::reserved_stack_allocator alloc(
+        1024 * 1024, 4 * page_size, 64, coro::reserved_stack_allocator::reclaim_eager);
+    coro::stack_context sctx;
+    alloc.allocate( sctx, coro::stack_traits::minimum_size() );
+    BOOST_CHECK_EQUAL( std::size_t( 1024 * 1024), alloc.reserved_bytes() );
+    BOOST_CHECK( 1024 * 1024 - page_size <= sctx.size);
+    // only the page holding the bookkeeping is touched
+    BOOST_CHECK( 2 * page_size >= alloc.committed_bytes() );
+
+    char * limit = static_cast< char * >( sctx.sp) - sctx.size;
+    std::memset( limit + page_size, 1, sctx.size - page_size);
+    BOOST_CHECK( sctx.size - page_size <= alloc.committed_bytes() );
+
+    void * sp = sctx.sp;
+    alloc.deallocate( sctx);
+    BOOST_CHECK_EQUAL( std::size_t( 1), alloc.cached_count() );
+    BOOST_CHECK_EQUAL( std::size_t( 1024 * 1024), alloc.reserved_bytes() );
+    // the hot window and the page holding the bookkeeping stay resident
+    BOOST_CHECK( 6 * page_size >= alloc.committed_bytes() );
+    BOOST_CHECK( 4 * page_size <= alloc.committed_bytes() );
+
+    alloc.allocate( sctx, coro::stack_traits::minimum_size() );
+    BOOST_CHECK_EQUAL( sp, sctx.sp);
+    alloc.deallocate( sctx);
+    alloc.release();
+    BOOST_CHECK_EQUAL( std::size_t( 0), alloc.reserved_bytes() );
+}
+
+void test_numa()
+{
+    BOOST_CHECK( 1 <= coro::numa_stack_allocator::node_count() );
+    const int node = coro::numa_stack_allocator::current_node();
+    BOOST_CHECK( 0 <= node);
+    BOOST_CHECK( coro::numa_stack_allocator::node_count() > std::size_t( node) );
+
+    coro::numa_stack_allocator alloc( node);
+    BOOST_CHECK_EQUAL( node, alloc.node() );
+    coro::stack_context sctx;
+    alloc.allocate( sctx, coro::stack_traits::default_size() );
+    char * top = static_cast< char * >( sctx.sp) - 1;
+    * top = 1;
+    const int placed = coro::numa_stack_allocator::node_of( top);
+    // unknown if the system does not report the node
+    BOOST_CHECK( -1 == placed || node == placed);
+    alloc.deallocate( sctx);
+
+    // the node requested by the attributes
+    coro::attributes attrs;
+    attrs.node = node;
+    coro::asymmetric_coroutine< int >::pull_type c( f1, attrs, coro::numa_stack_allocator() );
+    BOOST_CHECK_EQUAL( 1, c.get() );
+}
+
+void test_reserved_prefault()
+{
+    const std::size_t page_size = coro::stack_traits::page_size();
+    coro::reserved_stack_allocator alloc(
+        1024 * 1024, 4 * page_size, 64, coro::reserved_stack_allocator::reclaim_eager);
+    coro::attributes attrs;
+    attrs.prefault = 64 * page_size;
+    {
+        coro::asymmetric_coroutine< int >::pull_type c( f1, attrs, alloc);
+        BOOST_CHECK_EQUAL( 1, c.get() );
+        BOOST_CHECK( 64 * page_size <= alloc.committed_bytes() );
+    }
+    // pages below the hot window are released
+    BOOST_CHECK( 6 * page_size >= alloc.committed_bytes() );
+}
+
+void test_reserved_coroutine()
+{
+    coro::reserved_stack_allocator alloc;
+    for ( int i = 0; i < 10; ++i)
+    {
+        coro::asymmetric_coroutine< int >::pull_type c( f1, coro::attributes(), alloc);
+        BOOST_CHECK_EQUAL( 1, c.get() );
+        BOOST_CHECK( 0 != alloc.committed_bytes() );
+    }
+    BOOST_CHECK_EQUAL( std::size_t( 1), alloc.cached_count() );
+}
+#endif
+
+boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
+{
+    boost::unit_test::test_suite * test =
+        BOOST_TEST_SUITE("Boost.coroutine: stack allocator test suite");
+
+    test->add( BOOST_TEST_CASE( & test_painted) );
+    test->add( BOOST_TEST_CASE( & test_prefault) );
+    test->add( BOOST_TEST_CASE( & test_fixed_stack) );
+    test->add( BOOST_TEST_CASE( & test_stack_resource) );
+    test->add( BOOST_TEST_CASE( & test_monotonic_stack_resource) );
+    test->add( BOOST_TEST_CASE( & test_coloured) );
+    test->add( BOOST_TEST_CASE( & test_pooled_reuse) );
+    test->add( BOOST_TEST_CASE( & test_pooled_size_class) );
+    test->add( BOOST_TEST_CASE( & test_pooled_cap) );
+    test->add( BOOST_TEST_CASE( & test_pooled_copy) );
+    test->add( BOOST_TEST_CASE( & test_pooled_coroutine) );
+    test->add( BOOST_TEST_CASE( & test_adaptive_kind) );
+    test->add( BOOST_TEST_CASE( & test_adaptive_coroutine) );
+    test->add( BOOST_TEST_CASE( & test_shared_interleaved) );
+    test->add( BOOST_TEST_CASE( & test_shared_nested) );
+    test->add( BOOST_TEST_CASE( & test_shared_private) );
+    test->add( BOOST_TEST_CASE( & test_shared_displaced) );
+    test->add( BOOST_TEST_CASE( & test_shared_symmetric) );
+    test->add( BOOST_TEST_CASE( & test_shared_unwind) );
+    test->add( BOOST_TEST_CASE( & test_hibernate_protected) );
+#if defined(BOOST_COROUTINES_TEST_MAGAZINE)
+    test->add( BOOST_TEST_CASE( & test_magazine_reuse) );
+    test->add( BOOST_TEST_CASE( & test_magazine_cross_thread) );
+    test->add( BOOST_TEST_CASE( & test_magazine_coroutine) );
+#endif
+
+#if ! defined(BOOST_WINDOWS)
+    test->add( BOOST_TEST_CASE( & test_reserved_commit) );
+    test->add( BOOST_TEST_CASE( & test_reserved_coroutine) );
+    test->add( BOOST_TEST_CASE( & test_reserved_prefault) );
+    test->add( BOOST_TEST_CASE( & test_numa) );
+    test->add( BOOST_TEST_CASE( & test_slab_reuse) );
+    test->add( BOOST_TEST_CASE( & test_slab_bulk) );
+    test->add( BOOST_TEST_CASE( & test_slab_huge_pages) );
+#endif
+
+    return test;
+}
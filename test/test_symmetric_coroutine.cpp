@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -188,6 +189,23 @@ void f4( coro::symmetric_coroutine< X& >::yield_type & yield)
 void f5( coro::symmetric_coroutine< X* >::yield_type & yield)
 { p = yield.get(); }
 
+void f_hibernate( coro::symmetric_coroutine< int >::yield_type & yield)
+{
+    volatile char buffer[32 * 1024];
+    for (;;)
+    {
+        buffer[yield.get() * 4096] = static_cast< char >( yield.get() );
+        value2 += buffer[yield.get() * 4096];
+        yield();
+    }
+}
+
+void f_reset( coro::symmetric_coroutine< void >::yield_type & yield)
+{
+    Y y;
+    yield();
+}
+
 void f6( coro::symmetric_coroutine< void >::yield_type & yield)
 {
     Y y;
@@ -427,6 +445,54 @@ void test_no_unwind()
     BOOST_CHECK_EQUAL( ( int) 7, value2);
 }
 
+void test_hibernate()
+{
+    value2 = 0;
+    {
+        coro::symmetric_coroutine< int >::call_type coro(
+            f_hibernate,
+            coro::attributes( 128 * 1024) );
+        // not started yet
+        BOOST_CHECK( coro.hibernate() );
+        for ( int i = 0; i < 8; ++i)
+        {
+            coro( i);
+            BOOST_CHECK( coro.hibernate() );
+            BOOST_CHECK( coro.is_hibernated() );
+        }
+        BOOST_CHECK( coro);
+        BOOST_CHECK_EQUAL( ( int) 28, value2);
+    }
+}
+
+void test_reset()
+{
+    value2 = 0;
+    coro::symmetric_coroutine< void >::call_type coro( f2);
+    coro();
+    BOOST_CHECK( ! coro);
+    BOOST_CHECK_EQUAL( ( int) 1, value2);
+    coro.reset( f2);
+    BOOST_CHECK( coro);
+    coro();
+    BOOST_CHECK( ! coro);
+    BOOST_CHECK_EQUAL( ( int) 2, value2);
+
+    // a suspended coroutine is unwound
+    coro.reset( f_reset);
+    coro();
+    BOOST_CHECK( coro);
+    BOOST_CHECK_EQUAL( ( int) 7, value2);
+    coro.reset( f2);
+    BOOST_CHECK_EQUAL( ( int) 0, value2);
+    coro();
+    BOOST_CHECK_EQUAL( ( int) 1, value2);
+
+    coro::symmetric_coroutine< void >::call_type empty_coro;
+    empty_coro.reset( f2);
+    BOOST_CHECK( empty_coro);
+}
+
 void test_termination()
 {
     value2 = 0;
@@ -483,6 +549,35 @@ void test_yield_to_int()
     BOOST_CHECK_EQUAL( ( int) 7, value2);
 }
 
+void test_yield_to_fpu_not_preserved()
+{
+    value2 = 0;
+
+    // a coroutine not preserving the FPU transfers control to one which
+    // preserves it
+    coro::attributes attrs;
+    attrs.preserve_fpu = coro::fpu_not_preserved;
+    coro::symmetric_coroutine< int >::call_type coro_other( f101);
+    coro::symmetric_coroutine< int >::call_type coro( boost::bind( f10, _1, boost::ref( coro_other) ), attrs);
+    coro(3);
+    BOOST_CHECK( ! coro_other);
+    BOOST_CHECK( coro);
+    BOOST_CHECK_EQUAL( ( int) 3, value2);
+    coro(7);
+    BOOST_CHECK( ! coro);
+    BOOST_CHECK_EQUAL( ( int) 7, value2);
+
+    value2 = 0;
+    coro::symmetric_coroutine< int >::call_type coro_other2( f101, attrs);
+    coro::symmetric_coroutine< int >::call_type coro2( boost::bind( f10, _1, boost::ref( coro_other2) ) );
+    coro2(3);
+    BOOST_CHECK( ! coro_other2);
+    BOOST_CHECK_EQUAL( ( int) 3, value2);
+    coro2(7);
+    BOOST_CHECK( ! coro2);
+    BOOST_CHECK_EQUAL( ( int) 7, value2);
+}
+
 void test_yield_to_ref()
 {
     p = 0;
@@ -527,6 +622,99 @@ void test_yield_to_different()
     BOOST_CHECK_EQUAL( ( int) 7, value2);
 }
 
+// counts the copies of the values passed between coroutines
+struct message
+{
+    static int copies;
+
+    std::string payload;
+
+    explicit message( std::string const& payload_) :
+        payload( payload_)
+    {}
+
+    message( message const& other) :
+        payload( other.payload)
+    { ++copies; }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    message( message && other) :
+        payload( boost::move( other.payload) )
+    {}
+#endif
+};
+
+int message::copies = 0;
+
+void f17( coro::symmetric_coroutine< message >::yield_type & yield,
+          coro::symmetric_coroutine< message >::call_type & other)
+{
+    message m( yield.take() );
+    m.payload += "d";
+    yield( other, boost::move( m) );
+    value3 = yield.take().payload;
+}
+
+void f171( coro::symmetric_coroutine< message >::yield_type & yield)
+{ value3 = yield.take().payload; }
+
+void test_yield_to_move()
+{
+    message::copies = 0;
+    value3 = "";
+
+    coro::symmetric_coroutine< message >::call_type coro_other( f171);
+    coro::symmetric_coroutine< message >::call_type coro( boost::bind( f17, _1, boost::ref( coro_other) ) );
+    coro( message( "abc") );
+    BOOST_CHECK( ! coro_other);
+    BOOST_CHECK( coro);
+    BOOST_CHECK_EQUAL( "abcd", value3);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    BOOST_CHECK_EQUAL( 0, message::copies);
+#endif
+
+    // an lvalue is copied
+    message m( "ef");
+    coro( m);
+    BOOST_CHECK( ! coro);
+    BOOST_CHECK_EQUAL( "ef", value3);
+    BOOST_CHECK_EQUAL( "ef", m.payload);
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+    BOOST_CHECK_EQUAL( 1, message::copies);
+#endif
+}
+
+#if ! defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && ! defined(BOOST_NO_CXX11_SMART_PTR)
+void f18( coro::symmetric_coroutine< std::unique_ptr< int > >::yield_type & yield,
+          coro::symmetric_coroutine< std::unique_ptr< int > >::call_type & other)
+{
+    std::unique_ptr< int > i( yield.take() );
+    * i += 1;
+    yield( other, std::move( i) );
+}
+
+void f181( coro::symmetric_coroutine< std::unique_ptr< int > >::yield_type & yield)
+{
+    while ( yield)
+    {
+        value2 += * yield.take();
+        yield();
+    }
+}
+
+void test_move_only()
+{
+    value2 = 0;
+
+    coro::symmetric_coroutine< std::unique_ptr< int > >::call_type coro_other( f181);
+    coro::symmetric_coroutine< std::unique_ptr< int > >::call_type coro( boost::bind( f18, _1, boost::ref( coro_other) ) );
+    coro( std::unique_ptr< int >( new int( 3) ) );
+    BOOST_CHECK_EQUAL( 4, value2);
+    coro_other( std::unique_ptr< int >( new int( 5) ) );
+    BOOST_CHECK_EQUAL( 9, value2);
+}
+#endif
+
 void test_move_coro()
 {
     value2 = 0;
@@ -593,10 +781,17 @@ boost::unit_test::test_suite * init_unit_test_suite( int, char* [])
     test->add( BOOST_TEST_CASE( & test_termination) );
     test->add( BOOST_TEST_CASE( & test_unwind) );
     test->add( BOOST_TEST_CASE( & test_no_unwind) );
+    test->add( BOOST_TEST_CASE( & test_hibernate) );
+    test->add( BOOST_TEST_CASE( & test_reset) );
     test->add( BOOST_TEST_CASE( & test_yield_to_void) );
     test->add( BOOST_TEST_CASE( & test_yield_to_int) );
+    test->add( BOOST_TEST_CASE( & test_yield_to_fpu_not_preserved) );
     test->add( BOOST_TEST_CASE( & test_yield_to_ref) );
     test->add( BOOST_TEST_CASE( & test_yield_to_different) );
+    test->add( BOOST_TEST_CASE( & test_yield_to_move) );
+#if ! defined(BOOST_NO_CXX11_RVALUE_REFERENCES) && ! defined(BOOST_NO_CXX11_SMART_PTR)
+    test->add( BOOST_TEST_CASE( & test_move_only) );
+#endif
     test->add( BOOST_TEST_CASE( & test_move_coro) );
     test->add( BOOST_TEST_CASE( & test_vptr) );
 